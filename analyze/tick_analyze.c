@@ -0,0 +1,752 @@
+/*
+ * Fast analyzer of `tick -d` data files (mmap, SWAR parser, threads)
+ * File: "tick_analyze.c"
+ * Кодировка: UTF-8
+ */
+
+//-----------------------------------------------------------------------------
+#include <stdlib.h>    // exit(), EXIT_SUCCESS, EXIT_FAILURE, atoi(), malloc()
+#include <string.h>    // strcmp(), memcpy(), memchr(), memset()
+#include <stdio.h>     // fprintf(), printf(), perror()
+#include <stdint.h>    // `int64_t`, `uint64_t`, `int32_t`
+#include <math.h>      // sqrt()
+#include <time.h>      // clock_gettime()
+#include <unistd.h>    // sysconf(), close()
+#include <fcntl.h>     // open()
+#include <pthread.h>   // pthread_create(), pthread_join()
+#include <sys/mman.h>  // mmap(), munmap(), madvise()
+#include <sys/stat.h>  // fstat()
+//-----------------------------------------------------------------------------
+#include "sstat.h"
+//-----------------------------------------------------------------------------
+// max number of threads
+#define TA_THREADS_MAX 64
+
+// max number of outliers of each side
+#define TA_OUTLIERS_MAX 100
+
+// max line length of slow path (end of file)
+#define TA_LINE_MAX 256
+
+// `dt` of bad line in `dt` array
+#define TA_BAD INT32_MIN
+
+// max dt range for exact percentiles by counting [us]
+#define TA_EXACT_RANGE (1 << 22)
+//-----------------------------------------------------------------------------
+// command line options
+typedef struct options_ {
+  const char *fname;  // input file ("data.txt" by default)
+  int threads;        // number of threads (CPU number by default)
+  int bins;           // number of histogram bins
+  int outliers;       // number of outliers of each side
+  const char *out;    // decimated series file (or NULL)
+  unsigned points;    // number of points of decimated series
+} options_t;
+//-----------------------------------------------------------------------------
+// one row of data file (values are in us, i.e. ms with 3 decimals)
+typedef struct ta_row_ {
+  uint64_t row;      // row index
+  uint64_t counter;  // #counter
+  int64_t  daytime;  // #daytime [us]
+  int64_t  dt;       // #dt [us]
+} ta_row_t;
+//-----------------------------------------------------------------------------
+// decimated series point (min/max keep outliers visible)
+typedef struct ta_point_ {
+  uint64_t counter; // #counter of first row
+  int64_t daytime;  // #daytime of first row [us]
+  int64_t min, max; // min/max of #dt [us]
+  int64_t sum;      // sum of #dt [us]
+  uint64_t row;     // first row
+  unsigned n;       // number of good rows (0 - empty)
+} ta_point_t;
+//-----------------------------------------------------------------------------
+// chunk of file parsed by one thread
+typedef struct ta_chunk_ {
+  pthread_t thread;
+  const char *begin, *end; // chunk (whole lines)
+  const char *map_end;     // end of mapped file (for 8 byte loads)
+  uint64_t first;          // global index of first row
+  uint64_t rows;           // number of rows (lines)
+  uint64_t bad;            // number of bad lines
+  uint64_t zero;           // number of dt == 0 (clock step in `tick`)
+  int32_t *dt;             // global `dt` array [us] (TA_BAD if bad)
+  sstat_t stat;            // dt [ns]
+  int outliers;
+  int nhi, nlo;
+  ta_row_t hi[TA_OUTLIERS_MAX], lo[TA_OUTLIERS_MAX];
+  ta_point_t *points;      // global decimated series
+  uint64_t decim;          // rows per point
+  ta_point_t edge[2];      // points shared with neighbour chunks
+  int edges;
+} ta_chunk_t;
+//-----------------------------------------------------------------------------
+static void ta_usage()
+{
+  fprintf(stderr,
+    "Fast analyzer of `tick -d` data files\n"
+    "Usage: tick-analyze [-options] [data.txt]\n"
+    "       tick-analyze --help\n");
+  exit(EXIT_FAILURE);
+}
+//-----------------------------------------------------------------------------
+static void ta_help()
+{
+  printf(
+    "Fast analyzer of `tick -d` data files\n"
+    "Run:  tick-analyze [-options] [data.txt]\n"
+    "Options:\n"
+    "   -h|--help          - show this help\n"
+    "   -t|--threads N     - number of threads (CPU number by default)\n"
+    "   -b|--bins N        - histogram bins (40 by default)\n"
+    "   -n|--outliers N    - list N largest and N smallest dt (10 by default)\n"
+    "   -o|--out FILE      - write decimated series for plot:\n"
+    "                        #counter #daytime #dt_min #dt_max #dt_mean (ms)\n"
+    "   -p|--points N      - points of decimated series (10000 by default)\n"
+    "Input columns: #counter #daytime #dt_min #dt_max #dt (ms), lines with\n"
+    "dt = 0 (realtime clock step) are not counted in statistics.\n");
+  exit(EXIT_SUCCESS);
+}
+//-----------------------------------------------------------------------------
+// parse command line options
+static void ta_parse_options(int argc, const char *argv[], options_t *o)
+{
+  int i;
+
+  // set options by default
+  o->fname    = "data.txt";
+  o->threads  = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  o->bins     = 40;
+  o->outliers = 10;
+  o->out      = NULL;
+  o->points   = 10000;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (argv[i][0] != '-' || argv[i][1] == '\0')
+    { // input file
+      o->fname = argv[i];
+    }
+    else if (!strcmp(argv[i], "-h") ||
+             !strcmp(argv[i], "--help"))
+    { // print help
+      ta_help();
+    }
+    else if (!strcmp(argv[i], "-t") ||
+             !strcmp(argv[i], "--threads"))
+    { // threads
+      if (++i >= argc) ta_usage();
+      o->threads = atoi(argv[i]);
+    }
+    else if (!strcmp(argv[i], "-b") ||
+             !strcmp(argv[i], "--bins"))
+    { // histogram bins
+      if (++i >= argc) ta_usage();
+      o->bins = atoi(argv[i]);
+    }
+    else if (!strcmp(argv[i], "-n") ||
+             !strcmp(argv[i], "--outliers"))
+    { // outliers
+      if (++i >= argc) ta_usage();
+      o->outliers = atoi(argv[i]);
+    }
+    else if (!strcmp(argv[i], "-o") ||
+             !strcmp(argv[i], "--out"))
+    { // decimated series
+      if (++i >= argc) ta_usage();
+      o->out = argv[i];
+    }
+    else if (!strcmp(argv[i], "-p") ||
+             !strcmp(argv[i], "--points"))
+    { // points of decimated series
+      if (++i >= argc) ta_usage();
+      o->points = (unsigned) atoi(argv[i]);
+    }
+    else
+      ta_usage();
+  }
+
+  if (o->threads < 1) o->threads = 1;
+  if (o->threads > TA_THREADS_MAX) o->threads = TA_THREADS_MAX;
+  if (o->bins < 1) o->bins = 1;
+  if (o->outliers < 0) o->outliers = 0;
+  if (o->outliers > TA_OUTLIERS_MAX) o->outliers = TA_OUTLIERS_MAX;
+  if (o->points < 1) o->points = 1;
+}
+//-----------------------------------------------------------------------------
+// load 8 bytes (little endian)
+static inline uint64_t ta_load8(const char *p)
+{
+  uint64_t v;
+  memcpy(&v, p, 8);
+  return v;
+}
+//-----------------------------------------------------------------------------
+// number of leading ASCII digits in 8 bytes (SWAR, 0...8)
+static inline int ta_digits8(uint64_t v)
+{
+  uint64_t x = v ^ 0x3030303030303030ULL; // digits -> 0...9
+  uint64_t m = ((x + 0x7676767676767676ULL) | x) & 0x8080808080808080ULL;
+  return m ? __builtin_ctzll(m) >> 3 : 8;
+}
+//-----------------------------------------------------------------------------
+// convert `n` (1...8) leading ASCII digits of 8 bytes to integer (SWAR)
+static inline uint64_t ta_value8(uint64_t v, int n)
+{
+  v <<= (8 - n) * 8; // align right, zero bytes are leading '0'
+  v = ((v & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+  v = ((v & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+  return ((v & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32;
+}
+//-----------------------------------------------------------------------------
+// parse unsigned integer (8 digits per step), NULL if no digits
+static inline const char *ta_uint(const char *p, uint64_t *val)
+{
+  uint64_t v = 0;
+  int n, total = 0;
+
+  while (*p == ' ' || *p == '\t') p++;
+  do
+  {
+    n = ta_digits8(ta_load8(p));
+    if (n == 0) break;
+    v = (n == 8 ? v * 100000000ULL : v * (uint64_t) (n == 1 ? 10 :
+         n == 2 ? 100 : n == 3 ? 1000 : n == 4 ? 10000 : n == 5 ? 100000 :
+         n == 6 ? 1000000 : 10000000)) + ta_value8(ta_load8(p), n);
+    p += n;
+    total += n;
+  } while (n == 8);
+
+  *val = v;
+  return total ? p : (const char*) NULL;
+}
+//-----------------------------------------------------------------------------
+// parse "[-]INT[.FRAC]" to integer of 1/1000 units (e.g. ms -> us),
+// NULL if no digits
+static inline const char *ta_fixed3(const char *p, int64_t *val)
+{
+  static const uint64_t scale[] = { 1000, 100, 10, 1 };
+  uint64_t ip, fp = 0;
+  int neg = 0, n;
+
+  while (*p == ' ' || *p == '\t') p++;
+  if (*p == '-') { neg = 1; p++; }
+
+  p = ta_uint(p, &ip);
+  if (p == (const char*) NULL) return p;
+
+  if (*p == '.')
+  {
+    p++;
+    n = ta_digits8(ta_load8(p));
+    if (n >= 3)
+      fp = ta_value8(ta_load8(p), 3); // truncate to 3 decimals
+    else if (n)
+      fp = ta_value8(ta_load8(p), n) * scale[n];
+    while (*p >= '0' && *p <= '9') p++;
+  }
+
+  *val = (int64_t) (ip * 1000 + fp);
+  if (neg) *val = -*val;
+  return p;
+}
+//-----------------------------------------------------------------------------
+// parse line "#counter #daytime #dt_min #dt_max #dt" (return 0 or -1)
+static inline int ta_line(const char *p, ta_row_t *r)
+{
+  int64_t skip;
+  uint64_t counter;
+
+  if ((p = ta_uint(p, &counter))        == NULL) return -1;
+  if ((p = ta_fixed3(p, &r->daytime))   == NULL) return -1;
+  if ((p = ta_fixed3(p, &skip))         == NULL) return -1; // dt_min
+  if ((p = ta_fixed3(p, &skip))         == NULL) return -1; // dt_max
+  if ((p = ta_fixed3(p, &r->dt))        == NULL) return -1;
+  r->counter = counter;
+  return 0;
+}
+//-----------------------------------------------------------------------------
+// keep `max` rows with largest (sign = 1) or smallest (sign = -1) dt
+static void ta_outlier(ta_row_t *list, int *num, int max, int sign,
+                       const ta_row_t *r)
+{
+  int i = *num;
+
+  if (max == 0) return;
+  if (i == max)
+  {
+    if (sign * r->dt <= sign * list[max - 1].dt) return;
+    i--;
+  }
+  else
+    (*num)++;
+
+  // insertion into sorted list (rare after first rows)
+  for (; i > 0 && sign * list[i - 1].dt < sign * r->dt; i--)
+    list[i] = list[i - 1];
+  list[i] = *r;
+}
+//-----------------------------------------------------------------------------
+// merge `src` point to `dst`
+static void ta_point_merge(ta_point_t *dst, const ta_point_t *src)
+{
+  if (src->n == 0) return;
+  if (dst->n == 0)
+  {
+    *dst = *src;
+    return;
+  }
+  if (src->row < dst->row)
+  {
+    dst->row     = src->row;
+    dst->counter = src->counter;
+    dst->daytime = src->daytime;
+  }
+  if (dst->min > src->min) dst->min = src->min;
+  if (dst->max < src->max) dst->max = src->max;
+  dst->sum += src->sum;
+  dst->n   += src->n;
+}
+//-----------------------------------------------------------------------------
+// store finished point (points on chunk edges are merged after join)
+static void ta_point_flush(ta_chunk_t *c, const ta_point_t *pt, uint64_t i)
+{
+  uint64_t first = i * c->decim, last = first + c->decim;
+
+  if (pt->n == 0) return;
+  if (first >= c->first && last <= c->first + c->rows)
+    c->points[i] = *pt; // whole point in this chunk
+  else if (c->edges < 2)
+    c->edge[c->edges++] = *pt;
+}
+//-----------------------------------------------------------------------------
+// count rows of chunk (pass 1)
+static void *ta_count_thread(void *context)
+{
+  ta_chunk_t *c = (ta_chunk_t*) context;
+  const char *p = c->begin;
+  uint64_t rows = 0;
+
+  while (p < c->end)
+  {
+    const char *nl = (const char*) memchr(p, '\n', c->end - p);
+    rows++;
+    if (nl == NULL) break;
+    p = nl + 1;
+  }
+
+  c->rows = rows;
+  return NULL;
+}
+//-----------------------------------------------------------------------------
+// parse rows of chunk (pass 2)
+static void *ta_parse_thread(void *context)
+{
+  ta_chunk_t *c = (ta_chunk_t*) context;
+  const char *p = c->begin;
+  uint64_t row = c->first, pi = row / c->decim;
+  char line[TA_LINE_MAX + 8];
+  ta_point_t pt;
+  ta_row_t r;
+  int retv;
+
+  memset(&pt, 0, sizeof(pt));
+  sstat_init(&c->stat);
+  c->bad = c->zero = 0;
+  c->nhi = c->nlo = c->edges = 0;
+
+  for (; p < c->end; row++)
+  {
+    const char *nl = (const char*) memchr(p, '\n', c->end - p);
+    const char *eol = nl ? nl : c->end;
+
+    if (c->map_end - eol >= 8)
+      retv = ta_line(p, &r); // 8 byte loads stay in mapped file
+    else
+    { // end of file: copy line to padded buffer
+      size_t len = eol - p;
+      if (len > TA_LINE_MAX) len = TA_LINE_MAX;
+      memcpy(line, p, len);
+      memset(line + len, '\n', 8);
+      retv = ta_line(line, &r);
+    }
+    p = eol + 1;
+
+    if (retv < 0 || r.dt < INT32_MIN + 1 || r.dt > INT32_MAX)
+    {
+      c->dt[row] = TA_BAD;
+      c->bad++;
+      continue;
+    }
+    c->dt[row] = (int32_t) r.dt;
+    if (r.dt == 0)
+    { // realtime clock step in `tick` - dt not valid
+      c->zero++;
+      continue;
+    }
+
+    sstat_add(&c->stat, r.dt * 1000);
+    r.row = row;
+    ta_outlier(c->hi, &c->nhi, c->outliers,  1, &r);
+    ta_outlier(c->lo, &c->nlo, c->outliers, -1, &r);
+
+    if (c->points)
+    { // decimated series
+      if (row / c->decim != pi)
+      {
+        ta_point_flush(c, &pt, pi);
+        pt.n = 0;
+        pi = row / c->decim;
+      }
+      if (pt.n == 0)
+      {
+        pt.row     = row;
+        pt.counter = r.counter;
+        pt.daytime = r.daytime;
+        pt.min     = pt.max = pt.sum = r.dt;
+        pt.n       = 1;
+      }
+      else
+      {
+        if (pt.min > r.dt) pt.min = r.dt;
+        if (pt.max < r.dt) pt.max = r.dt;
+        pt.sum += r.dt;
+        pt.n++;
+      }
+    }
+  }
+  if (c->points) ta_point_flush(c, &pt, pi);
+
+  return NULL;
+}
+//-----------------------------------------------------------------------------
+// run `fn` on all chunks in threads (return 0 or -1)
+static int ta_run(ta_chunk_t *chunks, int num, void *(*fn)(void*))
+{
+  int i, retv = 0;
+
+  for (i = 1; i < num; i++)
+    if (pthread_create(&chunks[i].thread, NULL, fn, (void*) (chunks + i)) != 0)
+    {
+      perror("error: pthread_create() fail");
+      retv = -1;
+      break;
+    }
+
+  fn((void*) chunks); // first chunk in main thread
+
+  while (--i > 0)
+    pthread_join(chunks[i].thread, NULL);
+
+  return retv;
+}
+//-----------------------------------------------------------------------------
+// seconds since `t0`
+static double ta_elapsed(const struct timespec *t0)
+{
+  struct timespec t1;
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  return (double) (t1.tv_sec  - t0->tv_sec) +
+         (double) (t1.tv_nsec - t0->tv_nsec) * 1e-9;
+}
+//-----------------------------------------------------------------------------
+// percentiles `p[n]` of good dt [us]: exact by counting if dt range is
+// small (usual case), else estimated by `sstat` histogram
+static void ta_percentiles(const int32_t *dt, uint64_t rows, const sstat_t *s,
+                           const double *p, int n, int64_t *out)
+{
+  int64_t min = s->min / 1000, range = s->max / 1000 - min + 1;
+  uint64_t *cnt, i, sum;
+  int64_t v;
+  int k;
+
+  cnt = range <= TA_EXACT_RANGE ?
+        (uint64_t*) calloc(range, sizeof(uint64_t)) : (uint64_t*) NULL;
+  if (cnt == NULL)
+  {
+    for (k = 0; k < n; k++)
+      out[k] = sstat_percentile(s, p[k]) / 1000;
+    return;
+  }
+
+  for (i = 0; i < rows; i++)
+    if (dt[i] != TA_BAD && dt[i] != 0)
+      cnt[dt[i] - min]++;
+
+  for (k = 0, v = 0, sum = 0; k < n; k++)
+  {
+    uint64_t rank = (uint64_t) (p[k] * 0.01 * (double) (s->count - 1));
+    for (; v < range - 1 && sum + cnt[v] <= rank; v++)
+      sum += cnt[v];
+    out[k] = min + v;
+  }
+  free(cnt);
+}
+//-----------------------------------------------------------------------------
+// print histogram of good dt between `lo` and `hi` [us]
+static void ta_histogram(const int32_t *dt, uint64_t rows, int64_t lo,
+                         int64_t hi, int bins)
+{
+  uint64_t *hist, under = 0, over = 0, max = 1, i;
+  int64_t width;
+  int b, bar;
+
+  hi++;
+  hist = (uint64_t*) calloc(bins, sizeof(uint64_t));
+  if (hist == NULL) return;
+  width = (hi - lo + bins - 1) / bins; // whole us per bin
+  hi = lo + width * bins;
+
+  for (i = 0; i < rows; i++)
+  {
+    int64_t v = dt[i];
+    if (v == TA_BAD || v == 0) continue;
+    if      (v <  lo) under++;
+    else if (v >= hi) over++;
+    else hist[(v - lo) / width]++;
+  }
+  for (b = 0; b < bins; b++)
+    if (max < hist[b]) max = hist[b];
+
+  printf("--- dt histogram (us) ---\n");
+  printf("%12s %12s %12llu\n", "-inf", "", (unsigned long long) under);
+  for (b = 0; b < bins; b++)
+  {
+    bar = (int) (hist[b] * 40 / max);
+    printf("%12.1f %12.1f %12llu %.*s\n",
+           (double) (lo + b * width), (double) (lo + (b + 1) * width),
+           (unsigned long long) hist[b], bar,
+           "########################################");
+  }
+  printf("%12s %12s %12llu\n", "", "+inf", (unsigned long long) over);
+  free(hist);
+}
+//-----------------------------------------------------------------------------
+// print Allan deviation (non overlapping) of dt as fractional frequency
+// for tau = 2^k * mean(dt)
+static void ta_adev(const int32_t *dt, uint64_t rows, double mean)
+{
+  float *a; // residuals, then block averages
+  int64_t t0 = (int64_t) (mean + 0.5);
+  uint64_t i, n = rows, m = 1;
+  long double sum;
+  double d;
+
+  if (mean <= 0.) return;
+  a = (float*) malloc(sizeof(float) * (rows ? rows : 1));
+  if (a == NULL) return;
+
+  // residual to nominal (exact in float for |dt - t0| < 16 s)
+  for (i = 0; i < n; i++)
+    a[i] = (dt[i] == TA_BAD || dt[i] == 0) ? (float) (mean - t0) :
+                                             (float) (dt[i] - t0);
+
+  printf("--- Allan deviation of dt (fractional) ---\n");
+  printf("%16s %12s %14s\n", "tau_s", "pairs", "adev");
+  for (; n >= 3; n /= 2, m *= 2)
+  {
+    for (sum = 0., i = 0; i + 1 < n; i++)
+    {
+      d = (double) a[i + 1] - (double) a[i];
+      sum += d * d;
+    }
+    printf("%16.6f %12llu %14.6e\n",
+           (double) m * mean * 1e-6, (unsigned long long) (n - 1),
+           sqrt((double) (sum / (2 * (n - 1)))) / mean);
+
+    for (i = 0; i < n / 2; i++) // next octave
+      a[i] = 0.5f * (a[2 * i] + a[2 * i + 1]);
+  }
+  free(a);
+}
+//-----------------------------------------------------------------------------
+int main(int argc, const char *argv[])
+{
+  options_t o;
+  static ta_chunk_t chunks[TA_THREADS_MAX]; // big histograms, not on stack
+  static ta_row_t hi[TA_OUTLIERS_MAX], lo[TA_OUTLIERS_MAX];
+  int nhi = 0, nlo = 0, i, j, fd;
+  struct stat st;
+  struct timespec t0;
+  const char *map;
+  uint64_t rows = 0, bad = 0, zero = 0, npoints = 0, decim = 1;
+  int32_t *dt;
+  ta_point_t *points = NULL;
+  sstat_t *stat = &chunks[0].stat;
+  static const double pct[] = { 0.1, 50., 90., 99., 99.9 };
+  int64_t pval[5];
+  double t_parse;
+
+  ta_parse_options(argc, argv, &o);
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+
+  // map whole file
+  fd = open(o.fname, O_RDONLY);
+  if (fd < 0 || fstat(fd, &st) < 0)
+  {
+    perror("error: can't open input file; exit");
+    exit(EXIT_FAILURE);
+  }
+  if (st.st_size == 0)
+  {
+    fprintf(stderr, "error: file '%s' is empty; exit\n", o.fname);
+    exit(EXIT_FAILURE);
+  }
+  map = (const char*) mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+  {
+    perror("error: mmap() fail; exit");
+    exit(EXIT_FAILURE);
+  }
+  madvise((void*) map, st.st_size, MADV_SEQUENTIAL);
+
+  // split to chunks of whole lines
+  if ((off_t) o.threads > st.st_size / 4096 + 1)
+    o.threads = (int) (st.st_size / 4096 + 1);
+  for (i = 0; i < o.threads; i++)
+  {
+    const char *p = map + st.st_size / o.threads * i;
+    if (i)
+    {
+      p = (const char*) memchr(p, '\n', map + st.st_size - p);
+      p = p ? p + 1 : map + st.st_size;
+    }
+    chunks[i].begin    = p;
+    chunks[i].map_end  = map + st.st_size;
+    chunks[i].outliers = o.outliers;
+    if (i) chunks[i - 1].end = p;
+  }
+  chunks[o.threads - 1].end = map + st.st_size;
+
+  // pass 1: count rows, global row index of each chunk
+  ta_run(chunks, o.threads, ta_count_thread);
+  for (i = 0; i < o.threads; i++)
+  {
+    chunks[i].first = rows;
+    rows += chunks[i].rows;
+  }
+
+  dt = (int32_t*) malloc(sizeof(int32_t) * (rows ? rows : 1));
+  if (dt == NULL)
+  {
+    fprintf(stderr, "error: can't allocate %llu rows; exit\n",
+            (unsigned long long) rows);
+    exit(EXIT_FAILURE);
+  }
+  if (o.out)
+  {
+    decim   = (rows + o.points - 1) / o.points;
+    if (decim == 0) decim = 1;
+    npoints = (rows + decim - 1) / decim;
+    points  = (ta_point_t*) calloc(npoints ? npoints : 1, sizeof(ta_point_t));
+    if (points == NULL)
+    {
+      fprintf(stderr, "error: can't allocate %llu points; exit\n",
+              (unsigned long long) npoints);
+      exit(EXIT_FAILURE);
+    }
+  }
+  for (i = 0; i < o.threads; i++)
+  {
+    chunks[i].dt     = dt;
+    chunks[i].points = points;
+    chunks[i].decim  = decim;
+  }
+
+  // pass 2: parse
+  ta_run(chunks, o.threads, ta_parse_thread);
+  t_parse = ta_elapsed(&t0);
+  munmap((void*) map, st.st_size);
+
+  // merge (threads are joined)
+  for (i = 0; i < o.threads; i++)
+  {
+    ta_chunk_t *c = chunks + i;
+    if (i) sstat_merge(stat, &c->stat);
+    bad  += c->bad;
+    zero += c->zero;
+    for (j = 0; j < c->nhi; j++)
+      ta_outlier(hi, &nhi, o.outliers,  1, c->hi + j);
+    for (j = 0; j < c->nlo; j++)
+      ta_outlier(lo, &nlo, o.outliers, -1, c->lo + j);
+    for (j = 0; j < c->edges; j++)
+      ta_point_merge(points + c->edge[j].row / decim, c->edge + j);
+  }
+
+  printf("--- TICK analyze ---\n");
+  printf("=> file            = %s (%.1f MB)\n", o.fname,
+         (double) st.st_size * 1e-6);
+  printf("=> rows            = %llu\n", (unsigned long long) rows);
+  printf("=> bad_rows        = %llu\n", (unsigned long long) bad);
+  printf("=> clock_steps     = %llu\n", (unsigned long long) zero);
+  printf("=> threads         = %d\n",   o.threads);
+  printf("=> parse_time      = %.3f s (%.0f MB/s)\n", t_parse,
+         (double) st.st_size * 1e-6 / t_parse);
+  if (stat->count == 0)
+  {
+    fprintf(stderr, "error: no valid rows in '%s'; exit\n", o.fname);
+    exit(EXIT_FAILURE);
+  }
+
+  // p0.1 and p99.9 are range of histogram
+  ta_percentiles(dt, rows, stat, pct, 5, pval);
+
+  printf("--- dt statistics (us) ---\n");
+  printf("   samples     min_us     p50_us     p90_us     p99_us"
+         "    p999_us     max_us    mean_us     dev_us\n");
+  printf("%10llu %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+         (unsigned long long) stat->count, stat->min * 1e-3,
+         (double) pval[1], (double) pval[2], (double) pval[3],
+         (double) pval[4], stat->max * 1e-3,
+         sstat_mean(stat) * 1e-3, sstat_dev(stat) * 1e-3);
+
+  ta_histogram(dt, rows, pval[0], pval[4], o.bins);
+
+  if (o.outliers)
+  {
+    printf("--- dt outliers ---\n");
+    printf("%12s %12s %16s %12s\n", "row", "counter", "daytime_ms", "dt_ms");
+    for (i = 0; i < nhi; i++)
+      printf("%12llu %12llu %16.3f %12.3f\n",
+             (unsigned long long) hi[i].row, (unsigned long long) hi[i].counter,
+             hi[i].daytime * 1e-3, hi[i].dt * 1e-3);
+    printf("%12s\n", "...");
+    for (i = nlo - 1; i >= 0; i--)
+      printf("%12llu %12llu %16.3f %12.3f\n",
+             (unsigned long long) lo[i].row, (unsigned long long) lo[i].counter,
+             lo[i].daytime * 1e-3, lo[i].dt * 1e-3);
+  }
+
+  if (o.out)
+  {
+    FILE *f = fopen(o.out, "w");
+    uint64_t k;
+    if (f == NULL)
+      perror("error: can't open output file");
+    else
+    {
+      for (k = 0; k < npoints; k++)
+        if (points[k].n)
+          fprintf(f, "%10llu %12.3f %12.3f %12.3f %12.3f\n",
+                  (unsigned long long) points[k].counter,
+                  points[k].daytime * 1e-3,
+                  points[k].min * 1e-3, points[k].max * 1e-3,
+                  (double) points[k].sum / points[k].n * 1e-3);
+      fclose(f);
+      printf("=> decimated       = %s (%llu rows per point)\n",
+             o.out, (unsigned long long) decim);
+    }
+    free(points);
+  }
+
+  ta_adev(dt, rows, sstat_mean(stat) * 1e-3);
+
+  printf("=> total_time      = %.3f s\n", ta_elapsed(&t0));
+  free(dt);
+  return EXIT_SUCCESS;
+}
+//-----------------------------------------------------------------------------
+
+/*** end of "tick_analyze.c" ***/
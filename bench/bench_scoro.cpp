@@ -0,0 +1,332 @@
+/*
+ * Per-resume overhead of scoro coroutines against plain stimer callback
+ * File: "bench_scoro.cpp"
+ * Кодировка: UTF-8
+ */
+
+//-----------------------------------------------------------------------------
+#include <cstdlib>     // exit(), EXIT_SUCCESS, EXIT_FAILURE, atoi(), atof()
+#include <cstring>     // strcmp()
+#include <cstdio>      // fprintf(), printf()
+#include <ctime>       // clock_gettime()
+#include <sys/epoll.h> // epoll_create1(), epoll_ctl(), epoll_wait()
+#include <unistd.h>    // close()
+//-----------------------------------------------------------------------------
+#include "scoro.hpp"
+#include "sstat.h"
+//-----------------------------------------------------------------------------
+// default number of timer ticks of each run
+#define BENCH_TICKS 2000
+
+// default timer interval [us]
+#define BENCH_INTERVAL_US 500.
+
+// default number of bare calls/resumes
+#define BENCH_RESUMES 10000000
+//-----------------------------------------------------------------------------
+// command line options
+struct options_t {
+  unsigned ticks;     // timer ticks of each run
+  double interval_us; // timer interval [us]
+  unsigned resumes;   // bare calls/resumes
+  int rt;             // 0|1 stimer_realtime()
+  int json;           // 0|1
+};
+//-----------------------------------------------------------------------------
+// timer driven run (same epoll + stimer_dispatch() loop for both paths)
+struct bench_t {
+  stimer_t timer;
+  sstat_t  stat;   // user code entry - timer wake-up [ns]
+  unsigned count;
+  unsigned ticks;
+  double   cpu_ns; // thread CPU time per tick [ns]
+};
+//-----------------------------------------------------------------------------
+static void bench_usage()
+{
+  fprintf(stderr,
+    "Per-resume overhead of scoro coroutines against stimer callback\n"
+    "Usage: bench_scoro [-options]\n"
+    "       bench_scoro --help\n");
+  exit(EXIT_FAILURE);
+}
+//-----------------------------------------------------------------------------
+static void bench_help()
+{
+  printf(
+    "Per-resume overhead of scoro coroutines against stimer callback\n"
+    "Run:  bench_scoro [-options]\n"
+    "Options:\n"
+    "   -h|--help          - show this help\n"
+    "   -n|--ticks N       - timer ticks of each run (2000 by default)\n"
+    "   -i|--interval US   - timer interval in us (500 by default)\n"
+    "   -c|--calls N       - bare calls/resumes (10000000 by default)\n"
+    "   -r|--real-time     - real time priority (root required)\n"
+    "   -j|--json          - JSON output (table by default)\n"
+    "Bare: indirect call of callback and coroutine resume/suspend in loop.\n"
+    "Timer: timerfd ticks, entry is user code time minus timer wake-up\n"
+    "(callback or resume after `co_await next_tick()`), cpu is thread CPU\n"
+    "time per tick.\n");
+  exit(EXIT_SUCCESS);
+}
+//-----------------------------------------------------------------------------
+// parse command line options
+static void bench_parse_options(int argc, const char *argv[], options_t *o)
+{
+  int i;
+
+  o->ticks       = BENCH_TICKS;
+  o->interval_us = BENCH_INTERVAL_US;
+  o->resumes     = BENCH_RESUMES;
+  o->rt          = 0;
+  o->json        = 0;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help"))
+      bench_help();
+    else if (!strcmp(argv[i], "-n") || !strcmp(argv[i], "--ticks"))
+    {
+      if (++i >= argc) bench_usage();
+      o->ticks = (unsigned) atoi(argv[i]);
+      if (o->ticks < 1) bench_usage();
+    }
+    else if (!strcmp(argv[i], "-i") || !strcmp(argv[i], "--interval"))
+    {
+      if (++i >= argc) bench_usage();
+      o->interval_us = atof(argv[i]);
+      if (o->interval_us <= 0.) bench_usage();
+    }
+    else if (!strcmp(argv[i], "-c") || !strcmp(argv[i], "--calls"))
+    {
+      if (++i >= argc) bench_usage();
+      o->resumes = (unsigned) atoi(argv[i]);
+      if (o->resumes < 1) bench_usage();
+    }
+    else if (!strcmp(argv[i], "-r") || !strcmp(argv[i], "--real-time"))
+      o->rt = 1;
+    else if (!strcmp(argv[i], "-j") || !strcmp(argv[i], "--json"))
+      o->json = 1;
+    else
+      bench_usage();
+  }
+}
+//-----------------------------------------------------------------------------
+static int64_t bench_clock(clockid_t clk)
+{
+  struct timespec ts;
+  clock_gettime(clk, &ts);
+  return ((int64_t) ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+//-----------------------------------------------------------------------------
+// bare callback: indirect call as stimer does
+static int bench_bare_callback(void *context)
+{
+  volatile unsigned *count = (volatile unsigned*) context;
+  *count = *count + 1;
+  return 0;
+}
+//-----------------------------------------------------------------------------
+// bare coroutine: suspend and give handle to caller
+struct bench_park_t {
+  std::coroutine_handle<> *slot;
+  bool await_ready() noexcept { return false; }
+  void await_suspend(std::coroutine_handle<> h) noexcept { *slot = h; }
+  void await_resume() noexcept {}
+};
+
+static scoro::Task bench_bare_task(scoro::Executor&,
+                                   std::coroutine_handle<> *slot,
+                                   volatile unsigned *count)
+{
+  for (;;)
+  {
+    co_await bench_park_t{slot};
+    *count = *count + 1;
+  }
+}
+//-----------------------------------------------------------------------------
+// ns per bare call (`coro` = 0) or resume (`coro` = 1)
+static double bench_bare(scoro::Executor &ex, unsigned n, int coro)
+{
+  int (*volatile fn)(void*) = bench_bare_callback;
+  volatile unsigned count = 0;
+  std::coroutine_handle<> slot;
+  int64_t t0, t1;
+  unsigned i;
+
+  if (!coro)
+  {
+    t0 = bench_clock(CLOCK_MONOTONIC);
+    for (i = 0; i < n; i++)
+      fn((void*) &count);
+    t1 = bench_clock(CLOCK_MONOTONIC);
+  }
+  else
+  { // frame from executor pool, run to first suspend
+    scoro::Task task = bench_bare_task(ex, &slot, &count);
+    if (!task) return -1.;
+    task.handle().resume();
+
+    t0 = bench_clock(CLOCK_MONOTONIC);
+    for (i = 0; i < n; i++)
+      slot.resume();
+    t1 = bench_clock(CLOCK_MONOTONIC);
+  }
+
+  return ((double) (t1 - t0)) / (double) n;
+}
+//-----------------------------------------------------------------------------
+// callback path: entry time of user code since wake-up
+static int bench_timer_handler(void *context)
+{
+  bench_t *b = (bench_t*) context;
+
+  sstat_add(&b->stat, stimer_time_ns(&b->timer) - b->timer.wakeup);
+  if (++b->count >= b->ticks)
+    stimer_stop(&b->timer);
+
+  return 0;
+}
+//-----------------------------------------------------------------------------
+// run callback path (return 0 or -1)
+static int bench_callback(bench_t *b, double interval_us)
+{
+  struct epoll_event ev;
+  int64_t cpu;
+  int epfd, fd, retv = 0;
+
+  sstat_init(&b->stat);
+  b->count = 0;
+
+  if (stimer_init_ex(&b->timer, STIMER_BACKEND_TIMERFD, bench_timer_handler,
+                     (void*) b) != 0)
+    return -1;
+
+  fd   = stimer_fd(&b->timer);
+  epfd = epoll_create1(EPOLL_CLOEXEC);
+  ev.events   = EPOLLIN;
+  ev.data.ptr = nullptr;
+  if (fd < 0 || epfd < 0 || epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) != 0 ||
+      stimer_start(&b->timer, interval_us * 1e-3) != 0)
+    retv = -1;
+
+  cpu = bench_clock(CLOCK_THREAD_CPUTIME_ID);
+  while (retv == 0 && !stimer_stopped(&b->timer))
+  {
+    if (epoll_wait(epfd, &ev, 1, -1) < 0) continue;
+    if (stimer_dispatch(&b->timer) < 0) retv = -1;
+  }
+  cpu = bench_clock(CLOCK_THREAD_CPUTIME_ID) - cpu;
+  b->cpu_ns = ((double) cpu) / (double) (b->count ? b->count : 1);
+
+  if (epfd >= 0) close(epfd);
+  stimer_free(&b->timer);
+  return retv;
+}
+//-----------------------------------------------------------------------------
+// coroutine path: entry time of task after `co_await next_tick()`
+static scoro::Task bench_ticks(scoro::Executor &ex, bench_t *b)
+{
+  while (b->count < b->ticks)
+  {
+    co_await ex.next_tick();
+    sstat_add(&b->stat, ex.now() - ex.wakeup());
+    b->count++;
+  }
+}
+//-----------------------------------------------------------------------------
+// run coroutine path (return 0 or -1)
+static int bench_coroutine(bench_t *b, double interval_us)
+{
+  scoro::Executor ex(4);
+  int64_t cpu;
+  int retv;
+
+  sstat_init(&b->stat);
+  b->count = 0;
+
+  if (!ex || !ex.spawn(bench_ticks(ex, b)))
+    return -1;
+
+  cpu  = bench_clock(CLOCK_THREAD_CPUTIME_ID);
+  retv = ex.run(interval_us * 1e-3);
+  cpu  = bench_clock(CLOCK_THREAD_CPUTIME_ID) - cpu;
+  b->cpu_ns = ((double) cpu) / (double) (b->count ? b->count : 1);
+
+  return retv;
+}
+//-----------------------------------------------------------------------------
+// print result of timer driven run
+static void bench_print(const options_t *o, const bench_t *b,
+                        const char *path, int first)
+{
+  const sstat_t *s = &b->stat;
+
+  if (o->json)
+    printf("%s\n  {\"path\": \"%s\", \"interval_us\": %g, \"rt\": %s, "
+           "\"samples\": %llu, \"entry_p50_ns\": %lld, "
+           "\"entry_p99_ns\": %lld, \"entry_max_ns\": %lld, "
+           "\"entry_mean_ns\": %.1f, \"cpu_ns_tick\": %.1f}",
+           first ? "" : ",", path, o->interval_us, o->rt ? "true" : "false",
+           (unsigned long long) s->count,
+           (long long) sstat_percentile(s, 50.),
+           (long long) sstat_percentile(s, 99.),
+           (long long) s->max, sstat_mean(s), b->cpu_ns);
+  else
+    printf("%-10s %9llu %9lld %9lld %9lld %9.1f %11.1f\n", path,
+           (unsigned long long) s->count,
+           (long long) sstat_percentile(s, 50.),
+           (long long) sstat_percentile(s, 99.),
+           (long long) s->max, sstat_mean(s), b->cpu_ns);
+  fflush(stdout);
+}
+//-----------------------------------------------------------------------------
+int main(int argc, const char *argv[])
+{
+  options_t o;
+  static bench_t b; // big histogram, not on stack
+  double call_ns, resume_ns;
+
+  bench_parse_options(argc, argv, &o);
+
+  if (o.rt && stimer_realtime() != 0)
+  {
+    fprintf(stderr, "warning: no real time priority (root required)\n");
+    o.rt = 0;
+  }
+
+  // bare: indirect call against resume/suspend of pooled frame
+  {
+    scoro::Executor ex(1);
+    call_ns   = bench_bare(ex, o.resumes, 0);
+    resume_ns = bench_bare(ex, o.resumes, 1);
+  }
+
+  if (o.json)
+    printf("[\n  {\"path\": \"bare\", \"calls\": %u, \"call_ns\": %.2f, "
+           "\"resume_ns\": %.2f},", o.resumes, call_ns, resume_ns);
+  else
+    printf("bare: call %.2f ns, resume %.2f ns (%u times)\n"
+           "path         samples  entry_p50 entry_p99 entry_max"
+           "     mean cpu_ns_tick\n", call_ns, resume_ns, o.resumes);
+
+  b.ticks = o.ticks;
+  if (bench_callback(&b, o.interval_us) != 0)
+    fprintf(stderr, "error: callback path fail\n");
+  else
+    bench_print(&o, &b, "callback", 1);
+
+  if (bench_coroutine(&b, o.interval_us) != 0)
+    fprintf(stderr, "error: coroutine path fail\n");
+  else
+    bench_print(&o, &b, "coroutine", 0);
+
+  if (o.json)
+    printf("\n]\n");
+
+  return EXIT_SUCCESS;
+}
+//-----------------------------------------------------------------------------
+
+/*** end of "bench_scoro.cpp" ***/
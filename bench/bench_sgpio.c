@@ -0,0 +1,544 @@
+/*
+ * Throughput and latency benchmark of sgpio operations (set/get/toggle,
+ * multi-pin update, poll/epoll) for fake and sysfs backends
+ * File: "bench_sgpio.c"
+ * Кодировка: UTF-8
+ */
+
+//-----------------------------------------------------------------------------
+#include <stdlib.h>    // exit(), EXIT_SUCCESS, EXIT_FAILURE, atof(), calloc()
+#include <string.h>    // strcmp(), strtol()
+#include <stdio.h>     // fprintf(), printf()
+#include <time.h>      // clock_gettime()
+#include <pthread.h>   // pthread_create(), pthread_barrier_t
+//-----------------------------------------------------------------------------
+#include "sgpio.h"
+#include "sstat.h"
+//-----------------------------------------------------------------------------
+// max number of items in lists (pins, threads, ops, backends)
+#define BENCH_LIST_MAX 32
+
+// max number of threads
+#define BENCH_THREADS_MAX 64
+
+// default GPIO numbers (first is used by single pin ops)
+#define BENCH_GPIOS "5,6"
+
+// default thread counts
+#define BENCH_THREADS "1,2"
+
+// default backends
+#define BENCH_BACKENDS "fake,sysfs"
+
+// default operations
+#define BENCH_OPS "set,get,toggle,multi,poll,epoll,edge"
+
+// check time in untimed loop every BENCH_CHUNK operations
+#define BENCH_CHUNK 64
+//-----------------------------------------------------------------------------
+// backends
+#define BENCH_FAKE  0
+#define BENCH_SYSFS 1
+
+// operations
+#define BENCH_OP_SET    0 // sgpio_set(1)
+#define BENCH_OP_GET    1 // sgpio_get()
+#define BENCH_OP_TOGGLE 2 // sgpio_set(0/1)
+#define BENCH_OP_MULTI  3 // sgpio_set(0/1) of all pins
+#define BENCH_OP_POLL   4 // sgpio_poll(0)
+#define BENCH_OP_EPOLL  5 // sgpio_epoll(0)
+#define BENCH_OP_EDGE   6 // sgpio_edge_wait(0)
+#define BENCH_OPS_NUM   7
+//-----------------------------------------------------------------------------
+static const char *bench_backend_names[] = { "fake", "sysfs" };
+
+static const char *bench_op_names[] = {
+  "set", "get", "toggle", "multi", "poll", "epoll", "edge"
+};
+//-----------------------------------------------------------------------------
+// command line options
+typedef struct options_ {
+  double duration;                  // seconds per configuration
+  int json;                         // 0|1
+  const char *gpio_path;            // sysfs GPIO path (NULL - default)
+  int gpios_num;
+  int gpios[BENCH_LIST_MAX];        // GPIO numbers
+  int threads_num;
+  int threads[BENCH_LIST_MAX];      // thread counts
+  int backends_num;
+  int backends[BENCH_LIST_MAX];     // BENCH_FAKE|BENCH_SYSFS
+  int ops_num;
+  int ops[BENCH_LIST_MAX];          // BENCH_OP_*
+} options_t;
+//-----------------------------------------------------------------------------
+// one thread of configuration run
+typedef struct bench_thread_ {
+  pthread_t thread;
+  struct bench_ *b;
+  sgpio_t gpio[BENCH_LIST_MAX];     // own handles (own "value" fd)
+  sgpio_fake_t fake;
+  sstat_t stat;                     // time of operation [ns]
+  uint64_t ops;                     // operations of untimed loop
+  double elapsed;                   // time of untimed loop [s]
+  int err;                          // first error (SGPIO_ERR_*)
+} bench_thread_t;
+//-----------------------------------------------------------------------------
+// one configuration run
+typedef struct bench_ {
+  int backend, op, pins, threads;
+  double duration;                  // seconds per phase
+  pthread_barrier_t barrier;
+  bench_thread_t *t;                // BENCH_THREADS_MAX threads
+  sstat_t stat;                     // merged time of operation [ns]
+  double ops_per_s;                 // sum of all threads
+  double ns_per_op;                 // mean of all threads
+} bench_t;
+//-----------------------------------------------------------------------------
+static void bench_usage()
+{
+  fprintf(stderr,
+    "Throughput and latency benchmark of sgpio operations\n"
+    "Usage: bench_sgpio [-options]\n"
+    "       bench_sgpio --help\n");
+  exit(EXIT_FAILURE);
+}
+//-----------------------------------------------------------------------------
+static void bench_help()
+{
+  printf(
+    "Throughput and latency benchmark of sgpio operations\n"
+    "Run:  bench_sgpio [-options]\n"
+    "Options:\n"
+    "   -h|--help          - show this help\n"
+    "   -b|--backends LIST - backends (" BENCH_BACKENDS " by default)\n"
+    "   -o|--ops LIST      - operations (" BENCH_OPS "\n"
+    "                        by default)\n"
+    "   -g|--gpio LIST     - GPIO numbers (" BENCH_GPIOS " by default)\n"
+    "   -t|--threads LIST  - thread counts (" BENCH_THREADS " by default)\n"
+    "   -G|--gpio-path DIR - sysfs GPIO path (stand-in directory for test)\n"
+    "                        (" SGPIO_MAIN_PATH " by default)\n"
+    "   -d|--duration SEC  - duration of each run (1 s by default)\n"
+    "   -j|--json          - JSON output (table by default)\n"
+    "Operations:\n"
+    "   set    - sgpio_set(1)\n"
+    "   get    - sgpio_get()\n"
+    "   toggle - sgpio_set(0/1)\n"
+    "   multi  - sgpio_set(0/1) of all GPIO in list (one update)\n"
+    "   poll   - sgpio_poll(0) of input with edge (no edge expected)\n"
+    "   epoll  - sgpio_epoll(0), epoll set made on every call\n"
+    "   edge   - sgpio_edge_wait(0), persistent epoll set\n"
+    "Every thread opens own handles, thread N starts from N-th GPIO.\n"
+    "Half of duration is untimed loop (ops_per_s, ns_op - all threads),\n"
+    "half is timing of every operation (percentiles, include clock cost).\n"
+    "poll/epoll/edge need real sysfs (not fake or regular files).\n");
+  exit(EXIT_SUCCESS);
+}
+//-----------------------------------------------------------------------------
+// parse comma separated list of positive integers
+static int bench_parse_ints(const char *str, int *list, int max)
+{
+  int n = 0;
+  char *end;
+
+  while (n < BENCH_LIST_MAX)
+  {
+    list[n] = (int) strtol(str, &end, 10);
+    if (end == str || list[n] < 0 || list[n] > max) bench_usage();
+    n++;
+    if (*end != ',') break;
+    str = end + 1;
+  }
+
+  return n;
+}
+//-----------------------------------------------------------------------------
+// parse comma separated list of names (index in `names`)
+static int bench_parse_names(const char *str, int *list,
+                             const char **names, int names_num)
+{
+  char name[32];
+  int n = 0, i;
+
+  while (n < BENCH_LIST_MAX && *str)
+  {
+    for (i = 0; *str && *str != ',' && i < (int) sizeof(name) - 1; i++)
+      name[i] = *str++;
+    name[i] = '\0';
+    if (*str == ',') str++;
+
+    for (i = 0; i < names_num; i++)
+      if (!strcmp(name, names[i])) break;
+    if (i == names_num) bench_usage();
+    list[n++] = i;
+  }
+
+  return n;
+}
+//-----------------------------------------------------------------------------
+// parse command line options
+static void bench_parse_options(int argc, const char *argv[], options_t *o)
+{
+  int i;
+
+  // set options by default
+  o->duration     = 1.;
+  o->json         = 0;
+  o->gpio_path    = NULL;
+  o->gpios_num    = bench_parse_ints(BENCH_GPIOS, o->gpios, 100000);
+  o->threads_num  = bench_parse_ints(BENCH_THREADS, o->threads,
+                                     BENCH_THREADS_MAX);
+  o->backends_num = bench_parse_names(BENCH_BACKENDS, o->backends,
+                                      bench_backend_names, 2);
+  o->ops_num      = bench_parse_names(BENCH_OPS, o->ops,
+                                      bench_op_names, BENCH_OPS_NUM);
+
+  for (i = 1; i < argc; i++)
+  {
+    if (!strcmp(argv[i], "-h") ||
+        !strcmp(argv[i], "--help"))
+    { // print help
+      bench_help();
+    }
+    else if (!strcmp(argv[i], "-b") ||
+             !strcmp(argv[i], "--backends"))
+    { // backends
+      if (++i >= argc) bench_usage();
+      o->backends_num = bench_parse_names(argv[i], o->backends,
+                                          bench_backend_names, 2);
+    }
+    else if (!strcmp(argv[i], "-o") ||
+             !strcmp(argv[i], "--ops"))
+    { // operations
+      if (++i >= argc) bench_usage();
+      o->ops_num = bench_parse_names(argv[i], o->ops,
+                                     bench_op_names, BENCH_OPS_NUM);
+    }
+    else if (!strcmp(argv[i], "-g") ||
+             !strcmp(argv[i], "--gpio"))
+    { // GPIO numbers
+      if (++i >= argc) bench_usage();
+      o->gpios_num = bench_parse_ints(argv[i], o->gpios, 100000);
+    }
+    else if (!strcmp(argv[i], "-t") ||
+             !strcmp(argv[i], "--threads"))
+    { // thread counts
+      if (++i >= argc) bench_usage();
+      o->threads_num = bench_parse_ints(argv[i], o->threads,
+                                        BENCH_THREADS_MAX);
+    }
+    else if (!strcmp(argv[i], "-G") ||
+             !strcmp(argv[i], "--gpio-path"))
+    { // sysfs GPIO path
+      if (++i >= argc) bench_usage();
+      o->gpio_path = argv[i];
+    }
+    else if (!strcmp(argv[i], "-d") ||
+             !strcmp(argv[i], "--duration"))
+    { // duration
+      if (++i >= argc) bench_usage();
+      o->duration = atof(argv[i]);
+    }
+    else if (!strcmp(argv[i], "-j") ||
+             !strcmp(argv[i], "--json"))
+    { // JSON output
+      o->json = 1;
+    }
+    else
+      bench_usage();
+  }
+
+  for (i = 0; i < o->threads_num; i++)
+    if (o->threads[i] < 1) bench_usage();
+}
+//-----------------------------------------------------------------------------
+// CLOCK_MONOTONIC time [ns]
+static inline int64_t bench_time_ns()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((int64_t) ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+//-----------------------------------------------------------------------------
+// do one operation, `k` - operation counter (return SGPIO_ERR_* if < 0)
+static inline int bench_op(bench_thread_t *t, int op, int pins, unsigned k)
+{
+  int i, retv;
+
+  switch (op)
+  {
+  case BENCH_OP_SET:    return sgpio_set(t->gpio, 1);
+  case BENCH_OP_GET:    return sgpio_get(t->gpio);
+  case BENCH_OP_TOGGLE: return sgpio_set(t->gpio, k & 1);
+  case BENCH_OP_POLL:   return sgpio_poll(t->gpio, 0);
+  case BENCH_OP_EPOLL:  return sgpio_epoll(t->gpio, 0);
+  case BENCH_OP_EDGE:   return sgpio_edge_wait(t->gpio, 0, NULL);
+  default: // BENCH_OP_MULTI
+    for (i = 0; i < pins; i++)
+      if ((retv = sgpio_set(t->gpio + i, k & 1)) < 0)
+        return retv;
+    return 0;
+  }
+}
+//-----------------------------------------------------------------------------
+// open handles of thread `n` (return SGPIO_ERR_*)
+static int bench_thread_open(bench_t *b, bench_thread_t *t,
+                             const options_t *o, int n)
+{
+  int input = b->op >= BENCH_OP_POLL;
+  int i, retv;
+
+  for (i = 0; i < b->pins; i++)
+  {
+    sgpio_init(t->gpio + i, o->gpios[(n + i) % o->gpios_num]);
+
+    if (b->backend == BENCH_FAKE)
+      sgpio_fake(t->gpio + i, &t->fake);
+    else if ((retv = sgpio_open(t->gpio + i, SGPIO_UDEV_TIMEOUT)) < 0)
+      return retv;
+
+    retv = sgpio_mode(t->gpio + i,
+                      input ? SGPIO_DIR_IN   : SGPIO_DIR_OUT,
+                      input ? SGPIO_EDGE_BOTH : SGPIO_EDGE_NONE);
+    if (retv < 0) return retv;
+
+    if (!input && (retv = sgpio_set(t->gpio + i, 0)) < 0)
+      return retv; // defined level before run
+  }
+
+  if (b->op == BENCH_OP_EDGE)
+    return sgpio_edge_open(t->gpio);
+
+  return SGPIO_ERR_NONE;
+}
+//-----------------------------------------------------------------------------
+// close handles of thread (unexport GPIO exported by this thread)
+static void bench_thread_close(bench_t *b, bench_thread_t *t)
+{
+  int i;
+
+  for (i = 0; i < b->pins; i++)
+  {
+    sgpio_free(t->gpio + i);
+    if (t->gpio[i].exported)
+      sgpio_unexport(t->gpio[i].num);
+  }
+}
+//-----------------------------------------------------------------------------
+// benchmark thread: untimed loop, then timed loop
+static void *bench_thread(void *context)
+{
+  bench_thread_t *t = (bench_thread_t*) context;
+  bench_t *b = t->b;
+  int op = b->op, pins = b->pins, fake = b->backend == BENCH_FAKE;
+  int64_t t0, t1, end, span = (int64_t) (b->duration * 1e9);
+  unsigned k = 0, i;
+  int retv;
+
+  pthread_barrier_wait(&b->barrier);
+
+  // untimed loop: throughput
+  t0  = bench_time_ns();
+  end = t0 + span;
+  do {
+    for (i = 0; i < BENCH_CHUNK; i++, k++)
+      if ((retv = bench_op(t, op, pins, k)) < 0 && t->err == 0)
+        t->err = retv;
+    if (fake) t->fake.count = 0; // keep fake buffer from filling up
+    t1 = bench_time_ns();
+  } while (t1 < end);
+  t->ops     = k;
+  t->elapsed = (double) (t1 - t0) * 1e-9;
+
+  pthread_barrier_wait(&b->barrier);
+
+  // timed loop: time of every operation
+  end = bench_time_ns() + span;
+  do {
+    for (i = 0; i < BENCH_CHUNK; i++, k++)
+    {
+      t0 = bench_time_ns();
+      bench_op(t, op, pins, k);
+      t1 = bench_time_ns();
+      sstat_add(&t->stat, t1 - t0);
+    }
+    if (fake) t->fake.count = 0;
+  } while (t1 < end);
+
+  return NULL;
+}
+//-----------------------------------------------------------------------------
+// run one configuration (return SGPIO_ERR_*)
+static int bench_run(bench_t *b, const options_t *o)
+{
+  bench_thread_t *t;
+  int i, n, retv = SGPIO_ERR_NONE;
+
+  sstat_init(&b->stat);
+  b->ops_per_s = b->ns_per_op = 0.;
+
+  // open handles and check operation once
+  for (n = 0; n < b->threads; n++)
+  {
+    t = b->t + n;
+    t->b   = b;
+    t->ops = 0;
+    t->err = SGPIO_ERR_NONE;
+    sstat_init(&t->stat);
+
+    if (b->backend == BENCH_FAKE &&
+        (retv = sgpio_fake_init(&t->fake, SGPIO_FAKE_SIZE)) < 0)
+      break;
+
+    retv = bench_thread_open(b, t, o, n);
+    if (retv == SGPIO_ERR_NONE)
+    {
+      retv = bench_op(t, b->op, b->pins, 0);
+      if (retv > 0) retv = SGPIO_ERR_NONE;
+    }
+
+    if (retv < 0)
+    {
+      n++;
+      break;
+    }
+  }
+
+  if (retv == SGPIO_ERR_NONE)
+  {
+    pthread_barrier_init(&b->barrier, NULL, b->threads);
+
+    for (i = 0; i < b->threads; i++)
+      if (pthread_create(&b->t[i].thread, NULL, bench_thread,
+                         (void*) (b->t + i)) != 0)
+      {
+        fprintf(stderr, "error: can't create thread\n");
+        exit(EXIT_FAILURE); // barrier can't be left
+      }
+
+    for (i = 0; i < b->threads; i++)
+    {
+      t = b->t + i;
+      pthread_join(t->thread, NULL);
+      sstat_merge(&b->stat, &t->stat);
+      if (t->ops)
+      {
+        b->ops_per_s += (double) t->ops / t->elapsed;
+        b->ns_per_op += t->elapsed * 1e9 / (double) t->ops / b->threads;
+      }
+      if (t->err < 0 && retv == SGPIO_ERR_NONE)
+        retv = t->err;
+    }
+
+    pthread_barrier_destroy(&b->barrier);
+  }
+
+  // close handles
+  for (i = 0; i < n; i++)
+  {
+    bench_thread_close(b, b->t + i);
+    if (b->backend == BENCH_FAKE)
+      sgpio_fake_free(&b->t[i].fake);
+  }
+
+  return retv;
+}
+//-----------------------------------------------------------------------------
+// print result of one configuration
+static void bench_print(const options_t *o, const bench_t *b, int first)
+{
+  const sstat_t *s = &b->stat;
+
+  if (o->json)
+  {
+    printf("%s\n  {\"backend\": \"%s\", \"op\": \"%s\", \"threads\": %d, "
+           "\"pins\": %d, \"ops_per_s\": %.0f, \"ns_op\": %.1f, "
+           "\"samples\": %llu, \"min_ns\": %lld, \"p50_ns\": %lld, "
+           "\"p90_ns\": %lld, \"p99_ns\": %lld, \"p999_ns\": %lld, "
+           "\"max_ns\": %lld, \"mean_ns\": %.1f, \"dev_ns\": %.1f}",
+           first ? "" : ",",
+           bench_backend_names[b->backend], bench_op_names[b->op],
+           b->threads, b->pins, b->ops_per_s, b->ns_per_op,
+           (unsigned long long) s->count,
+           (long long) s->min,
+           (long long) sstat_percentile(s, 50.),
+           (long long) sstat_percentile(s, 90.),
+           (long long) sstat_percentile(s, 99.),
+           (long long) sstat_percentile(s, 99.9),
+           (long long) s->max,
+           sstat_mean(s), sstat_dev(s));
+  }
+  else
+  {
+    printf("%-7s %-6s %7d %4d %11.0f %9.1f ",
+           bench_backend_names[b->backend], bench_op_names[b->op],
+           b->threads, b->pins, b->ops_per_s, b->ns_per_op);
+    sstat_fprint(stdout, s, 1.);
+    printf("\n");
+  }
+  fflush(stdout);
+}
+//-----------------------------------------------------------------------------
+int main(int argc, const char *argv[])
+{
+  options_t o;
+  bench_t b;
+  int i, j, k, retv, first = 1;
+
+  bench_parse_options(argc, argv, &o);
+
+  if (o.gpio_path)
+    sgpio_set_path(o.gpio_path);
+
+  // big histograms, not on stack
+  b.t = (bench_thread_t*) calloc(BENCH_THREADS_MAX, sizeof(bench_thread_t));
+  if (b.t == (bench_thread_t*) NULL)
+  {
+    fprintf(stderr, "error: can't allocate memory\n");
+    return EXIT_FAILURE;
+  }
+  b.duration = o.duration * 0.5;
+
+  if (o.json)
+    printf("[");
+  else
+    printf("backend op     threads pins   ops_per_s     ns_op    samples"
+           "     min_ns     p50_ns     p90_ns     p99_ns    p999_ns"
+           "     max_ns    mean_ns     dev_ns\n");
+
+  for (i = 0; i < o.backends_num; i++)
+  {
+    for (j = 0; j < o.ops_num; j++)
+    {
+      b.backend = o.backends[i];
+      b.op      = o.ops[j];
+      b.pins    = b.op == BENCH_OP_MULTI ? o.gpios_num : 1;
+
+      if (b.backend == BENCH_FAKE && b.op >= BENCH_OP_POLL)
+        continue; // fake GPIO has no file descriptor to wait
+
+      for (k = 0; k < o.threads_num; k++)
+      {
+        b.threads = o.threads[k];
+        retv = bench_run(&b, &o);
+        if (retv < 0)
+        {
+          fprintf(stderr, "error: %s %s: %s; skip\n",
+                  bench_backend_names[b.backend], bench_op_names[b.op],
+                  sgpio_error_str(retv));
+          break;
+        }
+        bench_print(&o, &b, first);
+        first = 0;
+      }
+    }
+  }
+
+  if (o.json)
+    printf("\n]\n");
+
+  free((void*) b.t);
+  return EXIT_SUCCESS;
+}
+//-----------------------------------------------------------------------------
+
+/*** end of "bench_sgpio.c" ***/
@@ -0,0 +1,305 @@
+/*
+ * Wake-up latency benchmark of stimer backends (cyclictest-like)
+ * File: "bench_stimer.c"
+ * Кодировка: UTF-8
+ */
+
+//-----------------------------------------------------------------------------
+#include <stdlib.h>    // exit(), EXIT_SUCCESS, EXIT_FAILURE, atof(), strtod()
+#include <string.h>    // strcmp(), memset()
+#include <stdio.h>     // fprintf(), printf(), perror()
+#include <sched.h>     // sched_setscheduler(), SCHED_OTHER
+//-----------------------------------------------------------------------------
+#include "stimer.h"
+#include "sstat.h"
+//-----------------------------------------------------------------------------
+// max number of intervals/backends in lists
+#define BENCH_LIST_MAX 32
+
+// default intervals [us]
+#define BENCH_INTERVALS "50,100,500,1000,5000,10000,100000"
+
+// default backends
+#define BENCH_BACKENDS "signal,timerfd,sleep,uring"
+//-----------------------------------------------------------------------------
+// command line options
+typedef struct options_ {
+  double duration;                  // seconds per configuration
+  unsigned min_samples;             // min samples per configuration
+  int rt_off, rt_on;                // measure without/with stimer_realtime()
+  int json;                         // 0|1
+  int intervals_num;
+  double intervals[BENCH_LIST_MAX]; // us
+  int backends_num;
+  int backends[BENCH_LIST_MAX];     // STIMER_BACKEND_*
+} options_t;
+//-----------------------------------------------------------------------------
+// one configuration run
+typedef struct bench_ {
+  stimer_t timer;
+  sstat_t  stat;      // latency [ns]
+  int64_t  end;       // stop time [ns]
+  unsigned min_samples;
+} bench_t;
+//-----------------------------------------------------------------------------
+static void bench_usage()
+{
+  fprintf(stderr,
+    "Wake-up latency benchmark of stimer backends\n"
+    "Usage: bench_stimer [-options]\n"
+    "       bench_stimer --help\n");
+  exit(EXIT_FAILURE);
+}
+//-----------------------------------------------------------------------------
+static void bench_help()
+{
+  printf(
+    "Wake-up latency benchmark of stimer backends\n"
+    "Run:  bench_stimer [-options]\n"
+    "Options:\n"
+    "   -h|--help          - show this help\n"
+    "   -b|--backends LIST - backends (" BENCH_BACKENDS " by default)\n"
+    "   -i|--intervals LIST- intervals in us\n"
+    "                        (" BENCH_INTERVALS " by default)\n"
+    "   -d|--duration SEC  - duration of each run (1 s by default)\n"
+    "   -m|--min-samples N - min samples of each run (10 by default)\n"
+    "   -n|--no-rt         - don't measure with real time priority\n"
+    "   -r|--rt-only       - measure with real time priority only\n"
+    "   -j|--json          - JSON output (table by default)\n"
+    "Latency is actual wake-up time minus scheduled deadline.\n");
+  exit(EXIT_SUCCESS);
+}
+//-----------------------------------------------------------------------------
+// parse comma separated list of intervals
+static int bench_parse_intervals(const char *str, double *list)
+{
+  int n = 0;
+  char *end;
+
+  while (n < BENCH_LIST_MAX)
+  {
+    list[n] = strtod(str, &end);
+    if (end == str || list[n] <= 0.) bench_usage();
+    n++;
+    if (*end != ',') break;
+    str = end + 1;
+  }
+
+  return n;
+}
+//-----------------------------------------------------------------------------
+// parse comma separated list of backends
+static int bench_parse_backends(const char *str, int *list)
+{
+  char name[32];
+  int n = 0, i;
+
+  while (n < BENCH_LIST_MAX && *str)
+  {
+    for (i = 0; *str && *str != ',' && i < (int) sizeof(name) - 1; i++)
+      name[i] = *str++;
+    name[i] = '\0';
+    if (*str == ',') str++;
+
+    list[n] = stimer_backend(name);
+    if (list[n] < 0 || list[n] == STIMER_BACKEND_SIM) bench_usage();
+    n++;
+  }
+
+  return n;
+}
+//-----------------------------------------------------------------------------
+// parse command line options
+static void bench_parse_options(int argc, const char *argv[], options_t *o)
+{
+  int i;
+
+  // set options by default
+  o->duration      = 1.;
+  o->min_samples   = 10;
+  o->rt_off        = 1;
+  o->rt_on         = 1;
+  o->json          = 0;
+  o->intervals_num = bench_parse_intervals(BENCH_INTERVALS, o->intervals);
+  o->backends_num  = bench_parse_backends(BENCH_BACKENDS, o->backends);
+
+  for (i = 1; i < argc; i++)
+  {
+    if (!strcmp(argv[i], "-h") ||
+        !strcmp(argv[i], "--help"))
+    { // print help
+      bench_help();
+    }
+    else if (!strcmp(argv[i], "-b") ||
+             !strcmp(argv[i], "--backends"))
+    { // backends
+      if (++i >= argc) bench_usage();
+      o->backends_num = bench_parse_backends(argv[i], o->backends);
+    }
+    else if (!strcmp(argv[i], "-i") ||
+             !strcmp(argv[i], "--intervals"))
+    { // intervals
+      if (++i >= argc) bench_usage();
+      o->intervals_num = bench_parse_intervals(argv[i], o->intervals);
+    }
+    else if (!strcmp(argv[i], "-d") ||
+             !strcmp(argv[i], "--duration"))
+    { // duration
+      if (++i >= argc) bench_usage();
+      o->duration = atof(argv[i]);
+    }
+    else if (!strcmp(argv[i], "-m") ||
+             !strcmp(argv[i], "--min-samples"))
+    { // min samples
+      if (++i >= argc) bench_usage();
+      o->min_samples = (unsigned) atoi(argv[i]);
+    }
+    else if (!strcmp(argv[i], "-n") ||
+             !strcmp(argv[i], "--no-rt"))
+    { // without real time
+      o->rt_on  = 0;
+      o->rt_off = 1;
+    }
+    else if (!strcmp(argv[i], "-r") ||
+             !strcmp(argv[i], "--rt-only"))
+    { // real time only
+      o->rt_on  = 1;
+      o->rt_off = 0;
+    }
+    else if (!strcmp(argv[i], "-j") ||
+             !strcmp(argv[i], "--json"))
+    { // JSON output
+      o->json = 1;
+    }
+    else
+      bench_usage();
+  }
+}
+//-----------------------------------------------------------------------------
+// timer handler: measure wake-up latency
+static int bench_timer_handler(void *context)
+{
+  bench_t *b = (bench_t*) context;
+  int64_t now = stimer_time_ns(&b->timer);
+
+  sstat_add(&b->stat, now - b->timer.deadline);
+
+  if (now >= b->end && b->stat.count >= b->min_samples)
+    return 1; // enough
+
+  return 0;
+}
+//-----------------------------------------------------------------------------
+// run one configuration (return 0 or -1 on error)
+static int bench_run(bench_t *b, int backend, double interval_us,
+                     double duration)
+{
+  int retv;
+
+  sstat_init(&b->stat);
+
+  retv = stimer_init_ex(&b->timer, backend, bench_timer_handler, (void*) b);
+  if (retv != 0) return -1;
+
+  b->end = stimer_time_ns(&b->timer) + (int64_t) (duration * 1e9);
+
+  retv = stimer_start(&b->timer, interval_us * 1e-3);
+  if (retv == 0)
+    retv = stimer_loop(&b->timer);
+
+  stimer_free(&b->timer);
+  return retv < 0 ? -1 : 0;
+}
+//-----------------------------------------------------------------------------
+// print result of one configuration
+static void bench_print(const options_t *o, const bench_t *b, int backend,
+                        double interval_us, int rt, int first)
+{
+  const sstat_t *s = &b->stat;
+
+  if (o->json)
+  {
+    printf("%s\n  {\"backend\": \"%s\", \"interval_us\": %g, \"rt\": %s, "
+           "\"samples\": %llu, \"min_us\": %.3f, \"p50_us\": %.3f, "
+           "\"p90_us\": %.3f, \"p99_us\": %.3f, \"p999_us\": %.3f, "
+           "\"max_us\": %.3f, \"mean_us\": %.3f, \"dev_us\": %.3f}",
+           first ? "" : ",",
+           stimer_backend_str(backend), interval_us, rt ? "true" : "false",
+           (unsigned long long) s->count,
+           (double) s->min * 1e-3,
+           (double) sstat_percentile(s, 50.)  * 1e-3,
+           (double) sstat_percentile(s, 90.)  * 1e-3,
+           (double) sstat_percentile(s, 99.)  * 1e-3,
+           (double) sstat_percentile(s, 99.9) * 1e-3,
+           (double) s->max * 1e-3,
+           sstat_mean(s) * 1e-3, sstat_dev(s) * 1e-3);
+  }
+  else
+  {
+    printf("%-8s %11g %3s ", stimer_backend_str(backend), interval_us,
+           rt ? "yes" : "no");
+    sstat_fprint(stdout, s, 1e-3);
+    printf("\n");
+  }
+  fflush(stdout);
+}
+//-----------------------------------------------------------------------------
+int main(int argc, const char *argv[])
+{
+  options_t o;
+  static bench_t b; // big histogram, not on stack
+  struct sched_param schp;
+  int i, j, rt, first = 1;
+
+  bench_parse_options(argc, argv, &o);
+  b.min_samples = o.min_samples;
+
+  if (o.json)
+    printf("[");
+  else
+    printf("backend  interval_us  rt    samples     min_us     p50_us"
+           "     p90_us     p99_us    p999_us     max_us    mean_us"
+           "     dev_us\n");
+
+  for (rt = 0; rt <= 1; rt++)
+  {
+    if ((rt == 0 && !o.rt_off) || (rt == 1 && !o.rt_on))
+      continue;
+
+    // switch scheduling policy
+    memset(&schp, 0, sizeof(schp));
+    if (rt)
+    {
+      if (stimer_realtime() != 0)
+      {
+        fprintf(stderr, "warning: skip real time runs (root required)\n");
+        continue;
+      }
+    }
+    else
+      sched_setscheduler(0, SCHED_OTHER, &schp);
+
+    for (i = 0; i < o.backends_num; i++)
+    {
+      for (j = 0; j < o.intervals_num; j++)
+      {
+        if (bench_run(&b, o.backends[i], o.intervals[j], o.duration) != 0)
+        {
+          fprintf(stderr, "error: %s backend fail; skip\n",
+                  stimer_backend_str(o.backends[i]));
+          continue;
+        }
+        bench_print(&o, &b, o.backends[i], o.intervals[j], rt, first);
+        first = 0;
+      }
+    }
+  }
+
+  if (o.json)
+    printf("\n]\n");
+
+  return EXIT_SUCCESS;
+}
+//-----------------------------------------------------------------------------
+
+/*** end of "bench_stimer.c" ***/
@@ -0,0 +1,228 @@
+/*
+ * Simple tick broadcast: sequence counter and timestamps in shared memory,
+ * waiters are woken by futex (one syscall per tick on publisher side)
+ * File: "sbcast.c"
+ */
+//-----------------------------------------------------------------------------
+#include "sbcast.h"       // `sbcast_t`
+#include <unistd.h>       // ftruncate(), close(), syscall()
+#include <fcntl.h>        // O_CREAT, O_RDWR
+#include <errno.h>        // errno, EAGAIN, EINTR, ETIMEDOUT
+#include <time.h>         // clock_gettime()
+#include <sys/mman.h>     // shm_open(), shm_unlink(), mmap(), munmap()
+#include <sys/syscall.h>  // SYS_futex
+#include <linux/futex.h>  // FUTEX_WAIT, FUTEX_WAKE
+//-----------------------------------------------------------------------------
+// futex() syscall (no glibc wrapper)
+static int sbcast_futex(sbcast_t *self, int op, uint32_t val,
+                        const struct timespec *timeout)
+{
+  if (self->private_) op |= FUTEX_PRIVATE_FLAG;
+  return (int) syscall(SYS_futex, &self->page->seq, op, val, timeout,
+                       NULL, 0);
+}
+//-----------------------------------------------------------------------------
+// open broadcast page "/NAME" (NULL - process private page for publisher);
+// publisher creates page, client attaches to existing one
+// (return SBCAST_ERR_*)
+int sbcast_open(sbcast_t *self, const char *name, int publisher)
+{
+  void *page;
+  int fd;
+
+  self->page      = (sbcast_page_t*) NULL;
+  self->name      = name;
+  self->publisher = publisher;
+  self->private_  = name == (const char*) NULL;
+  self->seq       = 0;
+  self->count     = 0;
+
+  if (self->private_)
+  {
+    if (!publisher) return SBCAST_ERR_OPEN; // use sbcast_attach()
+    page = mmap(NULL, sizeof(sbcast_page_t), PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  }
+  else
+  {
+    fd = shm_open(name, publisher ? O_CREAT | O_RDWR : O_RDWR, SBCAST_MODE);
+    if (fd < 0) return SBCAST_ERR_OPEN;
+
+    if (publisher && ftruncate(fd, sizeof(sbcast_page_t)) < 0)
+    {
+      close(fd);
+      return SBCAST_ERR_OPEN;
+    }
+
+    page = mmap(NULL, sizeof(sbcast_page_t), PROT_READ | PROT_WRITE,
+                MAP_SHARED, fd, 0);
+    close(fd);
+  }
+  if (page == MAP_FAILED) return SBCAST_ERR_MAP;
+  self->page = (sbcast_page_t*) page;
+
+  if (publisher)
+  { // new page (sequence goes on if page left by previous publisher)
+    self->page->closed  = 0;
+    self->page->lock    = 0;
+    self->page->waiters = 0;
+    __atomic_store_n(&self->page->magic, SBCAST_MAGIC, __ATOMIC_RELEASE);
+  }
+  else if (__atomic_load_n(&self->page->magic, __ATOMIC_ACQUIRE) !=
+           SBCAST_MAGIC)
+  {
+    munmap(page, sizeof(sbcast_page_t));
+    self->page = (sbcast_page_t*) NULL;
+    return SBCAST_ERR_MAGIC;
+  }
+  else
+  { // next sbcast_wait() returns next tick
+    self->seq   = __atomic_load_n(&self->page->seq, __ATOMIC_ACQUIRE);
+    self->count = self->page->count;
+  }
+
+  return SBCAST_ERR_NONE;
+}
+//-----------------------------------------------------------------------------
+// attach client to publisher of the same process (e.g. private page)
+void sbcast_attach(sbcast_t *self, const sbcast_t *publisher)
+{
+  self->page      = publisher->page;
+  self->name      = (const char*) NULL; // don't unmap by sbcast_close()
+  self->publisher = 0;
+  self->private_  = publisher->private_;
+  self->seq       = __atomic_load_n(&self->page->seq, __ATOMIC_ACQUIRE);
+  self->count     = self->page->count;
+}
+//-----------------------------------------------------------------------------
+// publish tick and wake waiting clients (return SBCAST_ERR_*)
+int sbcast_publish(sbcast_t *self, int64_t deadline_ns, int64_t time_ns)
+{
+  sbcast_page_t *pg = self->page;
+
+  // tick data under seqlock
+  __atomic_store_n(&pg->lock, pg->lock + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  pg->count++;
+  pg->deadline_ns = deadline_ns;
+  pg->time_ns     = time_ns;
+  __atomic_store_n(&pg->lock, pg->lock + 1, __ATOMIC_RELEASE);
+
+  // new sequence, then wake (client increments `waiters` before wait)
+  __atomic_add_fetch(&pg->seq, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&pg->waiters, __ATOMIC_SEQ_CST) == 0)
+    return SBCAST_ERR_NONE;
+
+  if (sbcast_futex(self, FUTEX_WAKE, INT32_MAX, NULL) < 0)
+    return SBCAST_ERR_FUTEX;
+
+  return SBCAST_ERR_NONE;
+}
+//-----------------------------------------------------------------------------
+// wait next tick (msec < 0 - forever), missed ticks are counted
+// (return SBCAST_ERR_*)
+int sbcast_wait(sbcast_t *self, sbcast_tick_t *tick, int msec)
+{
+  sbcast_page_t *pg = self->page;
+  struct timespec end, now, ts, *timeout = (struct timespec*) NULL;
+  uint32_t seq, lock;
+  int retv;
+
+  if (msec >= 0)
+  {
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    end.tv_sec  += msec / 1000;
+    end.tv_nsec += (msec % 1000) * 1000000;
+    if (end.tv_nsec >= 1000000000)
+    {
+      end.tv_sec++;
+      end.tv_nsec -= 1000000000;
+    }
+    timeout = &ts;
+  }
+
+  while ((seq = __atomic_load_n(&pg->seq, __ATOMIC_ACQUIRE)) == self->seq)
+  {
+    if (__atomic_load_n(&pg->closed, __ATOMIC_ACQUIRE))
+      return SBCAST_ERR_CLOSED;
+
+    if (timeout)
+    { // FUTEX_WAIT timeout is relative
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      ts.tv_sec  = end.tv_sec  - now.tv_sec;
+      ts.tv_nsec = end.tv_nsec - now.tv_nsec;
+      if (ts.tv_nsec < 0)
+      {
+        ts.tv_sec--;
+        ts.tv_nsec += 1000000000;
+      }
+      if (ts.tv_sec < 0) return SBCAST_ERR_TIMEOUT;
+    }
+
+    __atomic_add_fetch(&pg->waiters, 1, __ATOMIC_SEQ_CST);
+    retv = sbcast_futex(self, FUTEX_WAIT, seq, timeout);
+    __atomic_sub_fetch(&pg->waiters, 1, __ATOMIC_SEQ_CST);
+
+    if (retv < 0)
+    {
+      if (errno == ETIMEDOUT) return SBCAST_ERR_TIMEOUT;
+      if (errno == EINTR)     return SBCAST_ERR_INTR;
+      if (errno != EAGAIN)    return SBCAST_ERR_FUTEX;
+    }
+  }
+
+  if (__atomic_load_n(&pg->closed, __ATOMIC_ACQUIRE))
+    return SBCAST_ERR_CLOSED;
+
+  // read tick data (retry if publisher writes it now)
+  do
+  {
+    lock = __atomic_load_n(&pg->lock, __ATOMIC_ACQUIRE);
+    tick->count       = pg->count;
+    tick->deadline_ns = pg->deadline_ns;
+    tick->time_ns     = pg->time_ns;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  } while ((lock & 1) || lock != __atomic_load_n(&pg->lock, __ATOMIC_RELAXED));
+
+  tick->missed = tick->count - self->count - 1;
+  self->seq    = seq;
+  self->count  = tick->count;
+  return SBCAST_ERR_NONE;
+}
+//-----------------------------------------------------------------------------
+// close page (publisher wakes all clients with SBCAST_ERR_CLOSED
+// and removes page name)
+void sbcast_close(sbcast_t *self)
+{
+  if (self->page == (sbcast_page_t*) NULL) return;
+
+  if (self->publisher)
+  {
+    __atomic_store_n(&self->page->closed, 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&self->page->seq, 1, __ATOMIC_SEQ_CST);
+    sbcast_futex(self, FUTEX_WAKE, INT32_MAX, NULL);
+    if (!self->private_) shm_unlink(self->name);
+  }
+
+  if (self->publisher || self->name)
+    munmap((void*) self->page, sizeof(sbcast_page_t));
+  self->page = (sbcast_page_t*) NULL;
+}
+//-----------------------------------------------------------------------------
+// error string
+const char *sbcast_error_str(int err)
+{
+  static const char *errors[] = {
+    "success",
+    "can't open shared memory",
+    "can't map shared memory",
+    "not a tick broadcast page",
+    "timeout",
+    "interrupted by signal",
+    "publisher closed",
+    "futex() failed"
+  };
+  return (err <= 0 && err > -8) ? errors[-err] : "unknown error";
+}
+//-----------------------------------------------------------------------------
+/*** end of "sbcast.c" file ***/
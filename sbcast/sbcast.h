@@ -0,0 +1,110 @@
+/*
+ * Simple tick broadcast: sequence counter and timestamps in shared memory,
+ * waiters are woken by futex (one syscall per tick on publisher side)
+ * File: "sbcast.h"
+ */
+
+#ifndef SBCAST_H
+#define SBCAST_H
+//-----------------------------------------------------------------------------
+#include <stdint.h> // `int64_t`, `uint64_t`, `uint32_t`
+//-----------------------------------------------------------------------------
+// Publisher (e.g. `tick -B /tick`):
+//   sbcast_t b;
+//   sbcast_open(&b, "/tick", 1);
+//   for (;;) { ...; sbcast_publish(&b, deadline_ns, time_ns); }
+//   sbcast_close(&b);
+//
+// Client (other process, link sbcast.c only):
+//   sbcast_t b;
+//   sbcast_tick_t t;
+//   sbcast_open(&b, "/tick", 0);
+//   while (sbcast_wait(&b, &t, 1000) == SBCAST_ERR_NONE)
+//     printf("%llu %lld\n", t.count, t.deadline_ns);
+//   sbcast_close(&b);
+//
+// Name NULL - process private page for threads of one process
+// (then first sbcast_open(.., 1) makes page, clients use sbcast_attach()).
+//-----------------------------------------------------------------------------
+// shared page magic ("TICK")
+#define SBCAST_MAGIC 0x4B434954
+
+// shared page access mode (publisher and clients of one group)
+#define SBCAST_MODE 0660
+
+// error codes
+#define SBCAST_ERR_NONE     0 // no error
+#define SBCAST_ERR_OPEN    -1 // can't open/create shared memory
+#define SBCAST_ERR_MAP     -2 // can't map shared memory
+#define SBCAST_ERR_MAGIC   -3 // not a tick broadcast page
+#define SBCAST_ERR_TIMEOUT -4 // no tick in time
+#define SBCAST_ERR_INTR    -5 // interrupted by signal
+#define SBCAST_ERR_CLOSED  -6 // publisher closed
+#define SBCAST_ERR_FUTEX   -7 // futex() failed
+//-----------------------------------------------------------------------------
+// shared page (written by publisher only, except `waiters`)
+typedef struct sbcast_page_ {
+  uint32_t magic;       // SBCAST_MAGIC
+  uint32_t seq;         // futex word: incremented every tick
+  uint32_t waiters;     // number of sleeping clients (no FUTEX_WAKE if 0)
+  uint32_t lock;        // seqlock of tick data (odd while writing)
+  uint32_t closed;      // 1 after sbcast_close() of publisher
+  uint32_t reserved;
+  uint64_t count;       // tick counter
+  int64_t  deadline_ns; // scheduled tick time (CLOCK_REALTIME)
+  int64_t  time_ns;     // publish time (CLOCK_REALTIME)
+} sbcast_page_t;
+//-----------------------------------------------------------------------------
+// tick received by client
+typedef struct sbcast_tick_ {
+  uint64_t count;       // tick counter
+  int64_t  deadline_ns; // scheduled tick time (CLOCK_REALTIME)
+  int64_t  time_ns;     // publish time (CLOCK_REALTIME)
+  uint64_t missed;      // ticks missed since previous sbcast_wait()
+} sbcast_tick_t;
+//-----------------------------------------------------------------------------
+// `sbcast_t` type structure (publisher or client handle)
+typedef struct sbcast_ {
+  sbcast_page_t *page; // mapped page
+  const char *name;    // shared memory name (or NULL)
+  int publisher;       // 1 if publisher
+  int private_;        // 1 if process private page (FUTEX_*_PRIVATE)
+  uint32_t seq;        // last seen `seq` (client)
+  uint64_t count;      // last seen `count` (client)
+} sbcast_t;
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+// open broadcast page "/NAME" (NULL - process private page for publisher);
+// publisher creates page, client attaches to existing one
+// (return SBCAST_ERR_*)
+int sbcast_open(sbcast_t *self, const char *name, int publisher);
+//-----------------------------------------------------------------------------
+// attach client to publisher of the same process (e.g. private page)
+void sbcast_attach(sbcast_t *self, const sbcast_t *publisher);
+//-----------------------------------------------------------------------------
+// publish tick and wake waiting clients (return SBCAST_ERR_*)
+int sbcast_publish(sbcast_t *self, int64_t deadline_ns, int64_t time_ns);
+//-----------------------------------------------------------------------------
+// wait next tick (msec < 0 - forever), missed ticks are counted
+// (return SBCAST_ERR_*)
+int sbcast_wait(sbcast_t *self, sbcast_tick_t *tick, int msec);
+//-----------------------------------------------------------------------------
+// close page (publisher wakes all clients with SBCAST_ERR_CLOSED
+// and removes page name)
+void sbcast_close(sbcast_t *self);
+//-----------------------------------------------------------------------------
+// error string
+const char *sbcast_error_str(int err);
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+#endif // SBCAST_H
+
+/*** end of "sbcast.h" file ***/
+
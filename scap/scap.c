@@ -0,0 +1,258 @@
+/*
+ * Simple logic analyzer capture: timer loop pushes samples (bitmask of
+ * input pins, one word per sample) to lock-free ring buffer, background
+ * thread drains ring to run-length encoded file (binary RLE or VCD)
+ * File: "scap.c"
+ */
+//-----------------------------------------------------------------------------
+#include "scap.h"   // `scap_t`
+#include <stdlib.h> // malloc(), free()
+#include <string.h> // memset(), memcpy(), strlen(), strcmp()
+#include <time.h>   // nanosleep()
+//-----------------------------------------------------------------------------
+// time of sample `i` since first sample [ns]
+static int64_t scap_time(const scap_t *self, uint64_t i)
+{
+  return (int64_t) ((double) i * self->hdr.period_ns + 0.5);
+}
+//-----------------------------------------------------------------------------
+// write VCD header and initial levels
+static void scap_vcd_begin(scap_t *self, uint32_t mask)
+{
+  unsigned i;
+
+  fprintf(self->file, "$version scap logic capture $end\n"
+                      "$timescale 1ns $end\n"
+                      "$scope module gpio $end\n");
+  for (i = 0; i < self->hdr.pins; i++)
+    fprintf(self->file, "$var wire 1 %c gpio%d $end\n",
+            '!' + i, (int) self->hdr.nums[i]);
+  fprintf(self->file, "$upscope $end\n"
+                      "$enddefinitions $end\n"
+                      "#0\n"
+                      "$dumpvars\n");
+  for (i = 0; i < self->hdr.pins; i++)
+    fprintf(self->file, "%u%c\n", (mask >> i) & 1, '!' + i);
+  fprintf(self->file, "$end\n");
+}
+//-----------------------------------------------------------------------------
+// write finished run (RLE record or VCD value change to `mask`)
+static void scap_run(scap_t *self, uint32_t mask)
+{
+  uint32_t rec[2], changed;
+  unsigned i;
+
+  if (self->vcd)
+  {
+    changed = mask ^ self->run_mask;
+    if (!changed) return; // run is longer than 2^32 samples
+    fprintf(self->file, "#%lld\n", (long long) scap_time(self, self->samples));
+    for (; changed; changed &= changed - 1)
+    {
+      i = __builtin_ctz(changed);
+      fprintf(self->file, "%u%c\n", (mask >> i) & 1, '!' + i);
+    }
+  }
+  else
+  {
+    rec[0] = self->run_mask;
+    rec[1] = self->run;
+    if (fwrite(rec, sizeof(rec), 1, self->file) != 1 &&
+        self->err == SCAP_ERR_NONE)
+      self->err = SCAP_ERR_WRITE;
+  }
+  self->runs++;
+}
+//-----------------------------------------------------------------------------
+// extend run of last levels by `n` lost samples (time line stays right)
+static void scap_skip(scap_t *self, uint64_t n)
+{
+  uint64_t m;
+
+  if (self->vcd)
+    fprintf(self->file, "$comment lost %llu samples at %lld ns $end\n",
+            (unsigned long long) n,
+            (long long) scap_time(self, self->samples));
+
+  while (n)
+  {
+    if (self->run == UINT32_MAX)
+    {
+      scap_run(self, self->run_mask);
+      self->run = 0;
+    }
+    m = UINT32_MAX - self->run;
+    if (m > n) m = n;
+    self->run     += (uint32_t) m;
+    self->samples += m;
+    n -= m;
+  }
+}
+//-----------------------------------------------------------------------------
+// drain ring to file (consumer)
+static void scap_drain(scap_t *self)
+{
+  uint64_t head = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE);
+  uint64_t tail = self->tail;
+  uint32_t m;
+
+  for (; tail != head; tail++)
+  {
+    m = self->ring[tail & self->mask];
+
+    if (m & SCAP_GAP)
+    { // lost samples: run of last levels goes on
+      scap_skip(self, m & SCAP_LEVELS);
+      continue;
+    }
+
+    if (self->samples == 0)
+    { // first sample
+      if (self->vcd) scap_vcd_begin(self, m);
+      self->run_mask = m;
+      self->run      = 0;
+    }
+    else if (m != self->run_mask || self->run == UINT32_MAX)
+    {
+      scap_run(self, m);
+      self->run_mask = m;
+      self->run      = 0;
+    }
+    self->run++;
+    self->samples++;
+  }
+
+  __atomic_store_n(&self->tail, tail, __ATOMIC_RELEASE);
+}
+//-----------------------------------------------------------------------------
+// drain thread
+static void *scap_thread(void *context)
+{
+  scap_t *self = (scap_t*) context;
+  struct timespec ts;
+
+  ts.tv_sec  = SCAP_DRAIN_MS / 1000;
+  ts.tv_nsec = (SCAP_DRAIN_MS % 1000) * 1000000;
+
+  while (!self->stop)
+  {
+    scap_drain(self);
+    nanosleep(&ts, NULL);
+  }
+
+  return NULL;
+}
+//-----------------------------------------------------------------------------
+// init capture before timer start: clear ring of `size` samples (rounded
+// up to power of 2), `pins` (up to 31) GPIO numbers `nums`; output file
+// is VCD if its name ends with ".vcd", else binary RLE
+// (return SCAP_ERR_*)
+int scap_init(scap_t *self, const char *fname, unsigned size,
+              int pins, const int *nums)
+{
+  unsigned n = 1;
+  size_t len = strlen(fname);
+  int i;
+
+  memset((void*) self, 0, sizeof(scap_t));
+  if (pins > SCAP_PINS_MAX - 1) pins = SCAP_PINS_MAX - 1; // SCAP_GAP bit
+
+  while (n < size && n < 0x80000000U) n <<= 1;
+  self->ring = (uint32_t*) malloc(sizeof(uint32_t) * n);
+  if (self->ring == (uint32_t*) NULL)
+    return SCAP_ERR_ALLOC;
+  memset((void*) self->ring, 0, sizeof(uint32_t) * n); // touch pages now
+  self->mask = n - 1;
+
+  memcpy(self->hdr.magic, SCAP_MAGIC, sizeof(self->hdr.magic));
+  self->hdr.pins      = (uint32_t) pins;
+  for (i = 0; i < pins; i++)
+    self->hdr.nums[i] = nums[i];
+
+  self->vcd  = len > 4 && !strcmp(fname + len - 4, ".vcd");
+  self->file = fopen(fname, self->vcd ? "w" : "wb");
+  if (self->file == (FILE*) NULL)
+  {
+    scap_free(self);
+    return SCAP_ERR_OPEN;
+  }
+
+  return SCAP_ERR_NONE;
+}
+//-----------------------------------------------------------------------------
+// write file header with time of first sample `t0_ns` and sample period
+// `period_ns` (timer is started), start drain thread (return SCAP_ERR_*)
+int scap_start(scap_t *self, int64_t t0_ns, double period_ns)
+{
+  self->hdr.t0_ns     = t0_ns;
+  self->hdr.period_ns = period_ns;
+  if (!self->vcd &&
+      fwrite(&self->hdr, sizeof(scap_header_t), 1, self->file) != 1)
+    return SCAP_ERR_WRITE;
+
+  self->stop = 0;
+  if (pthread_create(&self->thread, NULL, scap_thread, (void*) self) != 0)
+    return SCAP_ERR_THREAD;
+  self->started = 1;
+  return SCAP_ERR_NONE;
+}
+//-----------------------------------------------------------------------------
+// stop drain thread, drain rest of ring and close file
+// (return SCAP_ERR_* of first write error)
+int scap_stop(scap_t *self)
+{
+  if (self->started)
+  {
+    self->stop = 1;
+    pthread_join(self->thread, NULL);
+    self->started = 0;
+  }
+
+  if (self->file == (FILE*) NULL)
+    return self->err;
+
+  scap_drain(self);
+
+  // samples lost at the end (producer is stopped, marker never came)
+  if (self->gap && self->samples)
+    scap_skip(self, self->gap);
+  self->gap = 0;
+
+  // last run (VCD: end time)
+  if (self->samples)
+  {
+    if (self->vcd)
+      fprintf(self->file, "#%lld\n",
+              (long long) scap_time(self, self->samples));
+    else
+      scap_run(self, self->run_mask);
+  }
+
+  if (fclose(self->file) != 0 && self->err == SCAP_ERR_NONE)
+    self->err = SCAP_ERR_WRITE;
+  self->file = (FILE*) NULL;
+
+  return self->err;
+}
+//-----------------------------------------------------------------------------
+// free ring buffer
+void scap_free(scap_t *self)
+{
+  free((void*) self->ring);
+  self->ring = (uint32_t*) NULL;
+}
+//-----------------------------------------------------------------------------
+// error string
+const char *scap_error_str(int err)
+{
+  static const char *errors[] = {
+    "success",
+    "can't allocate ring buffer",
+    "can't open output file",
+    "can't create drain thread",
+    "can't write output file"
+  };
+  return (err <= 0 && err > -5) ? errors[-err] : "unknown error";
+}
+//-----------------------------------------------------------------------------
+/*** end of "scap.c" file ***/
@@ -0,0 +1,143 @@
+/*
+ * Simple logic analyzer capture: timer loop pushes samples (bitmask of
+ * input pins, one word per sample) to lock-free ring buffer, background
+ * thread drains ring to run-length encoded file (binary RLE or VCD)
+ * File: "scap.h"
+ */
+
+#ifndef SCAP_H
+#define SCAP_H
+//-----------------------------------------------------------------------------
+#include <stdint.h>  // `uint32_t`, `uint64_t`, `int64_t`
+#include <stdio.h>   // `FILE`
+#include <pthread.h> // `pthread_t`
+//-----------------------------------------------------------------------------
+// RLE file (native byte order):
+//   scap_header_t, then records {uint32_t mask, uint32_t run}
+//   (`run` samples with levels `mask`, bit i - i-th pin)
+// VCD file (name "*.vcd"): value changes with timescale 1 ns
+// Samples lost on full ring extend the run of last levels (sample time
+// is implicit, so time line stays right), VCD gets a comment at the gap
+//-----------------------------------------------------------------------------
+// max number of pins in file header
+#define SCAP_PINS_MAX 32
+
+// ring word with this bit is gap marker (lost samples in low bits),
+// so up to 31 pins are sampled
+#define SCAP_GAP    0x80000000U
+#define SCAP_LEVELS 0x7FFFFFFFU
+
+// default ring size (samples, power of 2)
+#define SCAP_RING_SIZE 65536
+
+// drain period of background thread [ms]
+#define SCAP_DRAIN_MS 10
+
+// RLE file magic
+#define SCAP_MAGIC "SCAP"
+
+// inline macro (platform depended)
+#ifndef   SCAP_INLINE
+#  define SCAP_INLINE static inline
+#endif // SCAP_INLINE
+
+// error codes
+#define SCAP_ERR_NONE    0 // no error
+#define SCAP_ERR_ALLOC  -1 // can't allocate ring buffer
+#define SCAP_ERR_OPEN   -2 // can't open output file
+#define SCAP_ERR_THREAD -3 // can't create drain thread
+#define SCAP_ERR_WRITE  -4 // can't write output file
+//-----------------------------------------------------------------------------
+// RLE file header
+typedef struct scap_header_ {
+  char     magic[4];   // SCAP_MAGIC
+  uint32_t pins;       // number of pins
+  int64_t  t0_ns;      // time of first sample [ns] (CLOCK_REALTIME)
+  double   period_ns;  // sample period [ns]
+  int32_t  nums[SCAP_PINS_MAX]; // GPIO numbers
+} scap_header_t;
+//-----------------------------------------------------------------------------
+// `scap_t` type structure
+typedef struct scap_ {
+  uint32_t *ring;        // samples
+  uint32_t mask;         // ring size - 1
+  uint64_t head;         // written by timer loop (producer)
+  uint64_t tail;         // written by drain thread (consumer)
+  uint64_t lost;         // samples lost if ring is full (producer)
+  uint64_t gap;          // lost samples without marker yet (producer)
+  volatile int stop;
+  int err;               // first write error (SCAP_ERR_*)
+  pthread_t thread;
+  int started;
+  FILE *file;
+  int vcd;               // 1 if VCD output
+  scap_header_t hdr;
+  uint32_t run_mask;     // current run (drain thread)
+  uint32_t run;
+  uint64_t samples;      // drained samples
+  uint64_t runs;         // written records (value changes for VCD)
+} scap_t;
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+// init capture before timer start: clear ring of `size` samples (rounded
+// up to power of 2), `pins` (up to 31) GPIO numbers `nums`; output file
+// is VCD if its name ends with ".vcd", else binary RLE
+// (return SCAP_ERR_*)
+int scap_init(scap_t *self, const char *fname, unsigned size,
+              int pins, const int *nums);
+//-----------------------------------------------------------------------------
+// push `n` samples with levels `mask` (wait-free, one producer)
+SCAP_INLINE void scap_push(scap_t *self, uint32_t mask, unsigned n)
+{
+  uint64_t head = self->head;
+  uint64_t tail = __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE);
+  uint32_t g;
+
+  mask &= SCAP_LEVELS;
+  while (n)
+  {
+    if (head - tail > self->mask)
+    { // full: drop samples, drain thread is late (marker goes later)
+      self->lost += n;
+      self->gap  += n;
+      break;
+    }
+    if (self->gap)
+    { // marker of lost samples before next sample
+      g = self->gap > SCAP_LEVELS ? SCAP_LEVELS : (uint32_t) self->gap;
+      self->ring[head++ & self->mask] = SCAP_GAP | g;
+      self->gap -= g;
+      continue;
+    }
+    self->ring[head++ & self->mask] = mask;
+    n--;
+  }
+  __atomic_store_n(&self->head, head, __ATOMIC_RELEASE);
+}
+//-----------------------------------------------------------------------------
+// write file header with time of first sample `t0_ns` and sample period
+// `period_ns` (timer is started), start drain thread (return SCAP_ERR_*)
+int scap_start(scap_t *self, int64_t t0_ns, double period_ns);
+//-----------------------------------------------------------------------------
+// stop drain thread, drain rest of ring and close file
+// (return SCAP_ERR_* of first write error)
+int scap_stop(scap_t *self);
+//-----------------------------------------------------------------------------
+// free ring buffer
+void scap_free(scap_t *self);
+//-----------------------------------------------------------------------------
+// error string
+const char *scap_error_str(int err);
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+#endif // SCAP_H
+
+/*** end of "scap.h" file ***/
+
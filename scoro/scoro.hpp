@@ -0,0 +1,580 @@
+/*
+ * Coroutines over stimer/sgpio (C++20 header only layer): timed GPIO
+ * sequences are written linearly instead of hand-built state machines
+ * File: "scoro.hpp"
+ */
+
+#ifndef SCORO_HPP
+#define SCORO_HPP
+//-----------------------------------------------------------------------------
+#include "stimer.h"
+#include "sgpio.h"
+#include <coroutine>   // std::coroutine_handle, std::suspend_always
+#include <cstddef>     // std::size_t, std::max_align_t
+#include <cstdint>     // int64_t
+#include <cstdlib>     // std::malloc(), std::free()
+#include <exception>   // std::terminate()
+#include <cerrno>      // errno, EINTR
+#include <sys/epoll.h> // epoll_create1(), epoll_ctl(), epoll_wait()
+#include <unistd.h>    // close()
+//-----------------------------------------------------------------------------
+// default number of preallocated coroutine frames
+#ifndef SCORO_FRAMES
+#  define SCORO_FRAMES 32
+#endif // SCORO_FRAMES
+
+// default size of one coroutine frame [bytes]
+#ifndef SCORO_FRAME_SIZE
+#  define SCORO_FRAME_SIZE 512
+#endif // SCORO_FRAME_SIZE
+
+// max number of input pins waited by Executor::edge()
+#ifndef SCORO_PINS_MAX
+#  define SCORO_PINS_MAX 16
+#endif // SCORO_PINS_MAX
+//-----------------------------------------------------------------------------
+namespace scoro {
+//-----------------------------------------------------------------------------
+class Executor;
+//-----------------------------------------------------------------------------
+// preallocated coroutine frames: fixed size slots and free list (frames
+// are taken and returned without malloc() and locks, one thread only)
+class Pool {
+public:
+  Pool(int frames, std::size_t size) :
+    size_(size), stride_(hdr + (size + hdr - 1) / hdr * hdr)
+  {
+    base_ = (char*) std::malloc(stride_ * frames);
+    free_ = (int*)  std::malloc(sizeof(int) * frames);
+    if (base_ == nullptr || free_ == nullptr) return;
+    for (int i = 0; i < frames; i++)
+      free_[i] = frames - 1 - i;
+    frames_ = top_ = frames;
+  }
+
+  ~Pool() { std::free(base_); std::free(free_); }
+
+  Pool(const Pool&)            = delete;
+  Pool& operator=(const Pool&) = delete;
+
+  // frame of `n` bytes (nullptr if too big or no free slot)
+  void *alloc(std::size_t n) noexcept
+  {
+    if (n > size_ || top_ == 0)
+    {
+      fails_++;
+      return nullptr;
+    }
+    char *slot = base_ + stride_ * free_[--top_];
+    *(Pool**) slot = this;
+    if (frames_ - top_ > peak_) peak_ = frames_ - top_;
+    return slot + hdr;
+  }
+
+  // return frame to its pool
+  static void release(void *frame) noexcept
+  {
+    char *slot = (char*) frame - hdr;
+    Pool *self = *(Pool**) slot;
+    self->free_[self->top_++] = (int) ((slot - self->base_) / self->stride_);
+  }
+
+  int frames() const { return frames_; }           // number of slots
+  int used()   const { return frames_ - top_; }    // frames in use
+  int peak()   const { return peak_; }             // max frames in use
+  unsigned fails() const { return fails_; }        // failed allocations
+  std::size_t size() const { return size_; }       // max frame size
+
+private:
+  // slot header (owner pool) keeps frame aligned as operator new does
+  static constexpr std::size_t hdr = alignof(std::max_align_t);
+
+  std::size_t size_, stride_;
+  char *base_ = nullptr;
+  int  *free_ = nullptr;
+  int frames_ = 0, top_ = 0, peak_ = 0;
+  unsigned fails_ = 0;
+};
+//-----------------------------------------------------------------------------
+// coroutine task: first parameter of coroutine is `Executor&` (or second
+// one of member coroutine), its frame is taken from executor pool; task
+// starts by Executor::spawn() or by `co_await` from other task (then it
+// resumes awaiting task at the end); task without frame (pool is
+// exhausted) is false and ends at once
+class Task {
+public:
+  struct promise_type;
+  using handle_type = std::coroutine_handle<promise_type>;
+
+  struct promise_type {
+    std::coroutine_handle<> cont; // awaiting task (none if spawned)
+    Executor *ex = nullptr;       // owner executor of spawned task
+
+    template <class... A>
+    static void *operator new(std::size_t n, Executor &ex, A&...) noexcept;
+
+    template <class T, class... A>
+    static void *operator new(std::size_t n, T&, Executor &ex, A&...) noexcept;
+
+    // coroutine without `Executor&` parameter would use heap: forbidden
+    static void *operator new(std::size_t n) = delete;
+
+    static void operator delete(void *frame) noexcept
+    {
+      Pool::release(frame);
+    }
+
+    static Task get_return_object_on_allocation_failure() noexcept
+    {
+      return Task();
+    }
+
+    Task get_return_object() noexcept
+    {
+      return Task(handle_type::from_promise(*this));
+    }
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    // resume awaiting task (symmetric transfer, no stack growth) or
+    // free frame of spawned one
+    struct Final {
+      bool await_ready() noexcept { return false; }
+      std::coroutine_handle<> await_suspend(handle_type h) noexcept;
+      void await_resume() noexcept {}
+    };
+    Final final_suspend() noexcept { return {}; }
+
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+
+  Task() = default;
+  Task(Task &&t) noexcept : h_(t.h_) { t.h_ = nullptr; }
+  Task& operator=(Task &&t) noexcept
+  {
+    if (this != &t)
+    {
+      if (h_) h_.destroy();
+      h_ = t.h_;
+      t.h_ = nullptr;
+    }
+    return *this;
+  }
+  ~Task() { if (h_) h_.destroy(); }
+
+  // false if frame was not allocated
+  explicit operator bool() const { return (bool) h_; }
+
+  // underlying coroutine (resume() it by hand without executor)
+  handle_type handle() const { return h_; }
+
+  // take ownership of coroutine (Executor::spawn())
+  handle_type release() { handle_type h = h_; h_ = nullptr; return h; }
+
+  // run task to its end from other task
+  auto operator co_await() const noexcept
+  {
+    struct Awaiter {
+      handle_type h;
+      bool await_ready() noexcept { return !h || h.done(); }
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<> c) noexcept
+      {
+        h.promise().cont = c;
+        return h;
+      }
+      void await_resume() noexcept {}
+    };
+    return Awaiter{h_};
+  }
+
+private:
+  explicit Task(handle_type h) : h_(h) {}
+  handle_type h_ = nullptr;
+};
+//-----------------------------------------------------------------------------
+// single thread executor: one stimer (timerfd backend, woken by its fd)
+// and persistent epoll sets of input pins; waiting tasks are kept in
+// preallocated arrays, timer is re-armed to the earliest wait,
+// so resume costs no allocation and no extra syscall on plain ticks;
+// real time priority is set by caller (stimer_realtime()) before run()
+class Executor {
+public:
+  explicit Executor(int frames = SCORO_FRAMES,
+                    std::size_t frame_size = SCORO_FRAME_SIZE) :
+    pool_(frames, frame_size)
+  {
+    sleeps_ = (Sleep*) std::malloc(sizeof(Sleep) * frames);
+    roots_  = (std::coroutine_handle<>*)
+              std::malloc(sizeof(std::coroutine_handle<>) * frames);
+    if (sleeps_ == nullptr || roots_ == nullptr || pool_.frames() == 0)
+      return;
+    capacity_ = frames;
+    for (int i = 0; i < SCORO_PINS_MAX; i++)
+      pins_[i] = Pin{nullptr, nullptr};
+
+    if (stimer_init_ex(&timer_, STIMER_BACKEND_TIMERFD, &Executor::call,
+                       (void*) this) != 0)
+      return;
+    err_ = 0;
+  }
+
+  ~Executor()
+  {
+    // destroy suspended spawned tasks (and tasks they await)
+    for (int i = 0; i < roots_num_; i++)
+      roots_[i].destroy();
+    if (err_ == 0) stimer_free(&timer_);
+    if (epfd_ >= 0) ::close(epfd_);
+    std::free(sleeps_);
+    std::free(roots_);
+  }
+
+  Executor(const Executor&)            = delete;
+  Executor& operator=(const Executor&) = delete;
+
+  // 0 or -1 on construction error
+  int error() const { return err_; }
+  explicit operator bool() const { return err_ == 0; }
+
+  // frame pool of tasks
+  Pool&       pool()       { return pool_; }
+  const Pool& pool() const { return pool_; }
+
+  // start task (it runs till first wait), frame is freed at its end
+  // (return false if task has no frame or too many tasks)
+  bool spawn(Task &&task)
+  {
+    if (!task || roots_num_ >= capacity_) return false;
+    Task::handle_type h = task.release();
+    h.promise().ex = this;
+    roots_[roots_num_++] = h;
+    if (running_) h.resume();
+    return true;
+  }
+
+  // run spawned tasks with tick period `interval_ms` (fractional period
+  // is rounded to ns); return 0 when all tasks end or stop() is called,
+  // -1 on error
+  int run(double interval_ms)
+  {
+    epoll_event ev[SCORO_PINS_MAX + 1];
+    int i, n, retv = 0;
+
+    if (err_) return -1;
+
+    epfd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd_ < 0) return -1;
+    if (!watch(stimer_fd(&timer_), nullptr)) return -1;
+
+    period_ = (int64_t) (interval_ms * 1e6 + 0.5);
+    grid_   = stimer_time_ns(&timer_) + period_;
+    if (stimer_start_at(&timer_, interval_ms, grid_) != 0) return -1;
+
+    // spawned tasks run to their first wait
+    // (ended one is replaced by last one, so from last to first)
+    running_ = true;
+    for (i = roots_num_ - 1; i >= 0; i--)
+      roots_[i].resume();
+    rearm();
+
+    while (roots_num_ > 0 && !timer_.stop)
+    {
+      n = epoll_wait(epfd_, ev, SCORO_PINS_MAX + 1, -1);
+      if (n < 0)
+      {
+        if (errno == EINTR) continue; // stop() from signal handler?
+        retv = -1;
+        break;
+      }
+
+      for (i = 0; i < n; i++)
+      {
+        if (ev[i].data.ptr == nullptr)
+        { // timer: due tasks are resumed by on_tick()
+          if (stimer_dispatch(&timer_) < 0)
+            retv = -1;
+        }
+        else
+          on_edge((sgpio_t*) ev[i].data.ptr);
+      }
+      if (retv < 0) break;
+      rearm();
+    }
+
+    running_ = false;
+    stimer_stop(&timer_);
+    return retv;
+  }
+
+  // stop run() (may be called from task or signal handler)
+  void stop() { stimer_stop(&timer_); }
+
+  // current time, last expired deadline, its wake-up time [ns]
+  // (STIMER_CLOCKID)
+  int64_t now()      const { return stimer_time_ns(&timer_); }
+  int64_t deadline() const { return timer_.deadline; }
+  int64_t wakeup()   const { return timer_.wakeup; }
+
+  // tick period [ns]
+  int64_t period() const { return period_; }
+
+  // number of not ended spawned tasks
+  int tasks() const { return roots_num_; }
+
+  // underlying timer
+  stimer_t       *native()       { return &timer_; }
+  const stimer_t *native() const { return &timer_; }
+
+  //---------------------------------------------------------------------------
+  // wait until time `t` [ns] (STIMER_CLOCKID)
+  auto sleep_until(int64_t t)
+  {
+    struct Awaiter {
+      Executor *ex;
+      int64_t t;
+      bool await_ready() noexcept { return t <= ex->now(); }
+      bool await_suspend(std::coroutine_handle<> h) noexcept
+      {
+        return ex->add_sleep(t, h);
+      }
+      void await_resume() noexcept {}
+    };
+    return Awaiter{this, t};
+  }
+
+  // wait `ns` nanoseconds since last deadline (no drift in sequences)
+  auto sleep_for(int64_t ns) { return sleep_until(timer_.deadline + ns); }
+
+  // wait next tick of period grid
+  auto next_tick()
+  {
+    int64_t t = now();
+    while (grid_ <= t) grid_ += period_;
+    return sleep_until(grid_);
+  }
+
+  // wait edge of input pin (mode and edge are set by sgpio_mode(),
+  // sgpio_edge_open() is called if was not) up to `timeout_ns` (< 0 -
+  // forever); `co_await` returns edge time [ns] (wake-up time, sysfs
+  // has no edge timestamps), 0 on timeout or SGPIO_ERR_* < 0
+  struct EdgeWait {
+    Executor *ex;
+    sgpio_t *pin;
+    int64_t timeout; // absolute [ns] or -1
+    int64_t result;
+    std::coroutine_handle<> h;
+
+    bool await_ready() noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> c) noexcept
+    {
+      h = c;
+      return ex->add_edge(this);
+    }
+    int64_t await_resume() noexcept { return result; }
+  };
+
+  EdgeWait edge(sgpio_t *pin, int64_t timeout_ns = -1)
+  {
+    return EdgeWait{this, pin, timeout_ns < 0 ? -1 : now() + timeout_ns, 0,
+                    nullptr};
+  }
+
+private:
+  friend struct Task::promise_type;
+
+  struct Sleep {
+    int64_t t;
+    std::coroutine_handle<> h;
+  };
+
+  struct Pin {
+    sgpio_t  *pin;
+    EdgeWait *wait;
+  };
+
+  // spawned task is ended
+  void finished(std::coroutine_handle<> h)
+  {
+    for (int i = 0; i < roots_num_; i++)
+      if (roots_[i] == h)
+      {
+        roots_[i] = roots_[--roots_num_];
+        break;
+      }
+  }
+
+  // add fd to epoll set (`ptr` - pin or nullptr for timer)
+  bool watch(int fd, sgpio_t *pin)
+  {
+    epoll_event ev;
+    ev.events   = EPOLLIN;
+    ev.data.ptr = (void*) pin;
+    return fd >= 0 && epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev) == 0;
+  }
+
+  // sleeps are kept sorted by time descending: earliest one is last
+  bool add_sleep(int64_t t, std::coroutine_handle<> h)
+  {
+    int i;
+    if (sleeps_num_ >= capacity_) return false; // can't happen: frames
+    for (i = sleeps_num_; i > 0 && sleeps_[i - 1].t < t; i--)
+      sleeps_[i] = sleeps_[i - 1];
+    sleeps_[i] = Sleep{t, h};
+    sleeps_num_++;
+    return true;
+  }
+
+  // register edge waiter (return false to resume at once with error)
+  bool add_edge(EdgeWait *a)
+  {
+    int i, free = -1;
+
+    for (i = 0; i < SCORO_PINS_MAX; i++)
+      if (pins_[i].pin == a->pin)
+        break;
+      else if (pins_[i].pin == nullptr && free < 0)
+        free = i;
+
+    if (i == SCORO_PINS_MAX)
+    { // first wait of pin: persistent epoll set of its "value"
+      int err = SGPIO_ERR_NONE;
+      if (free < 0)
+        err = SGPIO_ERR_EPOOL1;
+      else if (!a->pin->fake && a->pin->epfd < 0)
+        err = sgpio_edge_open(a->pin);
+      if (err == SGPIO_ERR_NONE && !a->pin->fake &&
+          !watch(a->pin->epfd, a->pin))
+        err = SGPIO_ERR_EPOOL2;
+      if (err != SGPIO_ERR_NONE)
+      {
+        a->result = err;
+        return false;
+      }
+      i = free;
+      pins_[i].pin = a->pin;
+    }
+
+    if (pins_[i].wait != nullptr)
+    { // one waiter per pin
+      a->result = SGPIO_ERR_EPOOL1;
+      return false;
+    }
+    pins_[i].wait = a;
+    return true;
+  }
+
+  // edge of registered pin
+  void on_edge(sgpio_t *pin)
+  {
+    int64_t mono;
+    int i, retv = sgpio_edge_wait(pin, 0, &mono);
+
+    if (retv == 0) return; // spurious
+
+    for (i = 0; i < SCORO_PINS_MAX; i++)
+      if (pins_[i].pin == pin)
+        break;
+    if (i == SCORO_PINS_MAX || pins_[i].wait == nullptr)
+      return; // nobody waits: edge is dropped
+
+    EdgeWait *w = pins_[i].wait;
+    pins_[i].wait = nullptr;
+    w->result = retv > 0 ? mono + timer_.offset : retv;
+    w->h.resume();
+  }
+
+  // timer callback: resume due sleeps and timed out edge waits
+  static int call(void *context)
+  {
+    Executor *self = static_cast<Executor*>(context);
+    int64_t t = self->timer_.deadline;
+    int i;
+
+    while (self->sleeps_num_ > 0 &&
+           self->sleeps_[self->sleeps_num_ - 1].t <= t)
+      self->sleeps_[--self->sleeps_num_].h.resume();
+
+    for (i = 0; i < SCORO_PINS_MAX; i++)
+    {
+      EdgeWait *w = self->pins_[i].wait;
+      if (w != nullptr && w->timeout >= 0 && w->timeout <= t)
+      {
+        self->pins_[i].wait = nullptr;
+        w->result = 0;
+        w->h.resume();
+      }
+    }
+
+    return 0;
+  }
+
+  // arm timer to earliest wait (or next grid tick if none)
+  void rearm()
+  {
+    int64_t t = sleeps_num_ ? sleeps_[sleeps_num_ - 1].t : INT64_MAX;
+    int i;
+
+    for (i = 0; i < SCORO_PINS_MAX; i++)
+    {
+      const EdgeWait *w = pins_[i].wait;
+      if (w != nullptr && w->timeout >= 0 && w->timeout < t)
+        t = w->timeout;
+    }
+    if (t == INT64_MAX)
+    {
+      int64_t n = now();
+      while (grid_ <= n) grid_ += period_;
+      t = grid_;
+    }
+
+    if (t != timer_.next)
+      stimer_shift_ns(&timer_, t - timer_.next);
+  }
+
+  Pool pool_;
+  stimer_t timer_;
+  int err_  = -1;
+  int epfd_ = -1;
+  bool running_ = false;
+  int64_t period_ = 0; // tick period [ns]
+  int64_t grid_   = 0; // next tick of period grid [ns]
+  int capacity_   = 0; // max number of waits/spawned tasks (= frames)
+  Sleep *sleeps_  = nullptr;
+  int sleeps_num_ = 0;
+  std::coroutine_handle<> *roots_ = nullptr;
+  int roots_num_  = 0;
+  Pin pins_[SCORO_PINS_MAX];
+};
+//-----------------------------------------------------------------------------
+template <class... A>
+inline void *Task::promise_type::operator new(std::size_t n, Executor &ex,
+                                              A&...) noexcept
+{
+  return ex.pool().alloc(n);
+}
+//-----------------------------------------------------------------------------
+template <class T, class... A>
+inline void *Task::promise_type::operator new(std::size_t n, T&,
+                                              Executor &ex, A&...) noexcept
+{
+  return ex.pool().alloc(n);
+}
+//-----------------------------------------------------------------------------
+inline std::coroutine_handle<>
+Task::promise_type::Final::await_suspend(handle_type h) noexcept
+{
+  promise_type &p = h.promise();
+  if (p.cont) return p.cont;
+
+  // spawned task: nobody owns frame but executor
+  if (p.ex) p.ex->finished(h);
+  h.destroy();
+  return std::noop_coroutine();
+}
+//-----------------------------------------------------------------------------
+} // namespace scoro
+//-----------------------------------------------------------------------------
+#endif // SCORO_HPP
+
+/*** end of "scoro.hpp" file ***/
@@ -3,12 +3,34 @@
  * File: "sgpio.c"
  */
 //----------------------------------------------------------------------------
+#define _GNU_SOURCE    // O_PATH
 #include "sgpio.h"     // `sgpio_t`
 #include <errno.h>     // errno
 #include <string.h>    // strlen(), memset(), strerror()
 #include <poll.h>      // poll()
 #include <sys/epoll.h> // epoll()
 #include <stdio.h>     // snprintf()
+#include <stdlib.h>    // malloc(), free()
+#include <time.h>      // clock_gettime(), nanosleep()
+#include <pthread.h>   // pthread_create(), pthread_join()
+#include <sys/inotify.h> // inotify_init1(), inotify_add_watch()
+//----------------------------------------------------------------------------
+// base path (SGPIO_MAIN_PATH by default)
+static char sgpio_main_path[SGPIO_PATH_MAX / 2] = SGPIO_MAIN_PATH;
+//----------------------------------------------------------------------------
+// set base path instead of SGPIO_MAIN_PATH (e.g. stand-in test directory)
+void sgpio_set_path(const char *path)
+{
+  int len = strlen(path);
+  snprintf(sgpio_main_path, sizeof(sgpio_main_path), "%s%s",
+           path, (len && path[len - 1] == '/') ? "" : "/");
+}
+//----------------------------------------------------------------------------
+// get base path ("/sys/class/gpio/" by default)
+const char *sgpio_path()
+{
+  return sgpio_main_path;
+}
 //----------------------------------------------------------------------------
 // write `size` bytes to stream `fd` from `buf` at once
 int sgpio_write(int fd, const char *buf, int size)
@@ -39,10 +61,10 @@ int sgpio_write(int fd, const char *buf, int size)
 // write num to /sys/class/gpio/export file
 int sgpio_export(int num)
 {
-  static char fname[] = SGPIO_MAIN_PATH "export";
-  char str[SGPIO_STR_MAX];
+  char fname[SGPIO_PATH_MAX], str[SGPIO_STR_MAX];
   int fd, retv, str_size;
-  
+
+  snprintf(fname, sizeof(fname), "%sexport", sgpio_main_path);
   fd = open(fname, O_WRONLY | O_TRUNC);
 
   if (fd < 0)
@@ -69,10 +91,10 @@ int sgpio_export(int num)
 // write num to /sys/class/gpio/unexport file
 int sgpio_unexport(int num)
 {
-  static char fname[] = SGPIO_MAIN_PATH "unexport";
-  char str[SGPIO_STR_MAX];
+  char fname[SGPIO_PATH_MAX], str[SGPIO_STR_MAX];
   int fd, retv, str_size;
-  
+
+  snprintf(fname, sizeof(fname), "%sunexport", sgpio_main_path);
   fd = open(fname, O_WRONLY | O_TRUNC);
 
   if (fd < 0)
@@ -96,6 +118,19 @@ int sgpio_unexport(int num)
   return SGPIO_ERR_NONE;
 }
 //----------------------------------------------------------------------------
+// open attribute file of GPIO (by openat() if directory is open)
+static int sgpio_openat(const sgpio_t *self, const char *attr, int flags,
+                        char *fname)
+{
+  snprintf(fname, SGPIO_PATH_MAX, "%sgpio%d/%s",
+           sgpio_main_path, self->num, attr);
+
+  if (self->dirfd >= 0)
+    return openat(self->dirfd, attr, flags);
+
+  return open(fname, flags);
+}
+//----------------------------------------------------------------------------
 // set GPIO mode
 int sgpio_mode(sgpio_t *self,
                int dir,  // sgpio_dir_t
@@ -112,23 +147,11 @@ int sgpio_mode(sgpio_t *self,
   char *str, fname[SGPIO_PATH_MAX];
   int fd, str_size, retv;
 
-  if (self->fd > 0)
-  {
-    close(self->fd);
-    self->fd = -1;
-  }
-
-  // set direction
-  // -------------
-  snprintf(fname, sizeof(fname),
-           SGPIO_MAIN_PATH "gpio%d/direction", self->num);
-
-  fd = open(fname, O_WRONLY | O_TRUNC);
-  if (fd < 0)
-  {
-    SGPIO_DBG("can't open '%s' in sgpio_mode(%d, %d, %d)",
-              fname, self->num, dir, edge);
-    return SGPIO_ERR_OPEN_DIR; 
+  if (self->fake)
+  { // fake GPIO: just remember mode
+    self->dir  = dir  == SGPIO_DIR_OUT ? SGPIO_DIR_OUT : SGPIO_DIR_IN;
+    self->edge = self->dir == SGPIO_DIR_IN ? edge : self->edge;
+    return SGPIO_ERR_NONE;
   }
 
   if (dir == SGPIO_DIR_OUT)
@@ -139,24 +162,40 @@ int sgpio_mode(sgpio_t *self,
     str = str_in;
   }
 
-  str_size = strlen(str);
-  retv = sgpio_write(fd, str, str_size);
-  close(fd);
-  if (retv != str_size)
+  // set direction (skip if unchanged and "value" is open)
+  // -------------
+  if (dir != self->dir || self->fd < 0)
   {
-    SGPIO_DBG("can't write '%s' to '%s' file in sgpio_mode(%d, %d, %d)",
-              str, fname, self->num, dir, edge);
-    return SGPIO_ERR_SET_DIR;
+    if (self->fd > 0)
+    { // "value" open mode depends on direction
+      close(self->fd);
+      self->fd = -1;
+    }
+
+    fd = sgpio_openat(self, "direction", O_WRONLY | O_TRUNC, fname);
+    if (fd < 0)
+    {
+      SGPIO_DBG("can't open '%s' in sgpio_mode(%d, %d, %d)",
+                fname, self->num, dir, edge);
+      return SGPIO_ERR_OPEN_DIR; 
+    }
+
+    str_size = strlen(str);
+    retv = sgpio_write(fd, str, str_size);
+    close(fd);
+    if (retv != str_size)
+    {
+      SGPIO_DBG("can't write '%s' to '%s' file in sgpio_mode(%d, %d, %d)",
+                str, fname, self->num, dir, edge);
+      return SGPIO_ERR_SET_DIR;
+    }
   }
   
   // set edge mode
   // -------------
   if (dir == SGPIO_DIR_IN && edge != self->edge)
   { // set edge mode
-    snprintf(fname, sizeof(fname),
-	     SGPIO_MAIN_PATH "gpio%d/edge", self->num);
-
-    fd = open(fname, O_WRONLY | O_TRUNC);
+    fd = sgpio_openat(self, "edge", O_WRONLY | O_TRUNC, fname);
     if (fd < 0)
     {
       SGPIO_DBG("can't open '%s' in sgpio_mode(%d, %d, %d)",
@@ -188,53 +227,388 @@ int sgpio_mode(sgpio_t *self,
     }
   }
 
-  // open value file
+  // open value file (keep it open if direction is unchanged)
   //----------------
-  snprintf(fname, sizeof(fname),
-           SGPIO_MAIN_PATH "gpio%d/value", self->num);
-  
-  if      (dir == SGPIO_DIR_IN)
-    fd = open(fname, O_RDONLY | O_NONBLOCK);
-  else if (dir == SGPIO_DIR_OUT)
-    fd = open(fname, O_RDWR | O_TRUNC);
-
-  if (fd < 0)
+  if (self->fd < 0)
   {
-    SGPIO_DBG("can't open '%s' "
-              "in sgpio_mode(%d, %d, %d)", fname, self->num, dir, edge);
-    return SGPIO_ERR_OPEN_VAL; 
+    if (dir == SGPIO_DIR_IN)
+      fd = sgpio_openat(self, "value", O_RDONLY | O_NONBLOCK, fname);
+    else // if (dir == SGPIO_DIR_OUT)
+      fd = sgpio_openat(self, "value", O_RDWR | O_TRUNC, fname);
+
+    if (fd < 0)
+    {
+      SGPIO_DBG("can't open '%s' "
+                "in sgpio_mode(%d, %d, %d)", fname, self->num, dir, edge);
+      return SGPIO_ERR_OPEN_VAL; 
+    }
+    self->fd = fd;
   }
 
-  self->fd   = fd;
   self->dir  = dir;
   self->edge = edge;
 
   return SGPIO_ERR_NONE;
 }
 //----------------------------------------------------------------------------
+// return 1 if "direction" and "value" files are writable
+static int sgpio_writable(const sgpio_t *self)
+{
+  return faccessat(self->dirfd, "direction", W_OK, 0) == 0 &&
+         faccessat(self->dirfd, "value",     W_OK, 0) == 0;
+}
+//----------------------------------------------------------------------------
+// wait up to `msec` ms until udev makes attributes writable
+// (inotify IN_ATTRIB on /sys/class/gpio/gpioNUM directory)
+static int sgpio_wait_writable(sgpio_t *self, const char *dname, int msec)
+{
+  struct timespec ts;
+  struct pollfd fds[1];
+  char buf[sizeof(struct inotify_event) + NAME_MAX + 1];
+  int64_t deadline, now;
+  int fd, timeout;
+
+  if (sgpio_writable(self))
+    return SGPIO_ERR_NONE; // root or udev already done
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  deadline = ((int64_t) ts.tv_sec) * 1000 + ts.tv_nsec / 1000000 + msec;
+
+  fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd >= 0 && inotify_add_watch(fd, dname, IN_ATTRIB) < 0)
+  {
+    close(fd);
+    fd = -1;
+  }
+
+  while (!sgpio_writable(self))
+  {
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    now = ((int64_t) ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+    if (now >= deadline)
+    {
+      SGPIO_DBG("timeout of waiting '%s' permissions in sgpio_open(%d)",
+                dname, self->num);
+      if (fd >= 0) close(fd);
+      return SGPIO_ERR_TIMEOUT;
+    }
+    timeout = (int) (deadline - now);
+
+    if (fd >= 0)
+    { // wait attribute change
+      fds->fd      = fd;
+      fds->events  = POLLIN;
+      fds->revents = 0;
+      if (poll(fds, 1, timeout) > 0)
+        while (read(fd, buf, sizeof(buf)) > 0); // drain events
+    }
+    else // no inotify: check every 1 ms
+      poll(NULL, 0, 1);
+  }
+
+  if (fd >= 0) close(fd);
+  return SGPIO_ERR_NONE;
+}
+//----------------------------------------------------------------------------
+// open /sys/class/gpio/gpioNUM directory (O_PATH) for fast openat(),
+// export GPIO only if it is not exported yet and wait up to `msec` ms
+// (inotify) until udev makes "direction" and "value" files writable
+int sgpio_open(sgpio_t *self, int msec)
+{
+  char dname[SGPIO_PATH_MAX];
+  int retv;
+
+  if (self->fake || self->dirfd >= 0)
+    return SGPIO_ERR_NONE;
+
+  snprintf(dname, sizeof(dname), "%sgpio%d", sgpio_main_path, self->num);
+
+  self->dirfd = open(dname, O_PATH | O_DIRECTORY | O_CLOEXEC);
+  if (self->dirfd < 0)
+  { // not exported yet (directory appears synchronously on export)
+    retv = sgpio_export(self->num);
+    if (retv != SGPIO_ERR_NONE)
+      return retv;
+    self->exported = 1;
+
+    self->dirfd = open(dname, O_PATH | O_DIRECTORY | O_CLOEXEC);
+    if (self->dirfd < 0)
+    {
+      SGPIO_DBG("can't open '%s' in sgpio_open(%d)", dname, self->num);
+      return SGPIO_ERR_OPEN_GPIO;
+    }
+  }
+
+  return sgpio_wait_writable(self, dname, msec);
+}
+//----------------------------------------------------------------------------
+// arguments of sgpio_provision() thread
+typedef struct sgpio_provision_ {
+  pthread_t thread;
+  sgpio_t *gpios;
+  int first, num, step;
+  int dir, edge, msec;
+  int retv;
+} sgpio_provision_t;
+//----------------------------------------------------------------------------
+// sgpio_provision() thread: open and set mode of every `step`-th GPIO
+static void *sgpio_provision_thread(void *arg)
+{
+  sgpio_provision_t *p = (sgpio_provision_t*) arg;
+  int i, retv;
+
+  p->retv = SGPIO_ERR_NONE;
+  for (i = p->first; i < p->num; i += p->step)
+  {
+    retv = sgpio_open(p->gpios + i, p->msec);
+    if (retv == SGPIO_ERR_NONE)
+      retv = sgpio_mode(p->gpios + i, p->dir, p->edge);
+    if (retv != SGPIO_ERR_NONE && p->retv == SGPIO_ERR_NONE)
+      p->retv = retv;
+  }
+
+  return NULL;
+}
+//----------------------------------------------------------------------------
+// open and set mode of `num` GPIO in parallel threads (fast startup)
+// (return SGPIO_ERR_NONE or first error code)
+int sgpio_provision(sgpio_t *gpios, int num, int dir, int edge, int msec)
+{
+  sgpio_provision_t p[SGPIO_PROVISION_THREADS];
+  int i, n, retv = SGPIO_ERR_NONE;
+
+  n = num < SGPIO_PROVISION_THREADS ? num : SGPIO_PROVISION_THREADS;
+  for (i = 0; i < n; i++)
+  {
+    p[i].gpios = gpios;
+    p[i].first = i;
+    p[i].num   = num;
+    p[i].step  = n;
+    p[i].dir   = dir;
+    p[i].edge  = edge;
+    p[i].msec  = msec;
+  }
+
+  if (n <= 1)
+  { // single GPIO: no threads
+    if (n == 1) sgpio_provision_thread((void*) p);
+    return n == 1 ? p->retv : SGPIO_ERR_NONE;
+  }
+
+  for (i = 0; i < n; i++)
+  {
+    if (pthread_create(&p[i].thread, NULL,
+                       sgpio_provision_thread, (void*) (p + i)) != 0)
+    {
+      SGPIO_DBG("can't create thread in sgpio_provision()");
+      retv = SGPIO_ERR_THREAD;
+      break;
+    }
+  }
+  n = i;
+
+  for (i = 0; i < n; i++)
+  {
+    pthread_join(p[i].thread, NULL);
+    if (retv == SGPIO_ERR_NONE)
+      retv = p[i].retv;
+  }
+
+  return retv;
+}
+//----------------------------------------------------------------------------
+// record edge to fake GPIO backend buffer
+static int sgpio_fake_set(sgpio_t *self, int val)
+{
+  sgpio_fake_t *fake = self->fake;
+  sgpio_event_t *ev;
+  struct timespec ts;
+
+  self->val = val = !!val;
+
+  if (fake->count >= fake->size)
+  {
+    fake->lost++;
+    return SGPIO_ERR_NONE;
+  }
+
+  ev = fake->events + fake->count++;
+  if (fake->clock)
+    ev->time = fake->clock(fake->context);
+  else
+  {
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ev->time = ((int64_t) ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+  }
+  ev->num = self->num;
+  ev->val = val;
+
+  return SGPIO_ERR_NONE;
+}
+//----------------------------------------------------------------------------
+// init fake GPIO backend with buffer for `size` events
+// (return SGPIO_ERR_NONE or SGPIO_ERR_FAKE_ALLOC)
+int sgpio_fake_init(sgpio_fake_t *fake, unsigned size)
+{
+  fake->clock   = (int64_t (*)(void*)) NULL;
+  fake->context = NULL;
+  fake->size    = size;
+  fake->count   = 0;
+  fake->lost    = 0;
+  fake->events  = (sgpio_event_t*) malloc(sizeof(sgpio_event_t) * size);
+  if (fake->events == (sgpio_event_t*) NULL)
+  {
+    SGPIO_DBG("can't allocate %u events in sgpio_fake_init()", size);
+    fake->size = 0;
+    return SGPIO_ERR_FAKE_ALLOC;
+  }
+
+  // touch buffer pages now (no page faults while recording)
+  memset((void*) fake->events, 0, sizeof(sgpio_event_t) * size);
+  return SGPIO_ERR_NONE;
+}
+//----------------------------------------------------------------------------
+// free buffer of fake GPIO backend
+void sgpio_fake_free(sgpio_fake_t *fake)
+{
+  free((void*) fake->events);
+  fake->events = (sgpio_event_t*) NULL;
+  fake->size   = fake->count = 0;
+}
+//----------------------------------------------------------------------------
+// merge events of `src` to `dst` in time order (e.g. recorded by several
+// threads); `src` is not changed (return SGPIO_ERR_NONE or SGPIO_ERR_FAKE_ALLOC)
+int sgpio_fake_merge(sgpio_fake_t *dst, const sgpio_fake_t *src)
+{
+  unsigned n = dst->count + src->count, i = dst->count, j = src->count, k = n;
+  sgpio_event_t *events = dst->events;
+
+  if (n > dst->size)
+  {
+    events = (sgpio_event_t*) realloc(dst->events, sizeof(sgpio_event_t) * n);
+    if (events == (sgpio_event_t*) NULL)
+    {
+      SGPIO_DBG("can't allocate %u events in sgpio_fake_merge()", n);
+      return SGPIO_ERR_FAKE_ALLOC;
+    }
+    dst->events = events;
+    dst->size   = n;
+  }
+
+  // both buffers are sorted by time: merge from the end in place
+  while (j)
+  {
+    if (i && events[i - 1].time > src->events[j - 1].time)
+      events[--k] = events[--i];
+    else
+      events[--k] = src->events[--j];
+  }
+
+  dst->count = n;
+  dst->lost += src->lost;
+  return SGPIO_ERR_NONE;
+}
+//----------------------------------------------------------------------------
+// max number of GPIO in VCD file
+#define SGPIO_VCD_MAX 256
+//----------------------------------------------------------------------------
+// make VCD identifier of `i`-th GPIO (printable chars '!'...'~')
+static void sgpio_vcd_id(char *id, int i)
+{
+  do
+  {
+    *id++ = (char) ('!' + i % 94);
+    i /= 94;
+  } while (i);
+  *id = '\0';
+}
+//----------------------------------------------------------------------------
+// dump recorded edges to VCD (value change dump) file, timescale 1 ns
+// (return SGPIO_ERR_NONE or SGPIO_ERR_VCD)
+int sgpio_fake_vcd(const sgpio_fake_t *fake, const char *fname)
+{
+  int nums[SGPIO_VCD_MAX], n = 0, i, j;
+  int64_t t0, t = -1;
+  char id[4];
+  FILE *f;
+  const sgpio_event_t *ev, *end = fake->events + fake->count;
+
+  // collect GPIO numbers
+  for (ev = fake->events; ev < end; ev++)
+  {
+    for (j = 0; j < n && nums[j] != ev->num; j++);
+    if (j == n && n < SGPIO_VCD_MAX) nums[n++] = ev->num;
+  }
+
+  f = fopen(fname, "w");
+  if (f == (FILE*) NULL)
+  {
+    SGPIO_DBG("can't open '%s' in sgpio_fake_vcd()", fname);
+    return SGPIO_ERR_VCD;
+  }
+
+  fprintf(f, "$version sgpio fake GPIO $end\n"
+             "$timescale 1ns $end\n"
+             "$scope module gpio $end\n");
+  for (i = 0; i < n; i++)
+  {
+    sgpio_vcd_id(id, i);
+    fprintf(f, "$var wire 1 %s gpio%d $end\n", id, nums[i]);
+  }
+  fprintf(f, "$upscope $end\n"
+             "$enddefinitions $end\n"
+             "$dumpvars\n");
+  for (i = 0; i < n; i++)
+  {
+    sgpio_vcd_id(id, i);
+    fprintf(f, "x%s\n", id);
+  }
+  fprintf(f, "$end\n");
+
+  // value changes relative to first event
+  t0 = fake->count ? fake->events->time : 0;
+  for (ev = fake->events; ev < end; ev++)
+  {
+    for (j = 0; j < n && nums[j] != ev->num; j++);
+    if (j == n) continue; // too many GPIO
+    if (ev->time - t0 > t)
+    {
+      t = ev->time - t0;
+      fprintf(f, "#%lld\n", (long long) t);
+    }
+    sgpio_vcd_id(id, j);
+    fprintf(f, "%d%s\n", ev->val, id);
+  }
+
+  if (fclose(f) != 0)
+  {
+    SGPIO_DBG("can't write '%s' in sgpio_fake_vcd()", fname);
+    return SGPIO_ERR_VCD;
+  }
+
+  return SGPIO_ERR_NONE;
+}
+//----------------------------------------------------------------------------
 // get value (return 0 or 1 or error code < 0)
 int sgpio_get(sgpio_t *self)
 {
   char c;
   int retv;
 
+  if (self->fake)
+    return self->val;
+
   if (self->fd < 0)
   {
     SGPIO_DBG("unset mode in sgpio_get(%d)", self->num);
     return SGPIO_ERR_UNSET_MODE;
   }
 
-  retv = lseek(self->fd, 0, SEEK_SET);
-  if (retv != 0)
-  {
-    SGPIO_DBG("lseek(0) return %d in sgpio_get(%d)", retv, self->num);
-    return SGPIO_ERR_LSEEK;
-  }
-
-  retv = read(self->fd, &c, sizeof(char));
+  // one syscall: pread() from offset 0 instead of lseek() + read()
+  retv = pread(self->fd, &c, sizeof(char), 0);
   if (retv != sizeof(char))
   {
-    SGPIO_DBG("read(%d) return %d in sgpio_get(%d)",
+    SGPIO_DBG("pread(%d) return %d in sgpio_get(%d)",
               (int) sizeof(char), retv, self->num);
     return SGPIO_ERR_GET;
   }
@@ -248,6 +622,9 @@ int sgpio_set(sgpio_t *self, int val)
   char c = val ? '1' : '0';
   int retv;
 
+  if (self->fake)
+    return sgpio_fake_set(self, val);
+
   if (self->fd < 0)
   {
     SGPIO_DBG("unset mode in sgpio_set(%d)", self->num);
@@ -385,6 +762,108 @@ int sgpio_epoll(const sgpio_t *self, int msec)
   return 0; // empty
 }
 //----------------------------------------------------------------------------
+// make persistent epoll set for edge waits (call after sgpio_mode() with
+// edge mode, pending edge is consumed) - no setup per sgpio_edge_wait()
+// (return SGPIO_ERR_NONE or SGPIO_ERR_EPOOL1/2)
+int sgpio_edge_open(sgpio_t *self)
+{
+  struct epoll_event ev;
+  char c;
+
+  if (self->fake)
+    return SGPIO_ERR_NONE;
+
+  if (self->fd < 0)
+  {
+    SGPIO_DBG("unset mode in sgpio_edge_open(%d)", self->num);
+    return SGPIO_ERR_UNSET_MODE;
+  }
+
+  if (self->epfd >= 0) close(self->epfd);
+  self->epfd = epoll_create1(EPOLL_CLOEXEC);
+  if (self->epfd < 0)
+  {
+    SGPIO_DBG("epoll_create1() return %d: '%s' in sgpio_edge_open()",
+              self->epfd, strerror(errno));
+    return SGPIO_ERR_EPOOL1;
+  }
+
+  // sysfs "value" signals edge by POLLPRI|POLLERR
+  memset((void*) &ev, 0, sizeof(ev));
+  ev.events  = EPOLLPRI | EPOLLERR | EPOLLET;
+  ev.data.fd = self->fd;
+  if (epoll_ctl(self->epfd, EPOLL_CTL_ADD, self->fd, &ev) != 0)
+  {
+    SGPIO_DBG("epoll_ctl() fail: '%s' in sgpio_edge_open()",
+              strerror(errno));
+    close(self->epfd);
+    self->epfd = -1;
+    return SGPIO_ERR_EPOOL2;
+  }
+
+  // "value" is ready just after open: consume it
+  epoll_wait(self->epfd, &ev, 1, 0);
+  if (pread(self->fd, &c, sizeof(char), 0) != sizeof(char))
+  {
+    SGPIO_DBG("can't read value in sgpio_edge_open(%d)", self->num);
+  }
+
+  return SGPIO_ERR_NONE;
+}
+//----------------------------------------------------------------------------
+// wait edge by persistent epoll set, `time_ns` is CLOCK_MONOTONIC time
+// right after wake-up (may be NULL); value is read to re-arm the edge
+// (return 0:timeout or signal, 1:edge, <0:error code)
+// fake GPIO has no edges: sleep `msec` and return 0
+int sgpio_edge_wait(sgpio_t *self, int msec, int64_t *time_ns)
+{
+  struct epoll_event ev;
+  struct timespec ts;
+  char c;
+  int retv;
+
+  if (self->fake)
+  {
+    if (msec > 0)
+    {
+      ts.tv_sec  = msec / 1000;
+      ts.tv_nsec = (msec % 1000) * 1000000;
+      nanosleep(&ts, NULL);
+    }
+    return 0;
+  }
+
+  if (self->epfd < 0)
+  {
+    SGPIO_DBG("no epoll set in sgpio_edge_wait(%d)", self->num);
+    return SGPIO_ERR_UNSET_MODE;
+  }
+
+  retv = epoll_wait(self->epfd, &ev, 1, msec);
+  if (retv > 0 && time_ns)
+  { // timestamp first, read() below takes a few us
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    *time_ns = ((int64_t) ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+  }
+
+  if (retv < 0)
+  {
+    if (errno == EINTR)
+      return 0; // interrupt by signal
+    SGPIO_DBG("epoll_wait() return %d: '%s' in sgpio_edge_wait()",
+              retv, strerror(errno));
+    return SGPIO_ERR_EPOOL3;
+  }
+  if (retv == 0)
+    return 0; // timeout
+
+  // re-arm: sysfs reports next edge only after read from offset 0
+  if (pread(self->fd, &c, sizeof(char), 0) != sizeof(char))
+    return SGPIO_ERR_GET;
+
+  return 1;
+}
+//----------------------------------------------------------------------------
 const char *sgpio_errors[] = {
   "success",
   "can't write fo file",
@@ -404,6 +883,11 @@ const char *sgpio_errors[] = {
   "epool() return error #1",
   "epool() return error #2",
   "epool() return error #3",
+  "can't allocate fake GPIO buffer",
+  "can't write VCD file",
+  "can't open GPIO directory",
+  "timeout of waiting attribute permissions",
+  "can't create thread",
 };
 static const char *sgpio_error_unknown = "unknown error";
 //----------------------------------------------------------------------------
@@ -11,14 +11,25 @@
 #include <fcntl.h>        //
 #include <unistd.h>       // close(), read(), write(), lseek(), ...
 #include <linux/limits.h> // PATH_MAX
+#include <stdint.h>       // `int64_t`
 //----------------------------------------------------------------------------
 #define SGPIO_MAIN_PATH "/sys/class/gpio/"
 //#define SGPIO_MAIN_PATH "./gpio/" // FIXME test directory
+// (may be changed at run time by sgpio_set_path())
+//----------------------------------------------------------------------------
+// default timeout of waiting udev to set attribute permissions [ms]
+#define SGPIO_UDEV_TIMEOUT 1000
+//----------------------------------------------------------------------------
+// max number of threads in sgpio_provision()
+#define SGPIO_PROVISION_THREADS 16
 //----------------------------------------------------------------------------
 // max path size
 //#define SGPIO_PATH_MAX 1024
 #define SGPIO_PATH_MAX PATH_MAX
 //----------------------------------------------------------------------------
+// default buffer size of fake GPIO backend (number of events)
+#define SGPIO_FAKE_SIZE 65536
+//----------------------------------------------------------------------------
 // max string length of GPIO number or value
 #define SGPIO_STR_MAX 80
 //----------------------------------------------------------------------------
@@ -42,7 +53,7 @@
 #  include <stdio.h>  // fprintf()
 #    define SGPIO_DBG(fmt, arg...) fprintf(stderr, "SGPIO: " fmt "\n", ## arg)
 #else
-#  define SGPIO_DBG(fmt, ...) // debug output off
+#  define SGPIO_DBG(fmt, ...) do {} while (0) // debug output off
 #endif // SGPIO_DEBUG
 //----------------------------------------------------------------------------
 // common error codes (return values)
@@ -64,8 +75,13 @@
 #define SGPIO_ERR_EPOOL1     -15 // epool() return error #1
 #define SGPIO_ERR_EPOOL2     -16 // epool() return error #2
 #define SGPIO_ERR_EPOOL3     -17 // epool() return error #3
+#define SGPIO_ERR_FAKE_ALLOC -18 // can't allocate fake GPIO buffer
+#define SGPIO_ERR_VCD        -19 // can't write VCD file
+#define SGPIO_ERR_OPEN_GPIO  -20 // can't open /sys/class/gpio/gpioNUM directory
+#define SGPIO_ERR_TIMEOUT    -21 // timeout of waiting attribute permissions
+#define SGPIO_ERR_THREAD     -22 // can't create thread
 
-#define SGPIO_ERROR_NUM        18          // look sgpio_error_str() code
+#define SGPIO_ERROR_NUM        23          // look sgpio_error_str() code
 #define SGPIO_ERROR_INDEX(err) (0 - (err)) // ...
 //----------------------------------------------------------------------------
 // GPIO input/output direction mode
@@ -83,12 +99,34 @@ typedef enum {
   SGPIO_EDGE_BOTH
 } sgpio_edge_t;
 //----------------------------------------------------------------------------
+// recorded edge of fake GPIO
+typedef struct sgpio_event_ {
+  int64_t time; // timestamp [ns]
+  int     num;  // GPIO number
+  int     val;  // value (0 or 1)
+} sgpio_event_t;
+//----------------------------------------------------------------------------
+// fake GPIO backend (records edges to preallocated buffer)
+typedef struct sgpio_fake_ {
+  int64_t (*clock)(void *context); // timestamp source (NULL: CLOCK_MONOTONIC)
+  void *context;
+  sgpio_event_t *events; // preallocated buffer
+  unsigned size;  // buffer size (number of events)
+  unsigned count; // number of recorded events
+  unsigned lost;  // number of not recorded events (buffer full)
+} sgpio_fake_t;
+//----------------------------------------------------------------------------
 // `sgpio_t` type structure
 typedef struct sgpio_ {
   int num;  // GPIO number /sys/class/gpio/gpioNUM
   int dir;  // GPIO input/output derection mode
   int edge; // GPIO edge mode
   int fd;   // file descriptor of /sys/class/gpio/gpioNUM/value
+  int dirfd;    // O_PATH descriptor of /sys/class/gpio/gpioNUM (or -1)
+  int exported; // 1 if exported by sgpio_open()
+  int epfd;     // persistent epoll set of "value" (sgpio_edge_open()) or -1
+  int val;  // last value (fake GPIO)
+  sgpio_fake_t *fake; // fake GPIO backend (or NULL)
 } sgpio_t;
 //----------------------------------------------------------------------------
 #ifdef __cplusplus
@@ -99,6 +137,12 @@ extern "C"
 // write `size` bytes to stream `fd` from `buf` at once
 int sgpio_write(int fd, const char *buf, int size);
 //----------------------------------------------------------------------------
+// set base path instead of SGPIO_MAIN_PATH (e.g. stand-in test directory)
+void sgpio_set_path(const char *path);
+//----------------------------------------------------------------------------
+// get base path ("/sys/class/gpio/" by default)
+const char *sgpio_path();
+//----------------------------------------------------------------------------
 // write num to /sys/class/gpio/export file
 int sgpio_export(int num);
 //----------------------------------------------------------------------------
@@ -112,6 +156,11 @@ SGPIO_INLINE void sgpio_init(sgpio_t *self, int num)
   self->dir  = SGPIO_DIR_UNSET;
   self->edge = SGPIO_EDGE_NONE;
   self->fd   = -1;
+  self->dirfd    = -1;
+  self->exported = 0;
+  self->epfd = -1;
+  self->val  = 0;
+  self->fake = (sgpio_fake_t*) NULL;
 }
 //----------------------------------------------------------------------------
 // "destructor"
@@ -119,8 +168,21 @@ SGPIO_INLINE void sgpio_free(sgpio_t *self)
 {
   if (self->fd > 0) close(self->fd);
   self->fd = -1;
+  if (self->dirfd >= 0) close(self->dirfd);
+  self->dirfd = -1;
+  if (self->epfd >= 0) close(self->epfd);
+  self->epfd = -1;
 }
 //----------------------------------------------------------------------------
+// open /sys/class/gpio/gpioNUM directory (O_PATH) for fast openat(),
+// export GPIO only if it is not exported yet and wait up to `msec` ms
+// (inotify) until udev makes "direction" and "value" files writable
+int sgpio_open(sgpio_t *self, int msec);
+//----------------------------------------------------------------------------
+// open and set mode of `num` GPIO in parallel threads (fast startup)
+// (return SGPIO_ERR_NONE or first error code)
+int sgpio_provision(sgpio_t *gpios, int num, int dir, int edge, int msec);
+//----------------------------------------------------------------------------
 // set GPIO mode
 int sgpio_mode(sgpio_t *self,
                int dir,   // sgpio_dir_t
@@ -129,7 +191,7 @@ int sgpio_mode(sgpio_t *self,
 // set GPIO number
 SGPIO_INLINE void sgpio_set_num(sgpio_t *self, int num)
 {
-  if (self->fd > 0) close(self->fd);
+  sgpio_free(self);
   sgpio_init(self, num);
 }
 //----------------------------------------------------------------------------
@@ -167,6 +229,47 @@ SGPIO_INLINE int sgpio_poll(const sgpio_t *self, int msec)
 // msec - timeout in ms
 int sgpio_epoll(const sgpio_t *self, int msec);
 //----------------------------------------------------------------------------
+// make persistent epoll set for edge waits (call after sgpio_mode() with
+// edge mode, pending edge is consumed) - no setup per sgpio_edge_wait()
+// (return SGPIO_ERR_NONE or SGPIO_ERR_EPOOL1/2)
+int sgpio_edge_open(sgpio_t *self);
+//----------------------------------------------------------------------------
+// wait edge by persistent epoll set, `time_ns` is CLOCK_MONOTONIC time
+// right after wake-up (may be NULL); value is read to re-arm the edge
+// (return 0:timeout or signal, 1:edge, <0:error code)
+// fake GPIO has no edges: sleep `msec` and return 0
+int sgpio_edge_wait(sgpio_t *self, int msec, int64_t *time_ns);
+//----------------------------------------------------------------------------
+// init fake GPIO backend with buffer for `size` events
+// (return SGPIO_ERR_NONE or SGPIO_ERR_FAKE_ALLOC)
+int sgpio_fake_init(sgpio_fake_t *fake, unsigned size);
+//----------------------------------------------------------------------------
+// set timestamp source of fake GPIO backend (NULL: CLOCK_MONOTONIC)
+SGPIO_INLINE void sgpio_fake_clock(sgpio_fake_t *fake,
+                                   int64_t (*clock)(void *context),
+                                   void *context)
+{
+  fake->clock   = clock;
+  fake->context = context;
+}
+//----------------------------------------------------------------------------
+// free buffer of fake GPIO backend
+void sgpio_fake_free(sgpio_fake_t *fake);
+//----------------------------------------------------------------------------
+// merge events of `src` to `dst` in time order (e.g. recorded by several
+// threads); `src` is not changed (return SGPIO_ERR_NONE or SGPIO_ERR_FAKE_ALLOC)
+int sgpio_fake_merge(sgpio_fake_t *dst, const sgpio_fake_t *src);
+//----------------------------------------------------------------------------
+// dump recorded edges to VCD (value change dump) file, timescale 1 ns
+// (return SGPIO_ERR_NONE or SGPIO_ERR_VCD)
+int sgpio_fake_vcd(const sgpio_fake_t *fake, const char *fname);
+//----------------------------------------------------------------------------
+// switch GPIO to fake backend (no /sys/class/gpio access at all)
+SGPIO_INLINE void sgpio_fake(sgpio_t *self, sgpio_fake_t *fake)
+{
+  self->fake = fake;
+}
+//----------------------------------------------------------------------------
 // return SGPIO error string
 const char *sgpio_error_str(int err);
 //----------------------------------------------------------------------------
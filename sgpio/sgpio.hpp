@@ -0,0 +1,152 @@
+/*
+ * Simple GPIO Linux wrappers (C++17 header only layer over `sgpio_t`)
+ * File: "sgpio.hpp"
+ */
+
+#ifndef SGPIO_HPP
+#define SGPIO_HPP
+//----------------------------------------------------------------------------
+#include "sgpio.h"
+#include <fcntl.h>  // openat()
+#include <unistd.h> // read(), write(), close()
+//----------------------------------------------------------------------------
+namespace sgpio {
+//----------------------------------------------------------------------------
+// pin direction
+enum class Dir { In = SGPIO_DIR_IN, Out = SGPIO_DIR_OUT };
+//----------------------------------------------------------------------------
+// pin backend
+enum class Backend {
+  Sysfs, // /sys/class/gpio/gpioNUM/value
+  Fake   // edges recorded to `sgpio_fake_t` buffer
+};
+//----------------------------------------------------------------------------
+// GPIO pin with compile time configuration: `high()` and `low()` compile
+// to a bare write of constant level (no run time branches on backend
+// and polarity); RAII: export (if not exported yet) and mode set in
+// constructor, mode restore and unexport (if exported here) in destructor
+template <int Num,
+          Dir Direction    = Dir::Out,
+          bool Negative    = false,
+          Backend Back     = Backend::Sysfs>
+class Pin {
+public:
+  static constexpr int     num       = Num;
+  static constexpr Dir     direction = Direction;
+  static constexpr bool    negative  = Negative;
+  static constexpr Backend backend   = Back;
+
+  static_assert(Num >= 0, "GPIO number must be non negative");
+
+  // sysfs pin: wait udev permissions up to `msec` ms
+  explicit Pin(int edge = SGPIO_EDGE_NONE, int msec = SGPIO_UDEV_TIMEOUT)
+  {
+    static_assert(Back == Backend::Sysfs, "use Pin(sgpio_fake_t&) for fake");
+    sgpio_init(&gpio_, Num);
+    err_ = sgpio_open(&gpio_, msec);
+    if (err_ == SGPIO_ERR_NONE)
+    {
+      prev_ = read_dir();
+      err_  = sgpio_mode(&gpio_, static_cast<int>(Direction), edge);
+    }
+    if constexpr (Direction == Dir::Out)
+      if (err_ == SGPIO_ERR_NONE) low();
+  }
+
+  // fake pin: record edges to `rec`
+  explicit Pin(sgpio_fake_t &rec)
+  {
+    static_assert(Back == Backend::Fake, "use Pin(edge, msec) for sysfs");
+    sgpio_init(&gpio_, Num);
+    sgpio_fake(&gpio_, &rec);
+    err_ = sgpio_mode(&gpio_, static_cast<int>(Direction), SGPIO_EDGE_NONE);
+    if constexpr (Direction == Dir::Out)
+      low();
+  }
+
+  ~Pin()
+  {
+    if constexpr (Back == Backend::Sysfs)
+    {
+      if (gpio_.dirfd >= 0)
+      {
+        if (gpio_.exported)
+        { // exported here: set to input (more safe mode) and unexport
+          sgpio_mode(&gpio_, SGPIO_DIR_IN, SGPIO_EDGE_NONE);
+          sgpio_unexport(Num);
+        }
+        else if (prev_ != SGPIO_DIR_UNSET && prev_ != gpio_.dir)
+          sgpio_mode(&gpio_, prev_, SGPIO_EDGE_NONE); // restore direction
+      }
+    }
+    sgpio_free(&gpio_);
+  }
+
+  Pin(const Pin&)            = delete;
+  Pin& operator=(const Pin&) = delete;
+
+  // SGPIO_ERR_NONE or error code of constructor
+  int error() const { return err_; }
+  explicit operator bool() const { return err_ == SGPIO_ERR_NONE; }
+
+  // set active level (low level if Negative)
+  inline void high() const { put<!Negative>(); }
+
+  // set inactive level (high level if Negative)
+  inline void low() const { put<Negative>(); }
+
+  // set active (true) or inactive (false) level
+  inline void set(bool active) const
+  {
+    if (active) high();
+    else        low();
+  }
+
+  // get active (1) or inactive (0) level or error code < 0
+  int get()
+  {
+    int val = sgpio_get(&gpio_);
+    return (val < 0 || !Negative) ? val : !val;
+  }
+
+  // underlying C structure
+  sgpio_t       *native()       { return &gpio_; }
+  const sgpio_t *native() const { return &gpio_; }
+
+private:
+  template <bool Level>
+  inline void put() const
+  {
+    static_assert(Direction == Dir::Out, "can't set input pin");
+    if constexpr (Back == Backend::Fake)
+      sgpio_set(const_cast<sgpio_t*>(&gpio_), Level);
+    else
+    {
+      static constexpr char c = Level ? '1' : '0';
+      (void) !::write(gpio_.fd, &c, 1);
+    }
+  }
+
+  // read current direction of exported pin (SGPIO_DIR_UNSET if unknown)
+  int read_dir() const
+  {
+    char c = 0;
+    int fd = ::openat(gpio_.dirfd, "direction", O_RDONLY);
+    if (fd < 0) return SGPIO_DIR_UNSET;
+    if (::read(fd, &c, 1) != 1) c = 0;
+    ::close(fd);
+    return c == 'i' ? SGPIO_DIR_IN :
+           c == 'o' ? SGPIO_DIR_OUT : SGPIO_DIR_UNSET;
+  }
+
+  sgpio_t gpio_;
+  int err_  = SGPIO_ERR_NONE;
+  int prev_ = SGPIO_DIR_UNSET; // direction before constructor
+};
+//----------------------------------------------------------------------------
+} // namespace sgpio
+//----------------------------------------------------------------------------
+#endif // SGPIO_HPP
+
+/*** end of "sgpio.hpp" file ***/
+
@@ -0,0 +1,201 @@
+/*
+ * Per-thread hardware/software counters (perf_event_open) sampled around
+ * a code region (e.g. timer handler) with per-sample distributions
+ * File: "sperf.c"
+ */
+//-----------------------------------------------------------------------------
+#include "sperf.h"   // `sperf_t`
+#include <stdlib.h>  // malloc(), free()
+#include <string.h>  // memset()
+#include <time.h>    // clock_gettime()
+#include <unistd.h>  // syscall(), read(), close()
+#include <errno.h>   // errno, EACCES, EPERM
+#include <sys/syscall.h>         // __NR_perf_event_open
+#include <linux/perf_event.h>    // `struct perf_event_attr`, PERF_*
+//-----------------------------------------------------------------------------
+// type and config of counters (SPERF_CYCLES...SPERF_TASK_CLOCK)
+static const struct {
+  uint32_t type;
+  uint64_t config;
+} sperf_events[SPERF_COUNTERS] = {
+  { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES         },
+  { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS       },
+  { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES       },
+  { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES   },
+  { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS        },
+  { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK         }
+};
+
+// open order of counters
+static const int sperf_order[SPERF_COUNTERS] = {
+  SPERF_TASK_CLOCK, SPERF_CYCLES, SPERF_INSTRUCTIONS, SPERF_CACHE_MISSES,
+  SPERF_CTX_SWITCHES, SPERF_PAGE_FAULTS
+};
+//-----------------------------------------------------------------------------
+// open one counter of calling thread in group `leader` (-1 - new group)
+static int sperf_event_open(int i, int leader, int exclude_kernel)
+{
+  struct perf_event_attr attr;
+
+  memset((void*) &attr, 0, sizeof(attr));
+  attr.size           = sizeof(attr);
+  attr.type           = sperf_events[i].type;
+  attr.config         = sperf_events[i].config;
+  attr.read_format    = PERF_FORMAT_GROUP |
+                        PERF_FORMAT_TOTAL_TIME_ENABLED |
+                        PERF_FORMAT_TOTAL_TIME_RUNNING;
+  attr.exclude_kernel = exclude_kernel;
+  attr.exclude_hv     = 1;
+
+  return (int) syscall(__NR_perf_event_open, &attr, 0, -1, leader,
+                       PERF_FLAG_FD_CLOEXEC);
+}
+//-----------------------------------------------------------------------------
+// open counters of calling thread as one group (return SPERF_ERR_*)
+int sperf_open(sperf_t *self)
+{
+  int i, k, fd, exclude_kernel = 0;
+
+  memset((void*) self, 0, sizeof(sperf_t));
+  self->leader = -1;
+  for (i = 0; i < SPERF_COUNTERS; i++)
+    self->fd[i] = -1;
+
+  self->stat = (sstat_t*) malloc(sizeof(sstat_t) * SPERF_STATS);
+  if (self->stat == (sstat_t*) NULL)
+    return SPERF_ERR_ALLOC;
+  for (i = 0; i < SPERF_STATS; i++)
+    sstat_init(self->stat + i);
+
+  // task clock leads: group read updates time of leader exactly, while
+  // time of software member may lag up to scheduler tick; hardware
+  // members move group to hardware context (kernel does it)
+  for (k = 0; k < SPERF_COUNTERS; k++)
+  {
+    i = sperf_order[k];
+    fd = sperf_event_open(i, self->leader, exclude_kernel);
+    if (fd < 0 && (errno == EACCES || errno == EPERM) && !exclude_kernel)
+    { // kernel part is not allowed (perf_event_paranoid), user space only
+      exclude_kernel = 1;
+      fd = sperf_event_open(i, self->leader, exclude_kernel);
+    }
+    if (fd < 0) continue; // unavailable (e.g. no PMU in VM)
+
+    if (self->leader < 0) self->leader = fd;
+    self->fd[i]  = fd;
+    self->pos[i] = self->num++;
+  }
+
+  return self->num ? SPERF_ERR_NONE : SPERF_ERR_OPEN;
+}
+//-----------------------------------------------------------------------------
+// read all counters (one syscall) and group times to `enabled`/`running`
+// (return 0 or -1)
+int sperf_read(sperf_t *self, uint64_t *values, uint64_t *enabled,
+               uint64_t *running)
+{
+  struct timespec ts;
+  int i, size = (int) sizeof(uint64_t) * (3 + self->num);
+
+  if (read(self->leader, self->buf, size) != size)
+    return -1;
+
+  *enabled = self->buf[1];
+  *running = self->buf[2];
+  for (i = 0; i < SPERF_COUNTERS; i++)
+    if (self->fd[i] >= 0)
+      values[i] = self->buf[3 + self->pos[i]];
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  values[SPERF_WALL] = ((uint64_t) ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+  return 0;
+}
+//-----------------------------------------------------------------------------
+// end sample: add deltas since successful sperf_begin() to distributions
+void sperf_end(sperf_t *self)
+{
+  uint64_t end[SPERF_STATS], enabled, running;
+  int64_t wall;
+  int i;
+
+  if (!self->started) return; // no (valid) begin values
+  self->started = 0;
+  if (sperf_read(self, end, &enabled, &running) < 0)
+  {
+    self->errors++;
+    return;
+  }
+
+  if (running - self->running != enabled - self->enabled)
+  { // group was scheduled off PMU (more events than counters)
+    self->multiplexed++;
+    return;
+  }
+
+  for (i = 0; i < SPERF_COUNTERS; i++)
+    if (self->fd[i] >= 0)
+      sstat_add(self->stat + i, (int64_t) (end[i] - self->begin[i]));
+
+  wall = (int64_t) (end[SPERF_WALL] - self->begin[SPERF_WALL]);
+  sstat_add(self->stat + SPERF_WALL, wall);
+
+  if (self->fd[SPERF_TASK_CLOCK] >= 0)
+  { // time off CPU inside region: preemption (or blocking)
+    wall -= (int64_t) (end[SPERF_TASK_CLOCK] - self->begin[SPERF_TASK_CLOCK]);
+    sstat_add(self->stat + SPERF_OFF_CPU, wall > 0 ? wall : 0);
+  }
+}
+//-----------------------------------------------------------------------------
+// merge distributions of `src` (e.g. other thread) to `self`
+void sperf_merge(sperf_t *self, const sperf_t *src)
+{
+  int i;
+
+  if (self->stat == (sstat_t*) NULL || src->stat == (sstat_t*) NULL)
+    return;
+
+  for (i = 0; i < SPERF_STATS; i++)
+    sstat_merge(self->stat + i, src->stat + i);
+  self->errors      += src->errors;
+  self->multiplexed += src->multiplexed;
+}
+//-----------------------------------------------------------------------------
+// close counters and free distributions
+void sperf_free(sperf_t *self)
+{
+  int i;
+
+  for (i = 0; i < SPERF_COUNTERS; i++)
+  {
+    if (self->fd[i] >= 0) close(self->fd[i]);
+    self->fd[i] = -1;
+  }
+  self->leader = -1;
+  self->num    = 0;
+
+  free((void*) self->stat);
+  self->stat = (sstat_t*) NULL;
+}
+//-----------------------------------------------------------------------------
+// counter name (SPERF_*)
+const char *sperf_name(int i)
+{
+  static const char *names[SPERF_STATS] = {
+    "cycles", "instr", "cache_miss", "ctx_sw", "faults", "task_ns",
+    "wall_ns", "offcpu_ns"
+  };
+  return (i >= 0 && i < SPERF_STATS) ? names[i] : "unknown";
+}
+//-----------------------------------------------------------------------------
+// error string
+const char *sperf_error_str(int err)
+{
+  static const char *errors[] = {
+    "success",
+    "can't allocate statistics",
+    "no perf counter can be opened"
+  };
+  return (err <= 0 && err > -3) ? errors[-err] : "unknown error";
+}
+//-----------------------------------------------------------------------------
+/*** end of "sperf.c" file ***/
@@ -0,0 +1,110 @@
+/*
+ * Per-thread hardware/software counters (perf_event_open) sampled around
+ * a code region (e.g. timer handler) with per-sample distributions
+ * File: "sperf.h"
+ */
+
+#ifndef SPERF_H
+#define SPERF_H
+//-----------------------------------------------------------------------------
+#include <stdint.h> // `uint64_t`, `int64_t`
+#include "sstat.h"  // `sstat_t`
+//-----------------------------------------------------------------------------
+// counters (index of `sperf_t.stat[]`)
+#define SPERF_CYCLES       0 // CPU cycles (hardware)
+#define SPERF_INSTRUCTIONS 1 // retired instructions (hardware)
+#define SPERF_CACHE_MISSES 2 // last level cache misses (hardware)
+#define SPERF_CTX_SWITCHES 3 // context switches (software)
+#define SPERF_PAGE_FAULTS  4 // page faults (software)
+#define SPERF_TASK_CLOCK   5 // on CPU time [ns] (software)
+#define SPERF_COUNTERS     6 // number of perf counters
+#define SPERF_WALL         6 // wall time [ns] (CLOCK_MONOTONIC)
+#define SPERF_OFF_CPU      7 // wall time - on CPU time [ns] (preemption)
+#define SPERF_STATS        8 // number of distributions
+
+// inline macro (platform depended)
+#ifndef   SPERF_INLINE
+#  define SPERF_INLINE static inline
+#endif // SPERF_INLINE
+
+// error codes
+#define SPERF_ERR_NONE   0 // no error
+#define SPERF_ERR_ALLOC -1 // can't allocate statistics
+#define SPERF_ERR_OPEN  -2 // no counter can be opened
+//-----------------------------------------------------------------------------
+// `sperf_t` type structure
+typedef struct sperf_ {
+  int fd[SPERF_COUNTERS];    // counter file descriptor (-1 - unavailable)
+  int pos[SPERF_COUNTERS];   // position in group read
+  int leader;                // group leader fd (one read() for all)
+  int num;                   // number of opened counters
+  int started;               // sperf_begin() read succeeded
+  uint64_t begin[SPERF_STATS]; // values at sperf_begin()
+  uint64_t enabled, running; // group time enabled/running [ns]
+  uint64_t buf[3 + SPERF_COUNTERS]; // group read: nr, times, values
+  sstat_t *stat;             // SPERF_STATS distributions of deltas
+  unsigned errors;           // failed reads (sample skipped)
+  unsigned multiplexed;      // group not on PMU all sample (skipped)
+} sperf_t;
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+// open counters of calling thread as one group (hardware counters are
+// skipped if unavailable, e.g. in VM); kernel part is counted if allowed
+// (return SPERF_ERR_*)
+int sperf_open(sperf_t *self);
+//-----------------------------------------------------------------------------
+// read all counters (one syscall) and group times to `enabled`/`running`
+// (return 0 or -1)
+int sperf_read(sperf_t *self, uint64_t *values, uint64_t *enabled,
+               uint64_t *running);
+//-----------------------------------------------------------------------------
+// start sample: remember counters (return 0 or -1 - sample is skipped)
+SPERF_INLINE int sperf_begin(sperf_t *self)
+{
+  self->started = 0;
+  if (self->num == 0) return -1;
+  if (sperf_read(self, self->begin, &self->enabled, &self->running) < 0)
+  {
+    self->errors++;
+    return -1;
+  }
+  self->started = 1;
+  return 0;
+}
+//-----------------------------------------------------------------------------
+// end sample: add deltas since successful sperf_begin() to distributions;
+// sample is skipped if counters were multiplexed (group was not counting
+// all the time, deltas would be scaled down)
+void sperf_end(sperf_t *self);
+//-----------------------------------------------------------------------------
+// return 1 if counter (SPERF_*) is available
+SPERF_INLINE int sperf_available(const sperf_t *self, int i)
+{
+  if (i == SPERF_WALL) return self->num != 0;
+  if (i == SPERF_OFF_CPU) i = SPERF_TASK_CLOCK;
+  return self->fd[i] >= 0;
+}
+//-----------------------------------------------------------------------------
+// merge distributions of `src` (e.g. other thread) to `self`
+void sperf_merge(sperf_t *self, const sperf_t *src);
+//-----------------------------------------------------------------------------
+// close counters and free distributions
+void sperf_free(sperf_t *self);
+//-----------------------------------------------------------------------------
+// counter name (SPERF_*)
+const char *sperf_name(int i);
+//-----------------------------------------------------------------------------
+// error string
+const char *sperf_error_str(int err);
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+#endif // SPERF_H
+
+/*** end of "sperf.h" file ***/
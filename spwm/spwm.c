@@ -0,0 +1,209 @@
+/*
+ * Hardware PWM channel by Linux sysfs (/sys/class/pwm/pwmchipN/pwmM):
+ * periodic pulses are generated without CPU at all
+ * File: "spwm.c"
+ */
+//-----------------------------------------------------------------------------
+#include "spwm.h"   // `spwm_t`
+#include <stdio.h>  // snprintf()
+#include <stdlib.h> // strtoll()
+#include <string.h> // strlen()
+#include <time.h>   // nanosleep()
+#include <fcntl.h>  // open(), O_WRONLY, O_TRUNC
+#include <unistd.h> // read(), write(), close(), access()
+//-----------------------------------------------------------------------------
+static char spwm_main_path[SPWM_PATH_MAX / 2] = SPWM_MAIN_PATH;
+//-----------------------------------------------------------------------------
+// set base path instead of SPWM_MAIN_PATH (e.g. stand-in test directory)
+void spwm_set_path(const char *path)
+{
+  int len = strlen(path);
+  snprintf(spwm_main_path, sizeof(spwm_main_path), "%s%s",
+           path, (len && path[len - 1] == '/') ? "" : "/");
+}
+//-----------------------------------------------------------------------------
+// get base path ("/sys/class/pwm/" by default)
+const char *spwm_path()
+{
+  return spwm_main_path;
+}
+//-----------------------------------------------------------------------------
+// file name of chip (`attr` of pwmchipN) or channel (`attr` of pwmM)
+static void spwm_fname(const spwm_t *self, int of_chip, const char *attr,
+                       char *fname)
+{
+  if (of_chip)
+    snprintf(fname, SPWM_PATH_MAX, "%spwmchip%d/%s",
+             spwm_main_path, self->chip, attr);
+  else
+    snprintf(fname, SPWM_PATH_MAX, "%spwmchip%d/pwm%d/%s",
+             spwm_main_path, self->chip, self->channel, attr);
+}
+//-----------------------------------------------------------------------------
+// write string to attribute (return 0 or -1)
+static int spwm_write(const spwm_t *self, int of_chip, const char *attr,
+                      const char *str)
+{
+  char fname[SPWM_PATH_MAX];
+  int fd, retv, len = (int) strlen(str);
+
+  spwm_fname(self, of_chip, attr, fname);
+  fd = open(fname, O_WRONLY | O_TRUNC);
+  if (fd < 0) return -1;
+  retv = write(fd, str, len);
+  close(fd);
+  return retv == len ? 0 : -1;
+}
+//-----------------------------------------------------------------------------
+// write number to attribute of channel (return 0 or -1)
+static int spwm_write_num(const spwm_t *self, const char *attr, int64_t val)
+{
+  char str[32];
+  snprintf(str, sizeof(str), "%lld", (long long) val);
+  return spwm_write(self, 0, attr, str);
+}
+//-----------------------------------------------------------------------------
+// read number from attribute (return value or -1)
+static int64_t spwm_read_num(const spwm_t *self, int of_chip,
+                             const char *attr)
+{
+  char fname[SPWM_PATH_MAX], buf[32];
+  int fd, retv;
+
+  spwm_fname(self, of_chip, attr, fname);
+  fd = open(fname, O_RDONLY);
+  if (fd < 0) return -1;
+  retv = read(fd, buf, sizeof(buf) - 1);
+  close(fd);
+  if (retv <= 0) return -1;
+
+  buf[retv] = '\0';
+  return (int64_t) strtoll(buf, NULL, 10);
+}
+//-----------------------------------------------------------------------------
+// open channel: export it if not exported yet and wait `msec` for its
+// directory (return SPWM_ERR_*)
+int spwm_open(spwm_t *self, int chip, int channel, int msec)
+{
+  char fname[SPWM_PATH_MAX], str[16];
+  struct timespec ts = { 0, 1000000 }; // 1 ms
+  int64_t npwm;
+
+  self->chip      = chip;
+  self->channel   = channel;
+  self->exported  = 0;
+  self->enabled   = 0;
+  self->period_ns = 0;
+  self->duty_ns   = 0;
+  self->inversed  = 0;
+
+  spwm_fname(self, 1, "", fname);
+  if (access(fname, F_OK) != 0)
+    return SPWM_ERR_CHIP;
+
+  npwm = spwm_read_num(self, 1, "npwm");
+  if (npwm >= 0 && channel >= npwm)
+    return SPWM_ERR_CHANNEL;
+
+  // already exported channel is used as is
+  spwm_fname(self, 0, "", fname);
+  if (access(fname, F_OK) == 0)
+    return SPWM_ERR_NONE;
+
+  snprintf(str, sizeof(str), "%d", channel);
+  if (spwm_write(self, 1, "export", str) < 0)
+    return SPWM_ERR_EXPORT;
+  self->exported = 1;
+
+  // udev may set attribute permissions a bit later
+  spwm_fname(self, 0, "enable", fname);
+  while (access(fname, W_OK) != 0)
+  {
+    if (msec-- <= 0)
+    {
+      spwm_close(self);
+      return SPWM_ERR_TIMEOUT;
+    }
+    nanosleep(&ts, NULL);
+  }
+
+  return SPWM_ERR_NONE;
+}
+//-----------------------------------------------------------------------------
+// set period, duty cycle and polarity of disabled channel
+// (return SPWM_ERR_*)
+int spwm_config(spwm_t *self, int64_t period_ns, int64_t duty_ns,
+                int inversed)
+{
+  if (period_ns <= 0 || duty_ns < 0 || duty_ns > period_ns)
+    return SPWM_ERR_PERIOD;
+
+  // polarity may be changed only while disabled
+  if (spwm_enable(self, 0) != SPWM_ERR_NONE)
+    return SPWM_ERR_ENABLE;
+
+  // duty cycle never exceeds period: drop it first, set it last
+  spwm_write_num(self, "duty_cycle", 0);
+  if (spwm_write_num(self, "period", period_ns) < 0)
+    return SPWM_ERR_PERIOD;
+  if (spwm_write_num(self, "duty_cycle", duty_ns) < 0)
+    return SPWM_ERR_DUTY;
+
+  // driver without polarity support is fine for normal polarity
+  if (spwm_write(self, 0, "polarity",
+                 inversed ? SPWM_STR_INVERSED : SPWM_STR_NORMAL) < 0 &&
+      inversed)
+    return SPWM_ERR_POLARITY;
+  self->inversed = inversed;
+
+  self->period_ns = spwm_read_num(self, 0, "period");
+  self->duty_ns   = spwm_read_num(self, 0, "duty_cycle");
+  if (self->period_ns <= 0) self->period_ns = period_ns;
+  if (self->duty_ns   <  0) self->duty_ns   = duty_ns;
+
+  return SPWM_ERR_NONE;
+}
+//-----------------------------------------------------------------------------
+// enable (1) or disable (0) output (return SPWM_ERR_*)
+int spwm_enable(spwm_t *self, int on)
+{
+  if (spwm_write(self, 0, "enable", on ? "1" : "0") < 0)
+    return SPWM_ERR_ENABLE;
+  self->enabled = on;
+  return SPWM_ERR_NONE;
+}
+//-----------------------------------------------------------------------------
+// disable output and unexport channel if exported by spwm_open()
+void spwm_close(spwm_t *self)
+{
+  char str[16];
+
+  if (self->enabled)
+    spwm_enable(self, 0);
+
+  if (self->exported)
+  {
+    snprintf(str, sizeof(str), "%d", self->channel);
+    spwm_write(self, 1, "unexport", str);
+    self->exported = 0;
+  }
+}
+//-----------------------------------------------------------------------------
+// error string
+const char *spwm_error_str(int err)
+{
+  static const char *errors[] = {
+    "success",
+    "no PWM chip",
+    "no such PWM channel",
+    "can't export PWM channel",
+    "timeout of waiting PWM channel",
+    "PWM period is not supported",
+    "PWM duty cycle is not supported",
+    "inversed PWM polarity is not supported",
+    "can't enable/disable PWM channel"
+  };
+  return (err <= 0 && err > -9) ? errors[-err] : "unknown error";
+}
+//-----------------------------------------------------------------------------
+/*** end of "spwm.c" file ***/
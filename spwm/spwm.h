@@ -0,0 +1,85 @@
+/*
+ * Hardware PWM channel by Linux sysfs (/sys/class/pwm/pwmchipN/pwmM):
+ * periodic pulses are generated without CPU at all
+ * File: "spwm.h"
+ */
+
+#ifndef SPWM_H
+#define SPWM_H
+//-----------------------------------------------------------------------------
+#include <stdint.h> // `int64_t`
+//-----------------------------------------------------------------------------
+#define SPWM_MAIN_PATH "/sys/class/pwm/"
+// (may be changed at run time by spwm_set_path(), e.g. stand-in test
+// directory with pwmchipN/{export,unexport,npwm} and pwmchipN/pwmM/*)
+
+// default timeout of waiting pwmM directory after export [ms]
+#define SPWM_EXPORT_TIMEOUT 1000
+
+// max path size
+#define SPWM_PATH_MAX 256
+
+// write strings to "polarity" file
+#define SPWM_STR_NORMAL   "normal"
+#define SPWM_STR_INVERSED "inversed"
+
+// error codes
+#define SPWM_ERR_NONE      0 // no error
+#define SPWM_ERR_CHIP     -1 // no pwmchipN directory
+#define SPWM_ERR_CHANNEL  -2 // channel number >= npwm
+#define SPWM_ERR_EXPORT   -3 // can't export channel
+#define SPWM_ERR_TIMEOUT  -4 // timeout of waiting pwmM directory
+#define SPWM_ERR_PERIOD   -5 // period is not supported
+#define SPWM_ERR_DUTY     -6 // duty cycle is not supported
+#define SPWM_ERR_POLARITY -7 // inversed polarity is not supported
+#define SPWM_ERR_ENABLE   -8 // can't enable/disable channel
+//-----------------------------------------------------------------------------
+// `spwm_t` type structure
+typedef struct spwm_ {
+  int chip;          // pwmchipN
+  int channel;       // pwmM
+  int exported;      // 1 if exported by spwm_open()
+  int enabled;       // 1 if enabled by spwm_enable()
+  int64_t period_ns; // period read back after spwm_config() [ns]
+  int64_t duty_ns;   // duty cycle read back after spwm_config() [ns]
+  int inversed;      // 1 if polarity is inversed
+} spwm_t;
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+// set base path instead of SPWM_MAIN_PATH (e.g. stand-in test directory)
+void spwm_set_path(const char *path);
+//-----------------------------------------------------------------------------
+// get base path ("/sys/class/pwm/" by default)
+const char *spwm_path();
+//-----------------------------------------------------------------------------
+// open channel: export it if not exported yet and wait `msec` for its
+// directory (return SPWM_ERR_*)
+int spwm_open(spwm_t *self, int chip, int channel, int msec);
+//-----------------------------------------------------------------------------
+// set period, duty cycle (high time for normal polarity) and polarity
+// of disabled channel; driver may refuse (SPWM_ERR_PERIOD...) or round
+// values, applied ones are read back to `period_ns` and `duty_ns`
+// (return SPWM_ERR_*)
+int spwm_config(spwm_t *self, int64_t period_ns, int64_t duty_ns,
+                int inversed);
+//-----------------------------------------------------------------------------
+// enable (1) or disable (0) output (return SPWM_ERR_*)
+int spwm_enable(spwm_t *self, int on);
+//-----------------------------------------------------------------------------
+// disable output and unexport channel if exported by spwm_open()
+void spwm_close(spwm_t *self);
+//-----------------------------------------------------------------------------
+// error string
+const char *spwm_error_str(int err);
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+#endif // SPWM_H
+
+/*** end of "spwm.h" file ***/
@@ -0,0 +1,143 @@
+/*
+ * PM QoS wake-up latency requests: /dev/cpu_dma_latency (global, held
+ * while file is open) and per-CPU resume latency limits (sysfs)
+ * File: "sqos.c"
+ */
+//-----------------------------------------------------------------------------
+#include "sqos.h"   // `sqos_t`
+#include <stdio.h>  // snprintf()
+#include <string.h> // memset(), strlen(), strcspn()
+#include <time.h>   // clock_gettime(), clock_nanosleep()
+#include <fcntl.h>  // open(), O_RDWR
+#include <unistd.h> // read(), write(), close()
+//-----------------------------------------------------------------------------
+// read sysfs value to `buf` without trailing '\n' (return 0 or -1)
+static int sqos_read(const char *fname, char *buf, int size)
+{
+  int fd = open(fname, O_RDONLY), retv;
+
+  if (fd < 0) return -1;
+  retv = read(fd, buf, size - 1);
+  close(fd);
+  if (retv <= 0) return -1;
+
+  buf[retv] = '\0';
+  buf[strcspn(buf, "\n")] = '\0';
+  return 0;
+}
+//-----------------------------------------------------------------------------
+// write string to sysfs file (return 0 or -1)
+static int sqos_write(const char *fname, const char *str)
+{
+  int fd = open(fname, O_WRONLY), retv, len = (int) strlen(str);
+
+  if (fd < 0) return -1;
+  retv = write(fd, str, len);
+  close(fd);
+  return retv == len ? 0 : -1;
+}
+//-----------------------------------------------------------------------------
+// hold `latency_us` request while running (return SQOS_ERR_*)
+int sqos_hold(sqos_t *self, int32_t latency_us, int cpus, const int *cpu)
+{
+  char fname[128], val[SQOS_VALUE_MAX];
+  int i, err = SQOS_ERR_NONE;
+
+  memset((void*) self, 0, sizeof(sqos_t));
+  self->fd         = -1;
+  self->latency_us = latency_us;
+  self->was_us     = -1;
+  self->cpus       = cpus > SQOS_CPUS_MAX ? SQOS_CPUS_MAX : cpus;
+
+  // global request: kept while file is open, dropped by kernel on close
+  // (also if process is killed)
+  self->fd = open(SQOS_DMA_LATENCY, O_RDWR | O_CLOEXEC);
+  if (self->fd >= 0)
+  {
+    if (read(self->fd, &self->was_us, sizeof(int32_t)) != sizeof(int32_t))
+      self->was_us = -1;
+    if (write(self->fd, &latency_us, sizeof(int32_t)) != sizeof(int32_t))
+    {
+      close(self->fd);
+      self->fd = -1;
+    }
+  }
+  if (self->fd < 0)
+    err = SQOS_ERR_DMA;
+
+  // per-CPU limits: "n/a" means no resume latency at all
+  if (latency_us > 0)
+    snprintf(val, sizeof(val), "%d", (int) latency_us);
+  else
+    snprintf(val, sizeof(val), "n/a");
+
+  for (i = 0; i < self->cpus; i++)
+  {
+    self->cpu[i] = cpu[i];
+    snprintf(fname, sizeof(fname), SQOS_RESUME_LATENCY, cpu[i]);
+    if (sqos_read(fname, self->old[i], SQOS_VALUE_MAX) < 0 ||
+        sqos_write(fname, val) < 0)
+    {
+      self->old[i][0] = '\0';
+      if (err == SQOS_ERR_NONE) err = SQOS_ERR_CPU;
+      continue;
+    }
+    self->set++;
+  }
+
+  return err;
+}
+//-----------------------------------------------------------------------------
+// release request and restore saved per-CPU limits
+void sqos_release(sqos_t *self)
+{
+  char fname[128];
+  int i;
+
+  for (i = 0; i < self->cpus; i++)
+  {
+    if (self->old[i][0] == '\0') continue;
+    snprintf(fname, sizeof(fname), SQOS_RESUME_LATENCY, self->cpu[i]);
+    sqos_write(fname, self->old[i]);
+    self->old[i][0] = '\0';
+  }
+
+  if (self->fd >= 0) close(self->fd);
+  self->fd = -1;
+}
+//-----------------------------------------------------------------------------
+// measure wake-up latency of `n` absolute sleeps with `period_ns` [ns]
+void sqos_probe(sstat_t *stat, int n, int64_t period_ns)
+{
+  struct timespec ts, now;
+  int64_t t, late;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  t = ((int64_t) ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+
+  while (n-- > 0)
+  {
+    t += period_ns;
+    ts.tv_sec  = (time_t) (t / 1000000000LL);
+    ts.tv_nsec = (long)   (t % 1000000000LL);
+    if (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0)
+      break; // interrupted (SIGINT?)
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    late = ((int64_t) now.tv_sec) * 1000000000LL + now.tv_nsec - t;
+    sstat_add(stat, late);
+  }
+}
+//-----------------------------------------------------------------------------
+// error string
+const char *sqos_error_str(int err)
+{
+  static const char *errors[] = {
+    "success",
+    "can't hold " SQOS_DMA_LATENCY,
+    "can't set resume latency of CPU"
+  };
+  return (err <= 0 && err > -3) ? errors[-err] : "unknown error";
+}
+//-----------------------------------------------------------------------------
+/*** end of "sqos.c" file ***/
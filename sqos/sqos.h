@@ -0,0 +1,68 @@
+/*
+ * PM QoS wake-up latency requests: /dev/cpu_dma_latency (global, held
+ * while file is open) and per-CPU resume latency limits (sysfs)
+ * File: "sqos.h"
+ */
+
+#ifndef SQOS_H
+#define SQOS_H
+//-----------------------------------------------------------------------------
+#include <stdint.h> // `int32_t`, `int64_t`
+#include "sstat.h"  // `sstat_t`
+//-----------------------------------------------------------------------------
+// global CPU latency request (binary int32 in us)
+#define SQOS_DMA_LATENCY "/dev/cpu_dma_latency"
+
+// per-CPU resume latency limit ("n/a" - no latency, "0" - any)
+#define SQOS_RESUME_LATENCY \
+  "/sys/devices/system/cpu/cpu%d/power/pm_qos_resume_latency_us"
+
+// max number of CPUs with resume latency limit
+#define SQOS_CPUS_MAX 64
+
+// max length of saved sysfs value
+#define SQOS_VALUE_MAX 16
+
+// error codes
+#define SQOS_ERR_NONE  0 // no error
+#define SQOS_ERR_DMA  -1 // can't hold /dev/cpu_dma_latency (root?)
+#define SQOS_ERR_CPU  -2 // can't set resume latency of some CPU
+//-----------------------------------------------------------------------------
+// `sqos_t` type structure
+typedef struct sqos_ {
+  int fd;                  // /dev/cpu_dma_latency (-1 - not held)
+  int32_t latency_us;      // requested latency [us]
+  int32_t was_us;          // effective latency before request [us] (-1)
+  int cpus;                // number of per-CPU limits
+  int cpu[SQOS_CPUS_MAX];  // CPU numbers
+  char old[SQOS_CPUS_MAX][SQOS_VALUE_MAX]; // values to restore ("" - not set)
+  int set;                 // number of CPUs with limit set by sqos_hold()
+} sqos_t;
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+// hold `latency_us` request while running: global and (if `cpus` > 0)
+// resume latency limit of listed CPUs; what can't be set is skipped
+// (return SQOS_ERR_NONE or first error, e.g. not privileged)
+int sqos_hold(sqos_t *self, int32_t latency_us, int cpus, const int *cpu);
+//-----------------------------------------------------------------------------
+// release request and restore saved per-CPU limits
+void sqos_release(sqos_t *self);
+//-----------------------------------------------------------------------------
+// measure wake-up latency of `n` absolute sleeps with `period_ns`
+// (CLOCK_MONOTONIC) to `stat` [ns], e.g. before and after sqos_hold()
+void sqos_probe(sstat_t *stat, int n, int64_t period_ns);
+//-----------------------------------------------------------------------------
+// error string
+const char *sqos_error_str(int err);
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+#endif // SQOS_H
+
+/*** end of "sqos.h" file ***/
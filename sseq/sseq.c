@@ -0,0 +1,486 @@
+/*
+ * Simple pulse sequence script compiled to bytecode
+ * File: "sseq.c"
+ */
+//-----------------------------------------------------------------------------
+#include "sseq.h"   // `sseq_t`
+#include "swave.h"  // swave_parse_time()
+#include <stdlib.h> // malloc(), realloc(), free(), strtoul()
+#include <string.h> // strcmp(), strncmp(), memset()
+//-----------------------------------------------------------------------------
+// open block
+typedef struct sseq_block_ {
+  int type;       // SSEQ_OP_LOOP (repeat), SSEQ_OP_JMP (loop),
+                  // SSEQ_OP_JIN (if), SSEQ_OP_END (else)
+  unsigned start; // first operation of block
+  unsigned patch; // operation to patch at end of block
+} sseq_block_t;
+//-----------------------------------------------------------------------------
+// compiler state
+typedef struct sseq_compiler_ {
+  sseq_t *self;
+  unsigned size;  // allocated operations
+  unsigned line;  // current line
+  int depth;      // number of open blocks
+  sseq_block_t blocks[SSEQ_DEPTH_MAX];
+} sseq_compiler_t;
+//-----------------------------------------------------------------------------
+// append operation (return its index or SSEQ_ERR_*)
+static int sseq_emit(sseq_compiler_t *c, int op, uint32_t arg, int64_t ns)
+{
+  sseq_t *self = c->self;
+  sseq_op_t *o;
+
+  if (self->count >= SSEQ_OPS_MAX)
+    return SSEQ_ERR_SIZE;
+
+  if (self->count == c->size)
+  {
+    unsigned size = c->size ? c->size * 2 : 64;
+    sseq_op_t *ops = (sseq_op_t*) realloc(self->ops, sizeof(sseq_op_t) * size);
+    if (ops == (sseq_op_t*) NULL) return SSEQ_ERR_ALLOC;
+    self->ops = ops;
+    c->size   = size;
+  }
+
+  o = self->ops + self->count;
+  memset((void*) o, 0, sizeof(sseq_op_t));
+  o->op   = (uint16_t) op;
+  o->arg  = arg;
+  o->ns   = ns;
+  o->line = c->line;
+  return (int) self->count++;
+}
+//-----------------------------------------------------------------------------
+// get next word of line (return NULL if none)
+static const char *sseq_word(const char **p, char *word)
+{
+  int i = 0;
+
+  while (**p == ' ' || **p == '\t') (*p)++;
+  if (**p == '\0') return NULL;
+
+  while (**p && **p != ' ' && **p != '\t' && i < SSEQ_LINE_MAX - 1)
+    word[i++] = *(*p)++;
+  word[i] = '\0';
+  return word;
+}
+//-----------------------------------------------------------------------------
+// parse MASK word: 0, 1 (all outputs) or 0xMASK
+static int sseq_mask(const char *word, uint32_t *mask)
+{
+  char *end;
+  unsigned long v;
+
+  if (word == NULL) return SSEQ_ERR_SYNTAX;
+  if (!strcmp(word, "0")) { *mask = 0;           return SSEQ_ERR_NONE; }
+  if (!strcmp(word, "1")) { *mask = 0xFFFFFFFFU; return SSEQ_ERR_NONE; }
+  if (strncmp(word, "0x", 2) && strncmp(word, "0X", 2))
+    return SSEQ_ERR_SYNTAX;
+
+  v = strtoul(word + 2, &end, 16);
+  if (end == word + 2 || *end) return SSEQ_ERR_SYNTAX;
+  *mask = (uint32_t) v;
+  return SSEQ_ERR_NONE;
+}
+//-----------------------------------------------------------------------------
+// parse TIME word (return SSEQ_ERR_*)
+static int sseq_time(const char *word, int64_t *ns)
+{
+  if (word == NULL) return SSEQ_ERR_SYNTAX;
+  if (swave_parse_time(&word, ns) != SWAVE_ERR_NONE || *word)
+    return SSEQ_ERR_SYNTAX;
+  return SSEQ_ERR_NONE;
+}
+//-----------------------------------------------------------------------------
+// parse unsigned integer word
+static int sseq_uint(const char *word, uint32_t *val)
+{
+  char *end;
+  if (word == NULL) return SSEQ_ERR_SYNTAX;
+  *val = (uint32_t) strtoul(word, &end, 10);
+  return (end == word || *end) ? SSEQ_ERR_SYNTAX : SSEQ_ERR_NONE;
+}
+//-----------------------------------------------------------------------------
+// parse "in 0|1" words
+static int sseq_in(const char **p, char *word, uint16_t *val)
+{
+  if (sseq_word(p, word) == NULL || strcmp(word, "in")) return SSEQ_ERR_SYNTAX;
+  if (sseq_word(p, word) == NULL) return SSEQ_ERR_SYNTAX;
+  if      (!strcmp(word, "0")) *val = 0;
+  else if (!strcmp(word, "1")) *val = 1;
+  else return SSEQ_ERR_SYNTAX;
+  return SSEQ_ERR_NONE;
+}
+//-----------------------------------------------------------------------------
+// open block (return SSEQ_ERR_*)
+static int sseq_open(sseq_compiler_t *c, int type, unsigned patch)
+{
+  sseq_block_t *b;
+
+  if (c->depth >= SSEQ_DEPTH_MAX) return SSEQ_ERR_BLOCK;
+  b = c->blocks + c->depth++;
+  b->type  = type;
+  b->start = c->self->count;
+  b->patch = patch;
+  return SSEQ_ERR_NONE;
+}
+//-----------------------------------------------------------------------------
+// close block (return SSEQ_ERR_*)
+static int sseq_close(sseq_compiler_t *c)
+{
+  sseq_t *self = c->self;
+  sseq_block_t *b;
+  int i;
+
+  if (c->depth == 0) return SSEQ_ERR_BLOCK;
+  b = c->blocks + --c->depth;
+
+  if (b->type == SSEQ_OP_LOOP)
+  { // repeat N { ... }: NEXT jumps to body, LOOP 0 jumps after NEXT
+    i = sseq_emit(c, SSEQ_OP_NEXT, 0, 0);
+    if (i < 0) return i;
+    self->ops[i].target       = b->start;
+    self->ops[b->patch].target = self->count;
+  }
+  else if (b->type == SSEQ_OP_JMP)
+  { // loop { ... }
+    i = sseq_emit(c, SSEQ_OP_JMP, 0, 0);
+    if (i < 0) return i;
+    self->ops[i].target = b->start;
+  }
+  else // if / else: skip to end of block
+    self->ops[b->patch].target = self->count;
+
+  return SSEQ_ERR_NONE;
+}
+//-----------------------------------------------------------------------------
+// compile one line (return SSEQ_ERR_*)
+static int sseq_line(sseq_compiler_t *c, const char *p)
+{
+  char word[SSEQ_LINE_MAX], cmd[SSEQ_LINE_MAX];
+  uint32_t mask, n;
+  int64_t ns, ns2;
+  uint16_t val;
+  int retv, i, op;
+
+  if (sseq_word(&p, cmd) == NULL)
+    return SSEQ_ERR_NONE; // empty line
+
+  if (!strcmp(cmd, "out") || !strcmp(cmd, "set") || !strcmp(cmd, "clr"))
+  { // out|set|clr MASK [TIME]
+    op = cmd[0] == 'o' ? SSEQ_OP_OUT : cmd[0] == 's' ? SSEQ_OP_SET :
+                                                       SSEQ_OP_CLR;
+    retv = sseq_mask(sseq_word(&p, word), &mask);
+    if (retv != SSEQ_ERR_NONE) return retv;
+    ns = 0;
+    if (sseq_word(&p, word) != NULL)
+    {
+      retv = sseq_time(word, &ns);
+      if (retv != SSEQ_ERR_NONE) return retv;
+    }
+    retv = sseq_emit(c, op, mask, ns);
+  }
+  else if (!strcmp(cmd, "wait"))
+  { // wait TIME
+    retv = sseq_time(sseq_word(&p, word), &ns);
+    if (retv != SSEQ_ERR_NONE) return retv;
+    retv = sseq_emit(c, SSEQ_OP_WAIT, 0, ns);
+  }
+  else if (!strcmp(cmd, "burst"))
+  { // burst N HIGH LOW [MASK] -> repeat N { set MASK HIGH; clr MASK LOW }
+    if ((retv = sseq_uint(sseq_word(&p, word), &n))   != SSEQ_ERR_NONE ||
+        (retv = sseq_time(sseq_word(&p, word), &ns))  != SSEQ_ERR_NONE ||
+        (retv = sseq_time(sseq_word(&p, word), &ns2)) != SSEQ_ERR_NONE)
+      return retv;
+    mask = 0xFFFFFFFFU;
+    if (sseq_word(&p, word) != NULL &&
+        (retv = sseq_mask(word, &mask)) != SSEQ_ERR_NONE)
+      return retv;
+
+    i = sseq_emit(c, SSEQ_OP_LOOP, n, 0);
+    if (i < 0) return i;
+    if ((retv = sseq_open(c, SSEQ_OP_LOOP, i)) != SSEQ_ERR_NONE ||
+        (retv = sseq_emit(c, SSEQ_OP_SET, mask, ns))  < 0 ||
+        (retv = sseq_emit(c, SSEQ_OP_CLR, mask, ns2)) < 0)
+      return retv;
+    retv = sseq_close(c);
+  }
+  else if (!strcmp(cmd, "repeat"))
+  { // repeat N {
+    retv = sseq_uint(sseq_word(&p, word), &n);
+    if (retv != SSEQ_ERR_NONE) return retv;
+    if (sseq_word(&p, word) == NULL || strcmp(word, "{"))
+      return SSEQ_ERR_SYNTAX;
+    i = sseq_emit(c, SSEQ_OP_LOOP, n, 0);
+    if (i < 0) return i;
+    retv = sseq_open(c, SSEQ_OP_LOOP, i);
+  }
+  else if (!strcmp(cmd, "loop"))
+  { // loop {
+    if (sseq_word(&p, word) == NULL || strcmp(word, "{"))
+      return SSEQ_ERR_SYNTAX;
+    retv = sseq_open(c, SSEQ_OP_JMP, 0);
+  }
+  else if (!strcmp(cmd, "if"))
+  { // if in V { -> JIN !V else_or_end
+    retv = sseq_in(&p, word, &val);
+    if (retv != SSEQ_ERR_NONE) return retv;
+    if (sseq_word(&p, word) == NULL || strcmp(word, "{"))
+      return SSEQ_ERR_SYNTAX;
+    i = sseq_emit(c, SSEQ_OP_JIN, 0, 0);
+    if (i < 0) return i;
+    c->self->ops[i].val = !val;
+    retv = sseq_open(c, SSEQ_OP_JIN, i);
+  }
+  else if (!strcmp(cmd, "}"))
+  { // } or } else {
+    if (sseq_word(&p, word) == NULL)
+      retv = sseq_close(c);
+    else if (!strcmp(word, "else") &&
+             sseq_word(&p, word) != NULL && !strcmp(word, "{") &&
+             c->depth && c->blocks[c->depth - 1].type == SSEQ_OP_JIN)
+    { // end of "if" block jumps over "else" block
+      sseq_block_t *b = c->blocks + c->depth - 1;
+      i = sseq_emit(c, SSEQ_OP_JMP, 0, 0);
+      if (i < 0) return i;
+      c->self->ops[b->patch].target = c->self->count;
+      b->type  = SSEQ_OP_END;
+      b->patch = i;
+      retv = SSEQ_ERR_NONE;
+    }
+    else
+      return SSEQ_ERR_SYNTAX;
+  }
+  else if (!strcmp(cmd, "until"))
+  { // until in V TIME
+    retv = sseq_in(&p, word, &val);
+    if (retv != SSEQ_ERR_NONE) return retv;
+    retv = sseq_time(sseq_word(&p, word), &ns);
+    if (retv != SSEQ_ERR_NONE) return retv;
+    i = sseq_emit(c, SSEQ_OP_UNTIL, 0, ns);
+    if (i < 0) return i;
+    c->self->ops[i].val = val;
+    retv = i;
+  }
+  else if (!strcmp(cmd, "end"))
+    retv = sseq_emit(c, SSEQ_OP_END, 0, 0);
+  else
+    return SSEQ_ERR_SYNTAX;
+
+  if (retv < 0) return retv;
+  return sseq_word(&p, word) == NULL ? SSEQ_ERR_NONE : SSEQ_ERR_SYNTAX;
+}
+//-----------------------------------------------------------------------------
+// compile script text (return SSEQ_ERR_*, `*line` - line of error)
+int sseq_compile(sseq_t *self, const char *text, unsigned *line)
+{
+  sseq_compiler_t c;
+  char buf[SSEQ_LINE_MAX];
+  const char *p = text;
+  int i, retv = SSEQ_ERR_NONE;
+
+  memset((void*) self, 0, sizeof(sseq_t));
+  c.self  = self;
+  c.size  = 0;
+  c.line  = 0;
+  c.depth = 0;
+
+  while (*p && retv == SSEQ_ERR_NONE)
+  {
+    // copy line without comment
+    c.line++;
+    for (i = 0; *p && *p != '\n'; p++)
+    {
+      if (*p == '#') while (p[1] && p[1] != '\n') p++;
+      else if (i < SSEQ_LINE_MAX - 1) buf[i++] = *p == '\r' ? ' ' : *p;
+    }
+    buf[i] = '\0';
+    if (*p == '\n') p++;
+
+    retv = sseq_line(&c, buf);
+  }
+
+  if (retv == SSEQ_ERR_NONE && c.depth)
+    retv = SSEQ_ERR_BLOCK;
+  if (retv == SSEQ_ERR_NONE)
+  { // implicit end
+    c.line++;
+    i = sseq_emit(&c, SSEQ_OP_END, 0, 0);
+    if (i < 0) retv = i;
+  }
+
+  if (line) *line = c.line;
+  if (retv != SSEQ_ERR_NONE)
+    sseq_free(self);
+  return retv;
+}
+//-----------------------------------------------------------------------------
+// read and compile script file ("-" for stdin)
+int sseq_load(sseq_t *self, const char *fname, unsigned *line)
+{
+  FILE *f = strcmp(fname, "-") ? fopen(fname, "r") : stdin;
+  char *text = (char*) NULL, *ptr;
+  size_t size = 0, len = 0;
+  int retv;
+
+  if (line) *line = 0;
+  memset((void*) self, 0, sizeof(sseq_t));
+  if (f == (FILE*) NULL) return SSEQ_ERR_FILE;
+
+  do
+  {
+    if (len + SSEQ_LINE_MAX + 1 > size)
+    {
+      size = size ? size * 2 : 4096;
+      ptr = (char*) realloc(text, size);
+      if (ptr == (char*) NULL)
+      {
+        free(text);
+        if (f != stdin) fclose(f);
+        return SSEQ_ERR_ALLOC;
+      }
+      text = ptr;
+    }
+    len += fread(text + len, 1, SSEQ_LINE_MAX, f);
+  } while (!feof(f) && !ferror(f));
+
+  retv = ferror(f) ? SSEQ_ERR_FILE : SSEQ_ERR_NONE;
+  if (f != stdin) fclose(f);
+  text[len] = '\0';
+
+  if (retv == SSEQ_ERR_NONE)
+    retv = sseq_compile(self, text, line);
+  free(text);
+  return retv;
+}
+//-----------------------------------------------------------------------------
+// set input reader for "if in" and "until in" (input is 0 if not set)
+void sseq_input(sseq_t *self, int (*fn)(void *context), void *context)
+{
+  self->input   = fn;
+  self->context = context;
+}
+//-----------------------------------------------------------------------------
+// restart program
+void sseq_reset(sseq_t *self)
+{
+  self->pc     = 0;
+  self->sp     = 0;
+  self->levels = 0;
+}
+//-----------------------------------------------------------------------------
+// read input (0 if reader is not set)
+static inline int sseq_read(sseq_t *self)
+{
+  return self->input ? self->input(self->context) : 0;
+}
+//-----------------------------------------------------------------------------
+// run program up to next wait, update `levels`
+// (return time to next step [ns], 0 on end or SSEQ_ERR_STEPS)
+int64_t sseq_step(sseq_t *self)
+{
+  const sseq_op_t *op;
+  int n;
+
+  for (n = 0; n < SSEQ_STEPS_MAX; n++)
+  {
+    op = self->ops + self->pc;
+    switch (op->op)
+    {
+    case SSEQ_OP_OUT:  self->levels  =  op->arg; break;
+    case SSEQ_OP_SET:  self->levels |=  op->arg; break;
+    case SSEQ_OP_CLR:  self->levels &= ~op->arg; break;
+    case SSEQ_OP_WAIT: break;
+
+    case SSEQ_OP_LOOP:
+      if (op->arg == 0)
+      { // skip block
+        self->pc = op->target;
+        continue;
+      }
+      self->stack[self->sp++] = op->arg;
+      self->pc++;
+      continue;
+
+    case SSEQ_OP_NEXT:
+      if (--self->stack[self->sp - 1])
+      {
+        self->pc = op->target;
+        continue;
+      }
+      self->sp--;
+      self->pc++;
+      continue;
+
+    case SSEQ_OP_JMP:
+      self->pc = op->target;
+      continue;
+
+    case SSEQ_OP_JIN:
+      self->pc = sseq_read(self) == op->val ? op->target : self->pc + 1;
+      continue;
+
+    case SSEQ_OP_UNTIL:
+      if (sseq_read(self) != op->val)
+        return op->ns; // poll again later
+      self->pc++;
+      continue;
+
+    default: // SSEQ_OP_END
+      return 0;
+    }
+
+    // output/wait operations
+    self->pc++;
+    if (op->ns > 0)
+      return op->ns;
+  }
+
+  return SSEQ_ERR_STEPS;
+}
+//-----------------------------------------------------------------------------
+// print bytecode listing
+void sseq_dump(const sseq_t *self, FILE *stream)
+{
+  static const char *names[] = {
+    "end", "out", "set", "clr", "wait", "loop", "next", "jmp", "jin", "until"
+  };
+  const sseq_op_t *op;
+  unsigned i;
+
+  for (i = 0; i < self->count; i++)
+  {
+    op = self->ops + i;
+    fprintf(stream, "%5u: %-5s arg=0x%08X val=%u target=%-5u ns=%-10lld"
+                    " # line %u\n",
+            i, op->op <= SSEQ_OP_UNTIL ? names[op->op] : "?",
+            op->arg, op->val, op->target, (long long) op->ns, op->line);
+  }
+}
+//-----------------------------------------------------------------------------
+// error string
+const char *sseq_error_str(int err)
+{
+  static const char *errors[] = {
+    "success",
+    "bad statement",
+    "unbalanced { } or too deep nesting",
+    "too many operations",
+    "can't allocate memory",
+    "can't read file",
+    "too many operations without wait"
+  };
+  return (err <= 0 && err > -7) ? errors[-err] : "unknown error";
+}
+//-----------------------------------------------------------------------------
+// free program
+void sseq_free(sseq_t *self)
+{
+  free((void*) self->ops);
+  self->ops   = (sseq_op_t*) NULL;
+  self->count = 0;
+  sseq_reset(self);
+}
+//-----------------------------------------------------------------------------
+/*** end of "sseq.c" file ***/
@@ -0,0 +1,122 @@
+/*
+ * Simple pulse sequence script compiled to bytecode
+ * File: "sseq.h"
+ */
+
+#ifndef SSEQ_H
+#define SSEQ_H
+//-----------------------------------------------------------------------------
+#include <stdint.h> // `int64_t`, `uint32_t`, `uint16_t`
+#include <stdio.h>  // `FILE`
+//-----------------------------------------------------------------------------
+// Script is one statement per line ('#' - comment), TIME as in "swave.h"
+// (ns|us|ms|s, us by default), MASK is 0, 1 (all outputs) or 0xMASK
+// (bit i - i-th output):
+//   out MASK [TIME]        - set outputs to MASK, hold TIME
+//   set MASK [TIME]        - set outputs of MASK high, hold TIME
+//   clr MASK [TIME]        - set outputs of MASK low, hold TIME
+//   wait TIME              - hold outputs
+//   burst N HIGH LOW [MASK] - N pulses: MASK high for HIGH, low for LOW
+//   repeat N {             - repeat block N times (nesting < SSEQ_DEPTH_MAX)
+//   loop {                 - repeat block forever
+//   if in 0|1 {            - run block if input equals value
+//   } else {
+//   }                      - end of block
+//   until in 0|1 TIME      - wait input value, poll every TIME
+//   end                    - stop (also at end of script)
+//-----------------------------------------------------------------------------
+// max number of operations
+#define SSEQ_OPS_MAX 65536
+
+// max nesting of blocks
+#define SSEQ_DEPTH_MAX 16
+
+// max operations without wait per step (endless loop guard)
+#define SSEQ_STEPS_MAX 1024
+
+// max line length
+#define SSEQ_LINE_MAX 256
+
+// error codes
+#define SSEQ_ERR_NONE    0 // no error
+#define SSEQ_ERR_SYNTAX -1 // bad statement
+#define SSEQ_ERR_BLOCK  -2 // unbalanced { } or too deep nesting
+#define SSEQ_ERR_SIZE   -3 // too many operations
+#define SSEQ_ERR_ALLOC  -4 // can't allocate memory
+#define SSEQ_ERR_FILE   -5 // can't read file
+#define SSEQ_ERR_STEPS  -6 // too many operations without wait (run time)
+//-----------------------------------------------------------------------------
+// operation codes
+typedef enum {
+  SSEQ_OP_END = 0, // stop
+  SSEQ_OP_OUT,     // levels = arg, hold ns
+  SSEQ_OP_SET,     // levels |= arg, hold ns
+  SSEQ_OP_CLR,     // levels &= ~arg, hold ns
+  SSEQ_OP_WAIT,    // hold ns
+  SSEQ_OP_LOOP,    // push counter arg (jump to target if arg == 0)
+  SSEQ_OP_NEXT,    // decrement counter, jump to target if not zero
+  SSEQ_OP_JMP,     // jump to target
+  SSEQ_OP_JIN,     // jump to target if input == val
+  SSEQ_OP_UNTIL    // wait ns and repeat until input == val
+} sseq_opcode_t;
+//-----------------------------------------------------------------------------
+// operation (24 bytes)
+typedef struct sseq_op_ {
+  uint16_t op;       // SSEQ_OP_*
+  uint16_t val;      // input value (JIN, UNTIL)
+  uint32_t arg;      // output mask (OUT, SET, CLR) or counter (LOOP)
+  uint32_t target;   // jump address
+  uint32_t line;     // script line (diagnostics)
+  int64_t  ns;       // hold time [ns] (0 - don't wait)
+} sseq_op_t;
+//-----------------------------------------------------------------------------
+// `sseq_t` type structure (program and its run time state)
+typedef struct sseq_ {
+  sseq_op_t *ops;   // bytecode
+  unsigned count;   // number of operations
+  unsigned pc;      // program counter
+  int sp;           // loop counters stack pointer
+  uint32_t stack[SSEQ_DEPTH_MAX];
+  uint32_t levels;  // output levels
+  int (*input)(void *context); // read input (0|1 or <0 on error)
+  void *context;
+} sseq_t;
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+// compile script text (return SSEQ_ERR_*, `*line` - line of error)
+int sseq_compile(sseq_t *self, const char *text, unsigned *line);
+//-----------------------------------------------------------------------------
+// read and compile script file ("-" for stdin)
+int sseq_load(sseq_t *self, const char *fname, unsigned *line);
+//-----------------------------------------------------------------------------
+// set input reader for "if in" and "until in" (input is 0 if not set)
+void sseq_input(sseq_t *self, int (*fn)(void *context), void *context);
+//-----------------------------------------------------------------------------
+// restart program
+void sseq_reset(sseq_t *self);
+//-----------------------------------------------------------------------------
+// run program up to next wait, update `levels`
+// (return time to next step [ns], 0 on end or SSEQ_ERR_STEPS)
+int64_t sseq_step(sseq_t *self);
+//-----------------------------------------------------------------------------
+// print bytecode listing
+void sseq_dump(const sseq_t *self, FILE *stream);
+//-----------------------------------------------------------------------------
+// error string
+const char *sseq_error_str(int err);
+//-----------------------------------------------------------------------------
+// free program
+void sseq_free(sseq_t *self);
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+#endif // SSEQ_H
+
+/*** end of "sseq.h" file ***/
+
@@ -0,0 +1,382 @@
+/*
+ * Bit-banged shift register output (74HC595 style): byte streams are
+ * clocked out over data/clock/latch pins by the fastest write path:
+ * GPIO character device (data and clock changes in one ioctl), sysfs
+ * writes linked in io_uring (one syscall per ring) or plain sgpio_set()
+ * File: "sshift.c"
+ */
+//-----------------------------------------------------------------------------
+#include "sshift.h"      // `sshift_t`
+#include <stdio.h>       // snprintf()
+#include <stdlib.h>      // strtol()
+#include <string.h>      // strncmp(), strcmp()
+#include <errno.h>       // errno, EINTR
+#include <time.h>        // clock_gettime()
+#include <dirent.h>      // opendir(), readdir(), closedir()
+#include <sys/ioctl.h>   // ioctl()
+#include <linux/gpio.h>  // GPIO_V2_*, `struct gpio_v2_line_request`
+//-----------------------------------------------------------------------------
+// CLOCK_MONOTONIC time [ns]
+static inline int64_t sshift_time_ns()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((int64_t) ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+//-----------------------------------------------------------------------------
+// busy wait `ns` (too short for any sleep)
+static inline void sshift_wait(int64_t ns)
+{
+  int64_t end;
+  if (ns <= 0) return;
+  end = sshift_time_ns() + ns;
+  while (sshift_time_ns() < end);
+}
+//-----------------------------------------------------------------------------
+// "constructor" (write path, MSB first, no waits)
+void sshift_init(sshift_t *self)
+{
+  self->path     = SSHIFT_PATH_WRITE;
+  self->order    = SSHIFT_MSB_FIRST;
+  self->setup_ns = 0;
+  self->high_ns  = 0;
+  self->pin      = (sgpio_t*) NULL;
+  self->fd       = -1;
+  self->chip     = -1;
+  self->ring.fd  = -1;
+  self->levels   = 0;
+  self->bits     = 0;
+  self->streams  = 0;
+  self->calls    = 0;
+  self->time_ns  = 0;
+}
+//-----------------------------------------------------------------------------
+// read attribute `name` of sysfs gpiochipBASE directory (return 0 or -1)
+static int sshift_read_attr(const char *dir, const char *name, char *buf,
+                            int size)
+{
+  char fname[SGPIO_PATH_MAX];
+  int fd, retv;
+
+  snprintf(fname, sizeof(fname), "%s%s/%s", sgpio_path(), dir, name);
+  fd = open(fname, O_RDONLY);
+  if (fd < 0) return -1;
+  retv = read(fd, buf, size - 1);
+  close(fd);
+  if (retv <= 0) return -1;
+
+  // strip line feed
+  while (retv && (buf[retv - 1] == '\n' || buf[retv - 1] == '\r')) retv--;
+  buf[retv] = '\0';
+  return 0;
+}
+//-----------------------------------------------------------------------------
+// find character device of sysfs GPIO `num`: sysfs gpiochipBASE with
+// BASE <= num < BASE + ngpio, then device with same label and number of
+// lines (return chip index or -1)
+static int sshift_find_chip(int num, unsigned *offset)
+{
+  struct gpiochip_info info;
+  char label[sizeof(info.label)], str[SGPIO_STR_MAX], fname[32];
+  struct dirent *ent;
+  DIR *dir;
+  int base = -1, ngpio = 0, i, fd;
+
+  dir = opendir(sgpio_path());
+  if (dir == (DIR*) NULL) return -1;
+
+  while ((ent = readdir(dir)) != (struct dirent*) NULL)
+  {
+    if (strncmp(ent->d_name, "gpiochip", 8)) continue;
+    if (sshift_read_attr(ent->d_name, "base",  str, sizeof(str)) < 0) continue;
+    base = (int) strtol(str, NULL, 10);
+    if (sshift_read_attr(ent->d_name, "ngpio", str, sizeof(str)) < 0) continue;
+    ngpio = (int) strtol(str, NULL, 10);
+    if (num >= base && num < base + ngpio &&
+        sshift_read_attr(ent->d_name, "label", label, sizeof(label)) == 0)
+      break;
+  }
+  closedir(dir);
+  if (ent == (struct dirent*) NULL) return -1;
+
+  for (i = 0; i < SSHIFT_CHIPS_MAX; i++)
+  {
+    snprintf(fname, sizeof(fname), SSHIFT_DEV_PATH, i);
+    fd = open(fname, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) continue;
+    if (ioctl(fd, GPIO_GET_CHIPINFO_IOCTL, &info) == 0 &&
+        info.lines == (unsigned) ngpio &&
+        !strncmp(info.label, label, sizeof(info.label)))
+    {
+      close(fd);
+      *offset = (unsigned) (num - base);
+      return i;
+    }
+    close(fd);
+  }
+
+  return -1;
+}
+//-----------------------------------------------------------------------------
+// request lines of sysfs GPIO numbers `nums` (data, clock, latch) from
+// GPIO character device (return SSHIFT_ERR_*)
+int sshift_open_cdev(sshift_t *self, const int *nums)
+{
+  struct gpio_v2_line_request req;
+  char fname[32];
+  int i, chip, fd;
+
+  for (i = 0; i < SSHIFT_PINS; i++)
+  {
+    chip = sshift_find_chip(nums[i], self->offset + i);
+    if (chip < 0 || (i && chip != self->chip))
+      return SSHIFT_ERR_CHIP;
+    self->chip = chip;
+  }
+
+  snprintf(fname, sizeof(fname), SSHIFT_DEV_PATH, self->chip);
+  fd = open(fname, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return SSHIFT_ERR_CHIP;
+
+  // all lines in one request: bit i of values - i-th pin, all low
+  memset((void*) &req, 0, sizeof(req));
+  for (i = 0; i < SSHIFT_PINS; i++)
+    req.offsets[i] = self->offset[i];
+  req.num_lines    = SSHIFT_PINS;
+  req.config.flags = GPIO_V2_LINE_FLAG_OUTPUT;
+  req.config.num_attrs = 1;
+  req.config.attrs[0].attr.id     = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+  req.config.attrs[0].attr.values = 0;
+  req.config.attrs[0].mask        = (1U << SSHIFT_PINS) - 1;
+  snprintf(req.consumer, sizeof(req.consumer), "%s", SSHIFT_CONSUMER);
+
+  i = ioctl(fd, GPIO_V2_GET_LINE_IOCTL, &req);
+  close(fd);
+  if (i < 0 || req.fd < 0)
+    return SSHIFT_ERR_REQUEST;
+
+  self->fd     = req.fd;
+  self->path   = SSHIFT_PATH_CDEV;
+  self->levels = 0;
+  return SSHIFT_ERR_NONE;
+}
+//-----------------------------------------------------------------------------
+// use opened output pins `pin` (data, clock, latch): sysfs or fake
+// (return SSHIFT_ERR_*)
+int sshift_open_gpio(sshift_t *self, sgpio_t *pin, int uring)
+{
+  int i;
+
+  self->pin    = pin;
+  self->path   = SSHIFT_PATH_WRITE;
+  self->levels = 0;
+  for (i = 0; i < SSHIFT_PINS; i++)
+    sgpio_set(pin + i, 0);
+
+  if (!uring)
+    return SSHIFT_ERR_NONE;
+
+  for (i = 0; i < SSHIFT_PINS; i++)
+    if (pin[i].fake || pin[i].fd < 0)
+      return SSHIFT_ERR_URING;
+  if (suring_init(&self->ring, SSHIFT_URING_ENTRIES) < 0)
+  {
+    self->ring.fd = -1;
+    return SSHIFT_ERR_URING;
+  }
+
+  self->path = SSHIFT_PATH_URING;
+  return SSHIFT_ERR_NONE;
+}
+//-----------------------------------------------------------------------------
+// set bit order and clock timing [ns] (0 - as fast as path allows)
+void sshift_timing(sshift_t *self, int order, int64_t setup_ns,
+                   int64_t high_ns)
+{
+  self->order    = order;
+  self->setup_ns = setup_ns;
+  self->high_ns  = high_ns;
+}
+//-----------------------------------------------------------------------------
+// submit linked writes and wait end of chain (return SSHIFT_ERR_*)
+static int sshift_uring_flush(sshift_t *self, struct io_uring_sqe *last)
+{
+  uint64_t user_data;
+  int res, done = 0, err = SSHIFT_ERR_NONE;
+
+  if (last == (struct io_uring_sqe*) NULL)
+    return SSHIFT_ERR_NONE;
+
+  // only end of chain completes on success (or cancelled after error)
+  last->flags    &= ~(IOSQE_IO_LINK | IOSQE_CQE_SKIP_SUCCESS);
+  last->user_data = 1;
+
+  while (!done)
+  {
+    self->calls++;
+    if (suring_enter(&self->ring, 1) < 0 && errno != EINTR)
+      return SSHIFT_ERR_WRITE;
+
+    while (suring_cqe(&self->ring, &user_data, &res))
+    {
+      if (res < 0) err = SSHIFT_ERR_WRITE;
+      if (user_data) done = 1;
+    }
+  }
+
+  return err;
+}
+//-----------------------------------------------------------------------------
+// write changed levels of `mask` pins (latch, clock, then data: clock
+// falls before data changes) by selected path (return SSHIFT_ERR_*)
+static inline int sshift_step(sshift_t *self, unsigned levels, unsigned mask,
+                              struct io_uring_sqe **last)
+{
+  struct gpio_v2_line_values v;
+  struct io_uring_sqe *sqe;
+  unsigned changed = (levels ^ self->levels) & mask;
+  int i, err = SSHIFT_ERR_NONE;
+
+  self->levels = (self->levels & ~mask) | (levels & mask);
+
+  if (self->path == SSHIFT_PATH_CDEV)
+  { // all changes at once
+    if (!changed) return SSHIFT_ERR_NONE;
+    v.bits = levels;
+    v.mask = mask;
+    self->calls++;
+    return ioctl(self->fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &v) < 0 ?
+           SSHIFT_ERR_WRITE : SSHIFT_ERR_NONE;
+  }
+
+  for (i = SSHIFT_PINS - 1; i >= 0; i--)
+  {
+    if (!((changed >> i) & 1)) continue;
+
+    if (self->path == SSHIFT_PATH_WRITE)
+    {
+      self->calls++;
+      if (sgpio_set(self->pin + i, (levels >> i) & 1) < 0)
+        err = SSHIFT_ERR_WRITE;
+      continue;
+    }
+
+    // uring: next write of chain, flush on full ring
+    sqe = suring_sqe(&self->ring);
+    if (sqe == (struct io_uring_sqe*) NULL)
+    {
+      if (sshift_uring_flush(self, *last) < 0) err = SSHIFT_ERR_WRITE;
+      sqe  = suring_sqe(&self->ring);
+    }
+    sqe->opcode    = IORING_OP_WRITE;
+    sqe->fd        = self->pin[i].fd;
+    sqe->addr      = (uint64_t) (uintptr_t) (((levels >> i) & 1) ? "1" : "0");
+    sqe->len       = 1;
+    sqe->off       = 0;
+    sqe->flags     = IOSQE_IO_LINK | IOSQE_CQE_SKIP_SUCCESS;
+    sqe->user_data = 0;
+    *last = sqe;
+  }
+
+  return err;
+}
+//-----------------------------------------------------------------------------
+// clock out `len` bytes and latch them (return SSHIFT_ERR_*)
+int sshift_write(sshift_t *self, const uint8_t *buf, unsigned len)
+{
+  const unsigned all = (1U << SSHIFT_PINS) - 1;
+  const unsigned clk = 1U << SSHIFT_CLOCK;
+  struct io_uring_sqe *last = (struct io_uring_sqe*) NULL;
+  int path = self->path;
+  int64_t t0 = sshift_time_ns();
+  unsigned i, j, bit, byte;
+  int err = SSHIFT_ERR_NONE;
+
+  // ring can't wait between writes
+  self->path = sshift_path_used(self);
+
+  for (i = 0; i < len; i++)
+  {
+    byte = buf[i];
+    for (j = 0; j < 8; j++)
+    {
+      bit = self->order == SSHIFT_LSB_FIRST ? (byte >> j) & 1 :
+                                              (byte >> (7 - j)) & 1;
+
+      // data (clock and latch low), then clock rising edge
+      if (sshift_step(self, bit << SSHIFT_DATA, all, &last) < 0)
+        err = SSHIFT_ERR_WRITE;
+      sshift_wait(self->setup_ns);
+      if (sshift_step(self, self->levels | clk, clk, &last) < 0)
+        err = SSHIFT_ERR_WRITE;
+      sshift_wait(self->high_ns);
+    }
+  }
+
+  // clock low, storage register is loaded by latch rising edge
+  if (sshift_step(self, 1U << SSHIFT_LATCH,
+                  clk | (1U << SSHIFT_LATCH), &last) < 0)
+    err = SSHIFT_ERR_WRITE;
+
+  if (self->path == SSHIFT_PATH_URING &&
+      sshift_uring_flush(self, last) < 0)
+    err = SSHIFT_ERR_WRITE;
+  self->path = path;
+
+  self->time_ns += sshift_time_ns() - t0;
+  self->bits    += ((uint64_t) len) * 8;
+  self->streams++;
+
+  return err;
+}
+//-----------------------------------------------------------------------------
+// write path used by sshift_write(): uring falls back to writes when
+// any wait is set
+int sshift_path_used(const sshift_t *self)
+{
+  if (self->path == SSHIFT_PATH_URING &&
+      (self->setup_ns > 0 || self->high_ns > 0))
+    return SSHIFT_PATH_WRITE;
+  return self->path;
+}
+//-----------------------------------------------------------------------------
+// achieved throughput inside sshift_write() [bit/s]
+double sshift_bps(const sshift_t *self)
+{
+  return self->time_ns > 0 ?
+         ((double) self->bits) * 1e9 / (double) self->time_ns : 0.;
+}
+//-----------------------------------------------------------------------------
+// release lines or ring (pins of sshift_open_gpio() are left as is)
+void sshift_close(sshift_t *self)
+{
+  if (self->fd >= 0)
+    close(self->fd);
+  self->fd = -1;
+
+  if (self->ring.fd >= 0)
+    suring_free(&self->ring);
+  self->ring.fd = -1;
+}
+//-----------------------------------------------------------------------------
+// path name ("write", "uring", "cdev")
+const char *sshift_path_str(int path)
+{
+  static const char *paths[] = { "write", "uring", "cdev" };
+  return (path >= 0 && path <= SSHIFT_PATH_CDEV) ? paths[path] : "unknown";
+}
+//-----------------------------------------------------------------------------
+// error string
+const char *sshift_error_str(int err)
+{
+  static const char *errors[] = {
+    "success",
+    "no GPIO chip device with all shift pins",
+    "can't request GPIO lines (busy?)",
+    "can't setup io_uring for sysfs writes",
+    "GPIO write fail"
+  };
+  return (err <= 0 && err > -5) ? errors[-err] : "unknown error";
+}
+//-----------------------------------------------------------------------------
+/*** end of "sshift.c" file ***/
@@ -0,0 +1,123 @@
+/*
+ * Bit-banged shift register output (74HC595 style): byte streams are
+ * clocked out over data/clock/latch pins by the fastest write path:
+ * GPIO character device (data and clock changes in one ioctl), sysfs
+ * writes linked in io_uring (one syscall per ring) or plain sgpio_set()
+ * File: "sshift.h"
+ */
+
+#ifndef SSHIFT_H
+#define SSHIFT_H
+//-----------------------------------------------------------------------------
+#include <stdint.h>     // `uint8_t`, `uint64_t`, `int64_t`
+#include "sgpio.h"      // `sgpio_t`
+#include "suring.h"     // `suring_t`
+//-----------------------------------------------------------------------------
+// Waveform (all levels are 0 before first stream):
+//   per bit: data = bit (clock goes low at the same time if batched),
+//            wait setup_ns, clock = 1, wait high_ns, clock = 0;
+//   after last bit: latch = 1 (storage register is loaded on rising edge),
+//            latch stays high until first bit of next stream
+//-----------------------------------------------------------------------------
+// GPIO character device (N - chip index)
+#define SSHIFT_DEV_PATH "/dev/gpiochip%d"
+
+// max number of character devices scanned for sysfs GPIO numbers
+#define SSHIFT_CHIPS_MAX 64
+
+// consumer label of requested lines
+#define SSHIFT_CONSUMER "tick"
+
+// SQE of io_uring path (up to 3 writes per bit)
+#define SSHIFT_URING_ENTRIES 256
+
+// pins (index in pin list, bit in levels)
+#define SSHIFT_DATA  0
+#define SSHIFT_CLOCK 1
+#define SSHIFT_LATCH 2
+#define SSHIFT_PINS  3
+
+// write paths
+#define SSHIFT_PATH_WRITE 0 // sgpio_set() per changed level (sysfs or fake)
+#define SSHIFT_PATH_URING 1 // sysfs writes linked in io_uring
+#define SSHIFT_PATH_CDEV  2 // GPIO character device, one ioctl per step
+
+// bit order
+#define SSHIFT_MSB_FIRST 0
+#define SSHIFT_LSB_FIRST 1
+
+// error codes
+#define SSHIFT_ERR_NONE     0 // no error
+#define SSHIFT_ERR_CHIP    -1 // no GPIO chip device with all pins
+#define SSHIFT_ERR_REQUEST -2 // can't request lines (busy, e.g. sysfs)
+#define SSHIFT_ERR_URING   -3 // can't setup io_uring (or fake pins)
+#define SSHIFT_ERR_WRITE   -4 // write/ioctl fail
+//-----------------------------------------------------------------------------
+// `sshift_t` type structure
+typedef struct sshift_ {
+  int path;          // SSHIFT_PATH_*
+  int order;         // SSHIFT_MSB_FIRST|SSHIFT_LSB_FIRST
+  int64_t setup_ns;  // data valid before clock rising edge (0 - no wait)
+  int64_t high_ns;   // clock high time (0 - no wait)
+  sgpio_t *pin;      // data, clock, latch (write/uring paths)
+  int fd;            // requested lines (cdev path) or -1
+  int chip;          // chip index of cdev path
+  unsigned offset[SSHIFT_PINS]; // line offsets of cdev path
+  suring_t ring;     // linked writes (uring path)
+  unsigned levels;   // current levels (bit i - i-th pin)
+  uint64_t bits;     // bits shifted out
+  uint64_t streams;  // calls of sshift_write()
+  uint64_t calls;    // write()/ioctl()/io_uring_enter() syscalls
+  int64_t time_ns;   // time inside sshift_write() [ns]
+} sshift_t;
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+// "constructor" (write path, MSB first, no waits)
+void sshift_init(sshift_t *self);
+//-----------------------------------------------------------------------------
+// request lines of sysfs GPIO numbers `nums` (data, clock, latch) from
+// GPIO character device; chip is found by label and number of lines of
+// sysfs gpiochipBASE, so all pins must be on one chip and not exported
+// to sysfs (return SSHIFT_ERR_*)
+int sshift_open_cdev(sshift_t *self, const int *nums);
+//-----------------------------------------------------------------------------
+// use opened output pins `pin` (data, clock, latch): sysfs or fake; if
+// `uring` writes are linked in io_uring (sysfs only, no waits)
+// (return SSHIFT_ERR_*)
+int sshift_open_gpio(sshift_t *self, sgpio_t *pin, int uring);
+//-----------------------------------------------------------------------------
+// set bit order and clock timing [ns] (0 - as fast as path allows);
+// uring path falls back to writes when any wait is set
+void sshift_timing(sshift_t *self, int order, int64_t setup_ns,
+                   int64_t high_ns);
+//-----------------------------------------------------------------------------
+// clock out `len` bytes and latch them (return SSHIFT_ERR_*)
+int sshift_write(sshift_t *self, const uint8_t *buf, unsigned len);
+//-----------------------------------------------------------------------------
+// write path used by sshift_write(): uring falls back to writes when
+// any wait is set (SSHIFT_PATH_*)
+int sshift_path_used(const sshift_t *self);
+//-----------------------------------------------------------------------------
+// achieved throughput inside sshift_write() [bit/s]
+double sshift_bps(const sshift_t *self);
+//-----------------------------------------------------------------------------
+// release lines or ring (pins of sshift_open_gpio() are left as is)
+void sshift_close(sshift_t *self);
+//-----------------------------------------------------------------------------
+// path name ("write", "uring", "cdev")
+const char *sshift_path_str(int path);
+//-----------------------------------------------------------------------------
+// error string
+const char *sshift_error_str(int err);
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+#endif // SSHIFT_H
+
+/*** end of "sshift.h" file ***/
@@ -0,0 +1,128 @@
+/*
+ * Simple statistics: min/max/mean/deviation and percentiles
+ * File: "sstat.c"
+ */
+//-----------------------------------------------------------------------------
+#include "sstat.h"  // `sstat_t`
+#include <string.h> // memset()
+#include <math.h>   // sqrt()
+//-----------------------------------------------------------------------------
+// histogram bucket index of non negative value
+static int sstat_index(uint64_t v)
+{
+  int e;
+  if (v < 2 * SSTAT_SUB) return (int) v;
+  e = 63 - __builtin_clzll(v) - SSTAT_SUB_BITS; // v >> e in [SUB, 2*SUB)
+  return (e + 1) * SSTAT_SUB + (int) ((v >> e) - SSTAT_SUB);
+}
+//-----------------------------------------------------------------------------
+// middle value of histogram bucket
+static int64_t sstat_value(int i)
+{
+  int e;
+  if (i < 2 * SSTAT_SUB) return (int64_t) i;
+  e = i / SSTAT_SUB - 1;
+  return (((int64_t) (i % SSTAT_SUB + SSTAT_SUB)) << e) +
+         (((int64_t) 1 << e) >> 1);
+}
+//-----------------------------------------------------------------------------
+// reset statistics
+void sstat_init(sstat_t *self)
+{
+  memset((void*) self, 0, sizeof(sstat_t));
+}
+//-----------------------------------------------------------------------------
+// add value
+void sstat_add(sstat_t *self, int64_t val)
+{
+  if (self->count == 0 || self->min > val) self->min = val;
+  if (self->count == 0 || self->max < val) self->max = val;
+  self->count++;
+  self->sum  += (long double) val;
+  self->sum2 += (long double) val * (long double) val;
+
+  if (val < 0)
+  {
+    self->negative++;
+    val = 0;
+  }
+  self->hist[sstat_index((uint64_t) val)]++;
+}
+//-----------------------------------------------------------------------------
+// merge statistics `src` to `self`
+void sstat_merge(sstat_t *self, const sstat_t *src)
+{
+  int i;
+
+  if (src->count == 0) return;
+  if (self->count == 0 || self->min > src->min) self->min = src->min;
+  if (self->count == 0 || self->max < src->max) self->max = src->max;
+  self->count    += src->count;
+  self->sum      += src->sum;
+  self->sum2     += src->sum2;
+  self->negative += src->negative;
+
+  for (i = 0; i < SSTAT_BUCKETS; i++)
+    self->hist[i] += src->hist[i];
+}
+//-----------------------------------------------------------------------------
+// mean value
+double sstat_mean(const sstat_t *self)
+{
+  return self->count ? (double) (self->sum / self->count) : 0.;
+}
+//-----------------------------------------------------------------------------
+// standard deviation
+double sstat_dev(const sstat_t *self)
+{
+  long double mean, var;
+  if (self->count < 2) return 0.;
+  mean = self->sum / self->count;
+  var  = self->sum2 / self->count - mean * mean;
+  return var > 0. ? sqrt((double) var) : 0.;
+}
+//-----------------------------------------------------------------------------
+// percentile (p = 0...100) estimated by histogram
+int64_t sstat_percentile(const sstat_t *self, double p)
+{
+  uint64_t rank, cnt = 0;
+  int64_t v;
+  int i;
+
+  if (self->count == 0) return 0;
+  if (p <= 0.)   return self->min;
+  if (p >= 100.) return self->max;
+
+  rank = (uint64_t) (p * 1e-2 * (double) self->count);
+  if (rank >= self->count) rank = self->count - 1;
+
+  for (i = 0; i < SSTAT_BUCKETS; i++)
+  {
+    cnt += self->hist[i];
+    if (cnt > rank) break;
+  }
+
+  // bucket middle value limited by exact min/max
+  v = sstat_value(i);
+  if (v < self->min) v = self->min;
+  if (v > self->max) v = self->max;
+  return v;
+}
+//-----------------------------------------------------------------------------
+// print summary line: count min p50 p90 p99 p99.9 max mean dev
+// (values multiplied by `scale`, e.g. 1e-3 for ns -> us)
+void sstat_fprint(FILE *stream, const sstat_t *self, double scale)
+{
+  fprintf(stream, "%10llu %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f",
+          (unsigned long long) self->count,
+          (double) self->min * scale,
+          (double) sstat_percentile(self, 50.)  * scale,
+          (double) sstat_percentile(self, 90.)  * scale,
+          (double) sstat_percentile(self, 99.)  * scale,
+          (double) sstat_percentile(self, 99.9) * scale,
+          (double) self->max * scale,
+          sstat_mean(self) * scale,
+          sstat_dev(self)  * scale);
+}
+//-----------------------------------------------------------------------------
+/*** end of "sstat.c" file ***/
@@ -0,0 +1,61 @@
+/*
+ * Simple statistics: min/max/mean/deviation and percentiles
+ * (log-linear histogram with fixed memory and O(1) update)
+ * File: "sstat.h"
+ */
+
+#ifndef SSTAT_H
+#define SSTAT_H
+//-----------------------------------------------------------------------------
+#include <stdint.h> // `int64_t`, `uint32_t`
+#include <stdio.h>  // `FILE`
+//-----------------------------------------------------------------------------
+// histogram sub-buckets per power of two (relative error < 1/2^SSTAT_SUB_BITS)
+#define SSTAT_SUB_BITS 7
+#define SSTAT_SUB      (1 << SSTAT_SUB_BITS)
+#define SSTAT_BUCKETS  ((64 - SSTAT_SUB_BITS + 1) * SSTAT_SUB)
+//-----------------------------------------------------------------------------
+// `sstat_t` type structure (values are integers, e.g. nanoseconds)
+typedef struct sstat_ {
+  uint64_t count;    // number of values
+  int64_t min, max;  // min and max value
+  long double sum;   // sum of values
+  long double sum2;  // sum of squares
+  uint64_t negative; // number of negative values (counted as 0 in histogram)
+  uint32_t hist[SSTAT_BUCKETS];
+} sstat_t;
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+// reset statistics
+void sstat_init(sstat_t *self);
+//-----------------------------------------------------------------------------
+// add value
+void sstat_add(sstat_t *self, int64_t val);
+//-----------------------------------------------------------------------------
+// merge statistics `src` to `self`
+void sstat_merge(sstat_t *self, const sstat_t *src);
+//-----------------------------------------------------------------------------
+// mean value
+double sstat_mean(const sstat_t *self);
+//-----------------------------------------------------------------------------
+// standard deviation
+double sstat_dev(const sstat_t *self);
+//-----------------------------------------------------------------------------
+// percentile (p = 0...100) estimated by histogram
+int64_t sstat_percentile(const sstat_t *self, double p);
+//-----------------------------------------------------------------------------
+// print summary line: count min p50 p90 p99 p99.9 max mean dev
+// (values multiplied by `scale`, e.g. 1e-3 for ns -> us)
+void sstat_fprint(FILE *stream, const sstat_t *self, double scale);
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+#endif // SSTAT_H
+
+/*** end of "sstat.h" file ***/
@@ -0,0 +1,241 @@
+/*
+ * Simple background load generator (non real time threads)
+ * File: "sstress.c"
+ */
+//-----------------------------------------------------------------------------
+#define _GNU_SOURCE    // CPU_SET(), pthread_attr_setaffinity_np()
+#include "sstress.h"   // `sstress_t`
+#include <stdlib.h>    // malloc(), free(), strtol(), mkstemp()
+#include <string.h>    // strncmp(), memcpy(), memset()
+#include <stdio.h>     // perror()
+#include <signal.h>    // sigfillset(), pthread_sigmask()
+#include <sched.h>     // CPU_SET(), SCHED_OTHER
+#include <unistd.h>    // getppid(), pwrite(), pread(), fdatasync()
+#include <sys/syscall.h> // SYS_getpid
+//-----------------------------------------------------------------------------
+static const char *sstress_types[SSTRESS_TYPES] = {
+  "cpu", "mem", "sys", "io"
+};
+//-----------------------------------------------------------------------------
+// load type name
+const char *sstress_type_str(int type)
+{
+  return (type >= 0 && type < SSTRESS_TYPES) ? sstress_types[type] : "unknown";
+}
+//-----------------------------------------------------------------------------
+// parse load spec "TYPE[:N][,TYPE[:N]...][@CPU[,CPU...]]"
+// where TYPE is cpu|mem|sys|io, N is number of threads (1 by default),
+// e.g. "cpu:2,io@1,2"; return 0 or -1 if spec is bad
+int sstress_init(sstress_t *self, const char *spec)
+{
+  const char *p = spec;
+  char *end;
+  int type, n, len;
+
+  self->stop = 0;
+  self->num  = 0;
+  self->ncpu = 0;
+
+  while (*p && *p != '@')
+  {
+    for (type = 0; type < SSTRESS_TYPES; type++)
+    {
+      len = strlen(sstress_types[type]);
+      if (!strncmp(p, sstress_types[type], len) &&
+          (p[len] == ':' || p[len] == ',' || p[len] == '@' || !p[len]))
+        break;
+    }
+    if (type == SSTRESS_TYPES) return -1;
+    p += len;
+
+    n = 1;
+    if (*p == ':')
+    {
+      n = (int) strtol(p + 1, &end, 10);
+      if (end == p + 1 || n < 1) return -1;
+      p = end;
+    }
+
+    while (n-- > 0 && self->num < SSTRESS_THREADS_MAX)
+      self->threads[self->num++].type = type;
+
+    if (*p == ',') p++;
+  }
+
+  if (*p == '@')
+  { // CPU list
+    p++;
+    while (*p && self->ncpu < SSTRESS_THREADS_MAX)
+    {
+      n = (int) strtol(p, &end, 10);
+      if (end == p || n < 0) return -1;
+      self->cpus[self->ncpu++] = n;
+      p = end;
+      if (*p == ',') p++;
+      else if (*p) return -1;
+    }
+  }
+
+  return self->num ? 0 : -1;
+}
+//-----------------------------------------------------------------------------
+// CPU load: integer arithmetic
+static void sstress_cpu(sstress_thread_t *t)
+{
+  volatile unsigned long long x = 1;
+  int i;
+
+  while (!*t->stop)
+  {
+    for (i = 0; i < 100000; i++)
+      x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    t->loops++;
+  }
+}
+//-----------------------------------------------------------------------------
+// memory bandwidth load: copy halves of big buffer
+static void sstress_mem(sstress_thread_t *t)
+{
+  size_t half = SSTRESS_MEM_SIZE / 2;
+  char *buf = (char*) malloc(SSTRESS_MEM_SIZE);
+  if (buf == NULL) return;
+  memset(buf, 0x5A, SSTRESS_MEM_SIZE);
+
+  while (!*t->stop)
+  {
+    memcpy(buf, buf + half, half);
+    if (*t->stop) break;
+    memcpy(buf + half, buf, half);
+    t->loops++;
+  }
+
+  free(buf);
+}
+//-----------------------------------------------------------------------------
+// syscall load: cheap system calls
+static void sstress_sys(sstress_thread_t *t)
+{
+  int i;
+
+  while (!*t->stop)
+  {
+    for (i = 0; i < 1000; i++)
+      syscall(SYS_getpid);
+    t->loops++;
+  }
+}
+//-----------------------------------------------------------------------------
+// file I/O load: write, fdatasync and read back unlinked temporary file
+static void sstress_io(sstress_thread_t *t)
+{
+  char fname[] = SSTRESS_IO_DIR "/sstress-XXXXXX";
+  char *buf;
+  off_t off;
+  int fd = mkstemp(fname);
+
+  if (fd < 0)
+  {
+    perror("error in sstress_io(): mkstemp() failed");
+    return;
+  }
+  unlink(fname); // file disappears on close
+
+  buf = (char*) malloc(SSTRESS_IO_BLOCK);
+  if (buf != NULL)
+  {
+    memset(buf, 0xA5, SSTRESS_IO_BLOCK);
+    while (!*t->stop)
+    {
+      for (off = 0; off < SSTRESS_IO_SIZE && !*t->stop; off += SSTRESS_IO_BLOCK)
+        if (pwrite(fd, buf, SSTRESS_IO_BLOCK, off) < 0) break;
+      fdatasync(fd);
+      for (off = 0; off < SSTRESS_IO_SIZE && !*t->stop; off += SSTRESS_IO_BLOCK)
+        if (pread(fd, buf, SSTRESS_IO_BLOCK, off) < 0) break;
+      t->loops++;
+    }
+    free(buf);
+  }
+
+  close(fd);
+}
+//-----------------------------------------------------------------------------
+// load thread function
+static void *sstress_thread(void *arg)
+{
+  sstress_thread_t *t = (sstress_thread_t*) arg;
+
+  if      (t->type == SSTRESS_CPU) sstress_cpu(t);
+  else if (t->type == SSTRESS_MEM) sstress_mem(t);
+  else if (t->type == SSTRESS_SYS) sstress_sys(t);
+  else if (t->type == SSTRESS_IO)  sstress_io(t);
+
+  return NULL;
+}
+//-----------------------------------------------------------------------------
+// start load threads (return number of started threads or -1 on error)
+int sstress_start(sstress_t *self)
+{
+  pthread_attr_t attr;
+  struct sched_param schp;
+  sigset_t all, old;
+  cpu_set_t cpuset;
+  int i, retv = 0;
+
+  // load threads don't take signals (SIGINT, timer) from main thread
+  sigfillset(&all);
+  pthread_sigmask(SIG_BLOCK, &all, &old);
+
+  for (i = 0; i < self->num; i++)
+  {
+    sstress_thread_t *t = self->threads + i;
+    t->stop  = &self->stop;
+    t->loops = 0;
+    t->cpu   = self->ncpu ? self->cpus[i % self->ncpu] : -1;
+
+    // always SCHED_OTHER, even if creator is real time
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    memset(&schp, 0, sizeof(schp));
+    pthread_attr_setschedparam(&attr, &schp);
+
+    if (t->cpu >= 0)
+    {
+      CPU_ZERO(&cpuset);
+      CPU_SET(t->cpu, &cpuset);
+      pthread_attr_setaffinity_np(&attr, sizeof(cpuset), &cpuset);
+    }
+
+    if (pthread_create(&t->thread, &attr, sstress_thread, (void*) t) != 0)
+    {
+      perror("error in sstress_start(): pthread_create() failed");
+      pthread_attr_destroy(&attr);
+      retv = -1;
+      break;
+    }
+    pthread_attr_destroy(&attr);
+  }
+
+  pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+  if (retv < 0)
+  { // stop already started threads
+    self->num = i;
+    sstress_join(self);
+    return -1;
+  }
+
+  return self->num;
+}
+//-----------------------------------------------------------------------------
+// stop and join load threads
+void sstress_join(sstress_t *self)
+{
+  int i;
+
+  sstress_stop(self);
+  for (i = 0; i < self->num; i++)
+    pthread_join(self->threads[i].thread, NULL);
+}
+//-----------------------------------------------------------------------------
+/*** end of "sstress.c" file ***/
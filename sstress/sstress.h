@@ -0,0 +1,84 @@
+/*
+ * Simple background load generator (non real time threads)
+ * File: "sstress.h"
+ */
+
+#ifndef SSTRESS_H
+#define SSTRESS_H
+//-----------------------------------------------------------------------------
+#include <pthread.h> // pthread_t
+//-----------------------------------------------------------------------------
+// max number of load threads
+#define SSTRESS_THREADS_MAX 64
+
+// memory bandwidth load buffer size per thread [bytes]
+#define SSTRESS_MEM_SIZE (32 * 1024 * 1024)
+
+// file I/O load: file size per thread [bytes] and block size
+#define SSTRESS_IO_SIZE  (16 * 1024 * 1024)
+#define SSTRESS_IO_BLOCK (64 * 1024)
+
+// directory for file I/O load temporary files
+#define SSTRESS_IO_DIR "/tmp"
+
+// inline macro (platform depended)
+#ifndef   SSTRESS_INLINE
+#  define SSTRESS_INLINE static inline
+#endif // SSTRESS_INLINE
+//-----------------------------------------------------------------------------
+// load types
+typedef enum {
+  SSTRESS_CPU = 0, // busy loop with arithmetic
+  SSTRESS_MEM,     // memory bandwidth (memcpy over big buffer)
+  SSTRESS_SYS,     // cheap syscalls in loop
+  SSTRESS_IO,      // file write/fsync/read
+  SSTRESS_TYPES
+} sstress_type_t;
+//-----------------------------------------------------------------------------
+// load thread
+typedef struct sstress_thread_ {
+  pthread_t thread;
+  int type;                     // sstress_type_t
+  int cpu;                      // CPU to pin (-1 - any)
+  volatile int *stop;           // stop flag
+  unsigned long long loops;     // work loops done
+} sstress_thread_t;
+//-----------------------------------------------------------------------------
+// `sstress_t` type structure
+typedef struct sstress_ {
+  volatile int stop;
+  int num;                      // number of threads
+  int ncpu;                     // number of CPUs to pin
+  int cpus[SSTRESS_THREADS_MAX];
+  sstress_thread_t threads[SSTRESS_THREADS_MAX];
+} sstress_t;
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+// parse load spec "TYPE[:N][,TYPE[:N]...][@CPU[,CPU...]]"
+// where TYPE is cpu|mem|sys|io, N is number of threads (1 by default),
+// e.g. "cpu:2,io@1,2"; return 0 or -1 if spec is bad
+int sstress_init(sstress_t *self, const char *spec);
+//-----------------------------------------------------------------------------
+// start load threads (return number of started threads or -1 on error)
+int sstress_start(sstress_t *self);
+//-----------------------------------------------------------------------------
+// request load threads to stop (async-signal-safe)
+SSTRESS_INLINE void sstress_stop(sstress_t *self) { self->stop = 1; }
+//-----------------------------------------------------------------------------
+// stop and join load threads
+void sstress_join(sstress_t *self);
+//-----------------------------------------------------------------------------
+// load type name
+const char *sstress_type_str(int type);
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+#endif // SSTRESS_H
+
+/*** end of "sstress.h" file ***/
@@ -0,0 +1,188 @@
+/*
+ * Simple software PLL/FLL for timer drift disciplining
+ * File: "spll.c"
+ */
+//-----------------------------------------------------------------------------
+#include "spll.h"   // `spll_t`
+#include <math.h>   // floor(), sqrt()
+#include <stdlib.h> // strtod()
+#include <string.h> // strcmp(), memmove()
+#include <time.h>   // clock_gettime()
+#include <fcntl.h>  // open()
+#include <unistd.h> // read(), close()
+//-----------------------------------------------------------------------------
+// get clock time in seconds
+static double spll_clock(clockid_t clk)
+{
+  struct timespec ts;
+  clock_gettime(clk, &ts);
+  return ((double) ts.tv_sec) + ((double) ts.tv_nsec) * 1e-9;
+}
+//-----------------------------------------------------------------------------
+// wrap phase error to -T/2..T/2
+static double spll_wrap(double e, double period)
+{
+  return e - period * floor(e / period + 0.5);
+}
+//-----------------------------------------------------------------------------
+// init PLL (period in seconds)
+void spll_init(spll_t *self, double period, double kp, double ki)
+{
+  self->ref        = SPLL_REF_NONE;
+  self->fd         = -1;
+  self->len        = 0;
+  self->pending    = 0;
+  self->next       = 0.;
+  self->kp         = kp;
+  self->ki         = ki;
+  self->period     = period;
+  self->raw0       = 0.;
+  self->freq       = 0.;
+  self->corr       = 0.;
+  self->phase      = 0.;
+  self->phase_min  = 0.;
+  self->phase_max  = 0.;
+  self->phase_sum2 = 0.;
+  self->samples    = 0;
+}
+//-----------------------------------------------------------------------------
+// use CLOCK_MONOTONIC_RAW as reference
+void spll_ref_monoraw(spll_t *self)
+{
+  self->ref = SPLL_REF_MONORAW;
+}
+//-----------------------------------------------------------------------------
+// use file/pipe as reference ("-" for stdin); return 0 or -1 on error
+int spll_ref_file(spll_t *self, const char *path)
+{
+  int fd = strcmp(path, "-") ? open(path, O_RDONLY | O_NONBLOCK) : 0;
+  if (fd < 0) return -1;
+  if (fd == 0) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  self->ref     = SPLL_REF_FILE;
+  self->fd      = fd;
+  self->len     = 0;
+  self->pending = 0;
+  return 0;
+}
+//-----------------------------------------------------------------------------
+// parse next line from reference file to `self->next` (return 1 if parsed)
+static int spll_ref_next_line(spll_t *self)
+{
+  int i, retv;
+
+  for (;;)
+  {
+    for (i = 0; i < self->len && self->buf[i] != '\n'; i++);
+    if (i < self->len)
+    { // complete line
+      char *end;
+      double t;
+      self->buf[i] = '\0';
+      t = strtod(self->buf, &end);
+      self->len -= i + 1;
+      memmove(self->buf, self->buf + i + 1, self->len);
+      if (end != self->buf)
+      {
+        self->next    = t;
+        self->pending = 1;
+        return 1;
+      }
+      continue; // skip empty or bad line
+    }
+
+    if (self->len >= SPLL_LINE_MAX - 1)
+      self->len = 0; // drop too long line
+
+    retv = read(self->fd, self->buf + self->len,
+                SPLL_LINE_MAX - 1 - self->len);
+    if (retv <= 0) return 0; // no data yet (pipe) or EOF
+    self->len += retv;
+  }
+}
+//-----------------------------------------------------------------------------
+// use reference edges up to half period after deadline, keep last one
+static int spll_ref_read_file(spll_t *self, double deadline, double *t_ref)
+{
+  int found = 0;
+  double limit = deadline + 0.5 * self->period;
+
+  while (self->pending || spll_ref_next_line(self))
+  {
+    if (self->next > limit)
+      break; // future reference edge
+    *t_ref = self->next;
+    self->pending = 0;
+    found = 1;
+  }
+
+  return found;
+}
+//-----------------------------------------------------------------------------
+// get reference edge time nearest to local deadline (in timer clock seconds)
+// return 1 if reference sample available, 0 if not, -1 on error
+int spll_ref_read(spll_t *self, double deadline, double *t_ref)
+{
+  if (self->ref == SPLL_REF_MONORAW)
+  { // raw clock edges are raw0 + k * period
+    double real = spll_clock(CLOCK_REALTIME);
+    double raw  = spll_clock(CLOCK_MONOTONIC_RAW) - (real - deadline);
+    if (self->samples == 0) self->raw0 = raw;
+    *t_ref = deadline -
+             spll_wrap(raw - self->raw0, self->period);
+    return 1;
+  }
+  else if (self->ref == SPLL_REF_FILE)
+    return spll_ref_read_file(self, deadline, t_ref);
+
+  return 0;
+}
+//-----------------------------------------------------------------------------
+// feed local edge and reference edge times [s] to loop filter
+void spll_update(spll_t *self, double t_local, double t_ref)
+{
+  double e = spll_wrap(t_local - t_ref, self->period);
+  double f_max = SPLL_FREQ_MAX * self->period;
+
+  // PI loop filter: integral part is a frequency correction
+  self->freq -= self->ki * e;
+  if      (self->freq >  f_max) self->freq =  f_max;
+  else if (self->freq < -f_max) self->freq = -f_max;
+  self->corr = -self->kp * e;
+
+  // statistics
+  if (self->samples == 0 || self->phase_min > e) self->phase_min = e;
+  if (self->samples == 0 || self->phase_max < e) self->phase_max = e;
+  self->phase       = e;
+  self->phase_sum2 += e * e;
+  self->samples++;
+}
+//-----------------------------------------------------------------------------
+// return next deadline shift [s] (call once per period)
+double spll_shift(spll_t *self)
+{
+  double shift = self->freq + self->corr;
+  self->corr = 0.;
+  return shift;
+}
+//-----------------------------------------------------------------------------
+// frequency correction [ppm]
+double spll_freq_ppm(const spll_t *self)
+{
+  return self->freq / self->period * 1e6;
+}
+//-----------------------------------------------------------------------------
+// RMS of phase error [s]
+double spll_phase_rms(const spll_t *self)
+{
+  return self->samples ? sqrt((double) (self->phase_sum2 / self->samples)) : 0.;
+}
+//-----------------------------------------------------------------------------
+// close reference file
+void spll_free(spll_t *self)
+{
+  if (self->fd > 0) close(self->fd);
+  self->fd  = -1;
+  self->ref = SPLL_REF_NONE;
+}
+//-----------------------------------------------------------------------------
+/*** end of "spll.c" file ***/
@@ -0,0 +1,88 @@
+/*
+ * Simple software PLL/FLL for timer drift disciplining
+ * File: "spll.h"
+ */
+
+#ifndef SPLL_H
+#define SPLL_H
+//-----------------------------------------------------------------------------
+#include <stdint.h> // `int64_t`
+//-----------------------------------------------------------------------------
+// default loop gains (proportional and integral)
+#define SPLL_KP 0.1
+#define SPLL_KI 0.005
+
+// frequency correction limit (relative, 1e-3 = 1000 ppm)
+#define SPLL_FREQ_MAX 1e-3
+
+// max reference line length (file/pipe reference)
+#define SPLL_LINE_MAX 80
+//-----------------------------------------------------------------------------
+// reference source type
+typedef enum {
+  SPLL_REF_NONE = 0, // no reference (free running)
+  SPLL_REF_MONORAW,  // CLOCK_MONOTONIC_RAW (raw oscillator)
+  SPLL_REF_FILE      // reference edge timestamps from file/pipe (one per line,
+                     // seconds of STIMER_CLOCKID)
+} spll_ref_t;
+//-----------------------------------------------------------------------------
+// `spll_t` type structure
+typedef struct spll_ {
+  int    ref;      // reference source type (spll_ref_t)
+  int    fd;       // file/pipe descriptor for SPLL_REF_FILE
+  int    len;      // number of buffered chars
+  char   buf[SPLL_LINE_MAX];
+  int    pending;  // 1 if `next` holds a not yet used reference edge
+  double next;     // next reference edge time [s] (SPLL_REF_FILE)
+  double kp, ki;   // loop gains
+  double period;   // nominal period [s]
+  double raw0;     // raw time of first edge [s] (SPLL_REF_MONORAW)
+  double freq;     // frequency correction [s per period]
+  double corr;     // pending phase correction [s]
+  double phase;    // last phase error [s] (>0 - local edge is late)
+  double phase_min, phase_max;
+  long double phase_sum2;
+  unsigned samples; // number of reference samples
+} spll_t;
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+// init PLL (period in seconds)
+void spll_init(spll_t *self, double period, double kp, double ki);
+//-----------------------------------------------------------------------------
+// use CLOCK_MONOTONIC_RAW as reference
+void spll_ref_monoraw(spll_t *self);
+//-----------------------------------------------------------------------------
+// use file/pipe as reference ("-" for stdin); return 0 or -1 on error
+int spll_ref_file(spll_t *self, const char *path);
+//-----------------------------------------------------------------------------
+// get reference edge time nearest to local deadline (in timer clock seconds)
+// return 1 if reference sample available, 0 if not, -1 on error
+int spll_ref_read(spll_t *self, double deadline, double *t_ref);
+//-----------------------------------------------------------------------------
+// feed local edge and reference edge times [s] to loop filter
+void spll_update(spll_t *self, double t_local, double t_ref);
+//-----------------------------------------------------------------------------
+// return next deadline shift [s] (call once per period)
+double spll_shift(spll_t *self);
+//-----------------------------------------------------------------------------
+// frequency correction [ppm]
+double spll_freq_ppm(const spll_t *self);
+//-----------------------------------------------------------------------------
+// RMS of phase error [s]
+double spll_phase_rms(const spll_t *self);
+//-----------------------------------------------------------------------------
+// close reference file
+void spll_free(spll_t *self);
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+#endif // SPLL_H
+
+/*** end of "spll.h" file ***/
+
@@ -4,9 +4,34 @@
  */
 //----------------------------------------------------------------------------
 #include "stimer.h" // `stimer_t`
-#include <string.h> // memset()
+#include "spll.h"   // `spll_t`
+#include "suring.h" // `suring_t`
+#include <string.h> // memset(), strcmp(), strncmp()
+#include <stdlib.h> // strtod(), malloc(), free()
+#include <math.h>   // log(), sqrt(), cos(), fabs(), floor(), llround[l]()
 #include <stdio.h>  // perror()
-#include <unistd.h> // pause()
+#include <unistd.h> // pause(), read(), close()
+#include <errno.h>  // errno, EINTR, ECANCELED, ETIME, EAGAIN
+#include <fcntl.h>  // fcntl(), O_NONBLOCK
+#include <sys/timerfd.h>  // timerfd_create(), timerfd_settime()
+#include <sys/signalfd.h> // signalfd()
+//-----------------------------------------------------------------------------
+// io_uring state (STIMER_BACKEND_URING)
+typedef struct stimer_uring_ {
+  suring_t ring;
+  struct __kernel_timespec ts; // monotonic deadline of armed timeout
+  int armed;                   // 1 if timeout is submitted
+  unsigned writes;             // number of queued writes
+  struct {
+    int fd;
+    const void *buf;
+    unsigned len;
+  } write[STIMER_URING_WRITES];
+} stimer_uring_t;
+
+// user_data of io_uring requests
+#define STIMER_URING_TIMEOUT 1
+#define STIMER_URING_WRITE   2
 //-----------------------------------------------------------------------------
 typedef struct stimer_sigint_ {
   void (*fn)(void *context);
@@ -34,9 +59,6 @@ int stimer_realtime()
 double stimer_daytime()
 {
   struct timespec ts;
-  struct tm tm;
-  time_t time;
-  double t;
 
   //!!! FIXME
 #if 1
@@ -45,13 +67,20 @@ double stimer_daytime()
   clock_gettime(CLOCK_MONOTONIC, &ts);
 #endif
 
-  time = (time_t) ts.tv_sec;
-  localtime_r(&time, &tm);
-  time = tm.tm_sec + tm.tm_min * 60 + tm.tm_hour * 3600;
+  return stimer_daytime_of(((double) ts.tv_sec) + ((double) ts.tv_nsec) * 1e-9);
+}
+//----------------------------------------------------------------------------
+// convert time [s] of STIMER_CLOCKID to day time (0...86400 seconds)
+double stimer_daytime_of(double t)
+{
+  struct tm tm;
+  time_t time = (time_t) t;
+  double day;
 
-  t  = ((double) ts.tv_nsec) * 1e-9;
-  t += ((double) time);
-  return t;
+  localtime_r(&time, &tm);
+  day  = t - (double) time;
+  day += (double) (tm.tm_sec + tm.tm_min * 60 + tm.tm_hour * 3600);
+  return day;
 }
 //----------------------------------------------------------------------------
 // limit daytime to 0..24h
@@ -112,10 +141,10 @@ void stimer_fprint_daytime(FILE *stream, double t)
   fprintf(stream, "%02u:%02u:%02u.%06u", h, m, s, us);
 }
 //-----------------------------------------------------------------------------
-// SIGINT handler (Ctrl-C)
+// SIGINT (Ctrl-C) and SIGTERM handler
 static void stimer_sigint_handler(int signo)
 {
-  if (signo == SIGINT)
+  if (signo == SIGINT || signo == SIGTERM)
   {
     if (stimer_si.fn != (void (*)(void*)) NULL)
       stimer_si.fn(stimer_si.context); // callback user function
@@ -141,10 +170,11 @@ static void stimer_handler(int signo, siginfo_t *si, void *ucontext)
     }
     else
       timer->overrun += retv;
+    timer->expired += 1 + (retv > 0 ? retv : 0);
   }
 }
 //----------------------------------------------------------------------------
-// set SIGINT (CTRL+C) user handler
+// set SIGINT (CTRL+C) and SIGTERM user handler
 int stimer_sigint(void (*fn)(void *context), void *context)
 {
 #if 1
@@ -161,7 +191,7 @@ int stimer_sigint(void (*fn)(void *context), void *context)
   stimer_si.fn      = fn;
   stimer_si.context = context;
   
-  if (sigaction(SIGINT, &sa, NULL) < 0)
+  if (sigaction(SIGINT, &sa, NULL) < 0 || sigaction(SIGTERM, &sa, NULL) < 0)
   {
     perror("error in stimer_sigint_handler(): sigaction() failed; return -1");
     return -1;
@@ -170,7 +200,8 @@ int stimer_sigint(void (*fn)(void *context), void *context)
   stimer_si.fn      = fn;
   stimer_si.context = context;
   
-  if (signal(SIGINT, stimer_sigint_handler) < 0) // old school ;-)
+  if (signal(SIGINT,  stimer_sigint_handler) == SIG_ERR || // old school ;-)
+      signal(SIGTERM, stimer_sigint_handler) == SIG_ERR)
   {
     perror("error in stimer_sigint_handler(): signal() failed; return -1");
     return -1;
@@ -179,21 +210,26 @@ int stimer_sigint(void (*fn)(void *context), void *context)
   return 0;
 }
 //----------------------------------------------------------------------------
-// init timer
-int stimer_init(stimer_t *self, int (*fn)(void *context), void *context)
+// block SIGINT and SIGTERM in calling thread and return signalfd (non
+// blocking) to catch them in user event loop instead of stimer_sigint()
+// global handler
+// (return file descriptor or -1, errno is set)
+int stimer_sigint_fd()
 {
-  // save user callback funcion
-  self->fn = fn;
-
-  // save context
-  self->context = context;
-
-  // reset stop flag
-  self->stop = 0;
+  sigset_t mask;
 
-  // reset overrrun counter
-  self->overrun = 0;
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGINT);
+  sigaddset(&mask, SIGTERM);
+  if (sigprocmask(SIG_BLOCK, &mask, NULL) < 0)
+    return -1;
 
+  return signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+}
+//----------------------------------------------------------------------------
+// init POSIX timer with signal notification
+static int stimer_init_signal(stimer_t *self)
+{
   // establishing handler for signal STIMER_SIG
   memset((void*) &self->sa, 0, sizeof(self->sa));
   self->sa.sa_flags = SA_SIGINFO | SA_RESTART;
@@ -235,22 +271,259 @@ int stimer_init(stimer_t *self, int (*fn)(void *context), void *context)
   return 0;
 }
 //----------------------------------------------------------------------------
+// init timer (STIMER_BACKEND_SIGNAL)
+int stimer_init(stimer_t *self, int (*fn)(void *context), void *context)
+{
+  return stimer_init_ex(self, STIMER_BACKEND_SIGNAL, fn, context);
+}
+//----------------------------------------------------------------------------
+// init timer with selected backend (STIMER_BACKEND_*)
+int stimer_init_ex(stimer_t *self, int backend,
+                   int (*fn)(void *context), void *context)
+{
+  // save user callback funcion
+  self->fn = fn;
+
+  // save context
+  self->context = context;
+
+  // reset stop flag
+  self->stop = 0;
+
+  // reset overrrun counter
+  self->overrun = 0;
+  self->expired = 0;
+
+  // no PLL by default
+  self->pll = (struct spll_*) NULL;
+  self->period = self->deadline = self->next = self->wakeup = 0;
+  self->period_frac = self->phase = 0;
+
+  // reset clock step detector
+  self->offset  = self->mono = 0;
+  self->steps   = 0;
+  self->stepped = 0;
+  self->step    = 0.;
+
+  self->backend = backend;
+  self->fd      = -1;
+
+  // simulated clock without latency by default
+  self->now         = 0;
+  self->sim         = STIMER_SIM_NONE;
+  self->sim_a       = self->sim_b = 0.;
+  self->sim_seed    = 1;
+  self->sim_fn      = (double (*)(void*)) NULL;
+  self->sim_context = NULL;
+
+  self->uring        = (stimer_uring_t*) NULL;
+  self->write_errors = 0;
+
+  if (backend == STIMER_BACKEND_SIM || backend == STIMER_BACKEND_SLEEP)
+    return 0; // no kernel timer at all
+
+  if (backend == STIMER_BACKEND_URING)
+  { // timeouts are submitted by loop itself
+    self->uring = (stimer_uring_t*) malloc(sizeof(stimer_uring_t));
+    if (self->uring == (stimer_uring_t*) NULL)
+    {
+      perror("error in stimer_init(): malloc() failed; return -5");
+      return -5;
+    }
+    if (suring_init(&self->uring->ring, 2 * STIMER_URING_WRITES) < 0)
+    {
+      perror("error in stimer_init(): io_uring_setup() failed; return -6");
+      free((void*) self->uring);
+      self->uring = (stimer_uring_t*) NULL;
+      return -6;
+    }
+    self->uring->armed  = 0;
+    self->uring->writes = 0;
+    return 0;
+  }
+
+  if (backend == STIMER_BACKEND_TIMERFD)
+  {
+    self->fd = timerfd_create(STIMER_CLOCKID, TFD_CLOEXEC);
+    if (self->fd < 0)
+    {
+      perror("error in stimer_init(): timerfd_create() failed; return -4");
+      return -4;
+    }
+    return 0;
+  }
+
+  self->backend = STIMER_BACKEND_SIGNAL;
+  return stimer_init_signal(self);
+}
+//----------------------------------------------------------------------------
+// get backend by name ("signal", "timerfd"); return -1 if unknown
+int stimer_backend(const char *name)
+{
+  if (!strcmp(name, "signal"))  return STIMER_BACKEND_SIGNAL;
+  if (!strcmp(name, "timerfd")) return STIMER_BACKEND_TIMERFD;
+  if (!strcmp(name, "sim"))     return STIMER_BACKEND_SIM;
+  if (!strcmp(name, "sleep"))   return STIMER_BACKEND_SLEEP;
+  if (!strcmp(name, "uring"))   return STIMER_BACKEND_URING;
+  return -1;
+}
+//----------------------------------------------------------------------------
+// get backend name
+const char *stimer_backend_str(int backend)
+{
+  if (backend == STIMER_BACKEND_SIGNAL)  return "signal";
+  if (backend == STIMER_BACKEND_TIMERFD) return "timerfd";
+  if (backend == STIMER_BACKEND_SIM)     return "sim";
+  if (backend == STIMER_BACKEND_SLEEP)   return "sleep";
+  if (backend == STIMER_BACKEND_URING)   return "uring";
+  return "unknown";
+}
+//----------------------------------------------------------------------------
+// set simulated latency (STIMER_BACKEND_SIM) by spec string:
+// "none", "uniform:MIN,MAX", "exp:MIN,MEAN", "gauss:MEAN,DEV" (in us)
+// and PRNG seed; return 0 or -1 if spec is bad
+int stimer_sim(stimer_t *self, const char *spec, uint64_t seed)
+{
+  const char *arg = strchr(spec, ':');
+  char *end;
+  double a = 0., b = 0.;
+  int sim;
+
+  if      (!strcmp(spec, "none"))         sim = STIMER_SIM_NONE;
+  else if (!strncmp(spec, "uniform:", 8)) sim = STIMER_SIM_UNIFORM;
+  else if (!strncmp(spec, "exp:", 4))     sim = STIMER_SIM_EXP;
+  else if (!strncmp(spec, "gauss:", 6))   sim = STIMER_SIM_GAUSS;
+  else return -1;
+
+  if (arg != NULL)
+  { // two parameters in microseconds
+    a = strtod(arg + 1, &end);
+    if (end == arg + 1 || *end != ',') return -1;
+    b = strtod(end + 1, &end);
+    if (*end != '\0' || a < 0. || b < 0.) return -1;
+  }
+
+  self->sim      = sim;
+  self->sim_a    = a * 1e-6;
+  self->sim_b    = b * 1e-6;
+  self->sim_seed = seed ? seed : 1;
+  return 0;
+}
+//----------------------------------------------------------------------------
+// set user simulated latency generator (return latency in seconds)
+void stimer_sim_fn(stimer_t *self, double (*fn)(void *context),
+                   void *context)
+{
+  self->sim_fn      = fn;
+  self->sim_context = context;
+}
+//----------------------------------------------------------------------------
+// uniform random number in (0, 1) (xorshift64*)
+static double stimer_sim_random(stimer_t *self)
+{
+  uint64_t x = self->sim_seed;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  self->sim_seed = x;
+  x *= 0x2545F4914F6CDD1DULL;
+  return (((double) (x >> 11)) + 0.5) * (1. / 9007199254740992.);
+}
+//----------------------------------------------------------------------------
+// get next simulated wake-up latency [ns]
+static int64_t stimer_sim_latency(stimer_t *self)
+{
+  double t = 0.;
+
+  if (self->sim_fn != (double (*)(void*)) NULL)
+    t = self->sim_fn(self->sim_context);
+  else if (self->sim == STIMER_SIM_UNIFORM)
+    t = self->sim_a + (self->sim_b - self->sim_a) * stimer_sim_random(self);
+  else if (self->sim == STIMER_SIM_EXP)
+    t = self->sim_a - self->sim_b * log(stimer_sim_random(self));
+  else if (self->sim == STIMER_SIM_GAUSS)
+    t = fabs(self->sim_a + self->sim_b *
+             sqrt(-2. * log(stimer_sim_random(self))) *
+             cos(2. * M_PI * stimer_sim_random(self)));
+
+  return t > 0. ? (int64_t) (t * 1e9) : 0;
+}
+//----------------------------------------------------------------------------
+// get current time [ns] of timer clock (virtual for STIMER_BACKEND_SIM)
+int64_t stimer_time_ns(const stimer_t *self)
+{
+  struct timespec ts;
+  if (self->backend == STIMER_BACKEND_SIM)
+    return self->now;
+  clock_gettime(STIMER_CLOCKID, &ts);
+  return stimer_ts_to_ns(&ts);
+}
+//----------------------------------------------------------------------------
+// arm timer to `self->next` deadline with `self->period` interval
+static int stimer_arm(stimer_t *self)
+{
+  struct timespec ts;
+  int64_t delta;
+
+  self->ival.it_interval = stimer_ns_to_ts(self->period);
+
+  if (self->backend == STIMER_BACKEND_SIM   ||
+      self->backend == STIMER_BACKEND_SLEEP ||
+      self->backend == STIMER_BACKEND_URING)
+    return 0; // loop sleeps to `self->next` by itself
+
+  if (self->backend == STIMER_BACKEND_TIMERFD)
+  { // absolute deadline, read() return ECANCELED if clock was set
+    self->ival.it_value = stimer_ns_to_ts(self->next);
+    return timerfd_settime(self->fd,
+                           TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET,
+                           &self->ival, NULL);
+  }
+
+  // relative CLOCK_REALTIME timer runs on monotonic base, so clock steps
+  // don't move it; steps are detected by monotonic cross-check
+  clock_gettime(STIMER_CLOCKID, &ts);
+  delta = self->next - stimer_ts_to_ns(&ts);
+  if (delta < 1) delta = 1; // already passed, fire now
+  self->ival.it_value = stimer_ns_to_ts(delta);
+  return timer_settime(self->timerid, 0, &self->ival, NULL);
+}
+//----------------------------------------------------------------------------
 // start timer
 int stimer_start(stimer_t *self, double interval_ms)
 {
-  // unblock signal STIMER_SIG
-  sigemptyset(&self->mask);
-  sigaddset(&self->mask, STIMER_SIG);
-  if (sigprocmask(SIG_UNBLOCK, &self->mask, NULL) < 0)
-  {
-    perror("error in stimer_start(): sigprocmask(SIG_UNBLOCK) failed; return -1");
-    return -1;
+  return stimer_start_at(self, interval_ms,
+                         stimer_time_ns(self) + (int64_t) (interval_ms * 1e6));
+}
+//----------------------------------------------------------------------------
+// start timer with period in 32.32 fixed point ns
+static int stimer_start_fp(stimer_t *self, uint64_t period_fp, int64_t start)
+{
+  struct timespec ts;
+
+  if (self->backend == STIMER_BACKEND_SIGNAL)
+  { // unblock signal STIMER_SIG
+    sigemptyset(&self->mask);
+    sigaddset(&self->mask, STIMER_SIG);
+    if (sigprocmask(SIG_UNBLOCK, &self->mask, NULL) < 0)
+    {
+      perror("error in stimer_start(): sigprocmask(SIG_UNBLOCK) failed; return -1");
+      return -1;
+    }
   }
 
-  // start time
-  self->ival.it_value    = stimer_double_to_ts(((double) interval_ms) * 1e-3);
-  self->ival.it_interval = self->ival.it_value;
-  if (timer_settime(self->timerid, 0, &self->ival, NULL) < 0)
+  // monotonic cross-check origin
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  self->mono = stimer_ts_to_ns(&ts);
+
+  // start time (deadlines are tracked to allow shift of schedule)
+  self->period      = (int64_t) (period_fp >> 32);
+  self->period_frac = (uint32_t) period_fp;
+  self->phase       = 0;
+  self->next        = start;
+  self->deadline    = start - self->period;
+  self->offset      = stimer_time_ns(self) - self->mono;
+  if (stimer_arm(self) < 0)
   {
     perror("error in stimer_start(): timer_settime() failed; return -2");
     return -2;
@@ -259,46 +532,464 @@ int stimer_start(stimer_t *self, double interval_ms)
   return 0;
 }
 //----------------------------------------------------------------------------
+// start timer with first deadline at `start` [ns] (STIMER_CLOCKID),
+// e.g. common time base of several timers; fractional ns of interval
+// are kept (look stimer_start_hz())
+int stimer_start_at(stimer_t *self, double interval_ms, int64_t start)
+{
+  long double ns = (long double) interval_ms * 1e6L;
+  return stimer_start_fp(self, (uint64_t) llroundl(ns * 4294967296.L),
+                         start);
+}
+//----------------------------------------------------------------------------
+// start timer by frequency [Hz] with first deadline at `start` [ns];
+// fractional part of period is accumulated by phase accumulator (DDS),
+// so deadlines are whole ns but long-term average frequency is exact
+int stimer_start_hz(stimer_t *self, double hz, int64_t start)
+{
+  if (hz <= 0.)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  return stimer_start_fp(self,
+           (uint64_t) llroundl(1e9L * 4294967296.L / (long double) hz),
+           start);
+}
+//----------------------------------------------------------------------------
 // stop timer
 void stimer_stop(stimer_t *self)
 {
   self->stop = 1;
 }
 //----------------------------------------------------------------------------
-// timer main loop
-int stimer_loop(stimer_t *self)
+// shift next deadline (and all following) by `dt` seconds
+int stimer_shift(stimer_t *self, double dt)
 {
-  for (;;)
+  return stimer_shift_ns(self, (int64_t) llround(dt * 1e9));
+}
+//----------------------------------------------------------------------------
+// shift next deadline (and all following) by `dt` nanoseconds
+int stimer_shift_ns(stimer_t *self, int64_t dt)
+{
+  self->next += dt;
+  if (stimer_arm(self) < 0)
   {
-    // unlock timer signal
-    sigemptyset(&self->mask);
-    sigaddset(&self->mask, STIMER_SIG);
-    if (sigprocmask(SIG_UNBLOCK, &self->mask, NULL) < 0)
+    perror("error in stimer_shift(): timer_settime() failed; return -1");
+    return -1;
+  }
+  return 0;
+}
+//----------------------------------------------------------------------------
+// queue write of `len` bytes of `buf` to `fd` (offset 0) done by kernel
+// right after next deadline, in one io_uring_enter() with the wait
+// (STIMER_BACKEND_URING only, `buf` must be valid until deadline;
+// return 0 or -1 if queue is full or backend is other)
+int stimer_queue_write(stimer_t *self, int fd, const void *buf, unsigned len)
+{
+  stimer_uring_t *u = self->uring;
+
+  if (u == (stimer_uring_t*) NULL || u->writes >= STIMER_URING_WRITES)
+    return -1;
+
+  u->write[u->writes].fd  = fd;
+  u->write[u->writes].buf = buf;
+  u->write[u->writes].len = len;
+  u->writes++;
+  return 0;
+}
+//----------------------------------------------------------------------------
+// attach PLL/FLL (look "spll.h") to discipline deadlines (NULL to detach)
+void stimer_pll(stimer_t *self, struct spll_ *pll)
+{
+  self->pll = pll;
+}
+//----------------------------------------------------------------------------
+// detect realtime clock step by monotonic cross-check
+// (return 1 if step detected and schedule moved, 0 if not)
+static int stimer_check_step(stimer_t *self)
+{
+  struct timespec ts;
+  int64_t real, mono, step, limit;
+
+  if (self->backend == STIMER_BACKEND_SIM)
+    return 0; // virtual clock has no steps
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  mono = stimer_ts_to_ns(&ts);
+  clock_gettime(STIMER_CLOCKID, &ts);
+  real = stimer_ts_to_ns(&ts);
+
+  step  = (real - mono) - self->offset;
+  limit = (int64_t) (STIMER_STEP_MIN * 1e9) + (mono - self->mono) / 1000;
+  self->offset = real - mono; // follow slew
+  self->mono   = mono;
+
+  if (step > -limit && step < limit)
+    return 0;
+
+  // move schedule with the clock to keep period consistent
+  self->deadline += step;
+  self->next     += step;
+  self->step      = ((double) step) * 1e-9;
+  self->stepped   = 1;
+  self->steps++;
+  return 1;
+}
+//----------------------------------------------------------------------------
+// advance time `t` by `n` periods, fractional part of period is
+// accumulated by phase (DDS): carry adds 1 ns when phase wraps
+static inline int64_t stimer_advance(stimer_t *self, int64_t t, unsigned n)
+{
+  uint64_t acc;
+
+  if (self->period_frac == 0)
+    return t + (int64_t) n * self->period;
+
+  acc = (uint64_t) self->phase + (uint64_t) self->period_frac * n;
+  self->phase = (uint32_t) acc;
+  return t + (int64_t) n * self->period + (int64_t) (acc >> 32);
+}
+//----------------------------------------------------------------------------
+// count expirations and discipline next deadline by PLL
+static int stimer_expire(stimer_t *self, unsigned expired)
+{
+  double t_ref, shift;
+  int64_t ns = 0;
+  uint64_t acc;
+
+  if (stimer_check_step(self) && self->backend == STIMER_BACKEND_TIMERFD)
+  { // timer may fire too late or too early; ignore and re-arm
+    return stimer_arm(self);
+  }
+
+  // last expired deadline and next one
+  self->deadline = stimer_advance(self, self->next, expired - 1);
+  self->next     = stimer_advance(self, self->deadline, 1);
+
+  if (self->pll != (struct spll_*) NULL)
+  {
+    spll_t *pll = self->pll;
+    double t_local = stimer_deadline(self);
+    if (spll_ref_read(pll, t_local, &t_ref) > 0)
+      spll_update(pll, t_local, t_ref);
+
+    // sub-ns part of correction is carried by DDS phase (no dead zone
+    // and no bias of truncation), timer is re-armed by whole ns only
+    shift = spll_shift(pll) * 1e9;
+    ns    = (int64_t) floor(shift);
+    acc   = (uint64_t) self->phase +
+            (uint64_t) ((shift - (double) ns) * 4294967296.);
+    self->phase = (uint32_t) acc;
+    ns += (int64_t) (acc >> 32);
+  }
+
+  if (ns != 0)
+  {
+    if (stimer_shift_ns(self, ns) < 0)
+      return -1;
+  }
+  else if (self->period_frac &&
+           (self->backend == STIMER_BACKEND_SIGNAL ||
+            self->backend == STIMER_BACKEND_TIMERFD))
+  { // kernel reloads whole ns period: re-arm to DDS deadline
+    if (stimer_arm(self) < 0)
+      return -1;
+  }
+
+  return 1;
+}
+//----------------------------------------------------------------------------
+// wait timer signal (return number of expirations, 0 if none, -1 on error)
+static int stimer_wait_signal(stimer_t *self)
+{
+  unsigned expired;
+
+  // unlock timer signal
+  sigemptyset(&self->mask);
+  sigaddset(&self->mask, STIMER_SIG);
+  if (sigprocmask(SIG_UNBLOCK, &self->mask, NULL) < 0)
+  {
+    perror("error in stimer_main_loop(): sigprocmask() failed #1; exit");
+    return -1;
+  }
+
+  // sleep and wait signal
+  pause();
+
+  if (self->stop) return 0;
+
+  // lock timer signal for normal select() work
+  if (sigprocmask(SIG_BLOCK, &self->mask, NULL) < 0)
+  {
+    perror("error in stimer_main_loop(): sigprocmask() failed #2; exit");
+    return -1;
+  }
+
+  expired = self->expired;
+  self->expired = 0;
+  return (int) expired;
+}
+//----------------------------------------------------------------------------
+// wait timerfd (return number of expirations, 0 if none, -1 on error)
+static int stimer_wait_timerfd(stimer_t *self)
+{
+  uint64_t expired;
+  int retv = read(self->fd, &expired, sizeof(expired));
+
+  if (retv == sizeof(expired))
+  {
+    self->overrun += (unsigned) expired - 1;
+    return (int) expired;
+  }
+
+  if (retv < 0 && (errno == EINTR || errno == EAGAIN))
+    return 0; // interrupt by signal (SIGINT?) or nothing yet (stimer_fd())
+
+  if (retv < 0 && errno == ECANCELED)
+  { // realtime clock was set: move schedule and re-arm
+    stimer_check_step(self);
+    if (stimer_arm(self) < 0)
     {
-      perror("error in stimer_main_loop(): sigprocmask() failed #1; exit");
+      perror("error in stimer_main_loop(): timerfd_settime() failed; exit");
       return -1;
     }
+    return 0;
+  }
 
-    // sleep and wait signal
-    pause();
-    
-    if (self->stop) return 0;
+  perror("error in stimer_main_loop(): read(timerfd) failed; exit");
+  return -1;
+}
+//----------------------------------------------------------------------------
+// advance virtual clock to next deadline plus simulated latency
+// (return number of expirations, 0 if stopped)
+static int stimer_wait_sim(stimer_t *self)
+{
+  int64_t latency, expired;
 
-    // lock timer signal for normal select() work
-    if (sigprocmask(SIG_BLOCK, &self->mask, NULL) < 0)
+  if (self->stop) return 0;
+
+  latency = stimer_sim_latency(self);
+  expired = 1 + latency / self->period; // late wake-up lose expirations
+  self->overrun += (unsigned) (expired - 1);
+  self->now = self->next + latency;
+  return (int) expired;
+}
+//----------------------------------------------------------------------------
+// sleep to next deadline by clock_nanosleep() on monotonic clock
+// (return number of expirations, 0 if interrupted, -1 on error)
+static int stimer_wait_sleep(stimer_t *self)
+{
+  struct timespec ts;
+  int64_t late;
+  int retv;
+
+  // monotonic time of deadline (clock steps don't move it)
+  ts   = stimer_ns_to_ts(self->next - self->offset);
+  retv = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+  if (retv == EINTR) return 0;
+  if (retv != 0)
+  {
+    errno = retv;
+    perror("error in stimer_main_loop(): clock_nanosleep() failed; exit");
+    return -1;
+  }
+
+  // count lost expirations if wake up too late
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  late = stimer_ts_to_ns(&ts) - (self->next - self->offset);
+  if (late >= self->period)
+  {
+    self->overrun += (unsigned) (late / self->period);
+    return (int) (1 + late / self->period);
+  }
+  return 1;
+}
+//----------------------------------------------------------------------------
+// wait io_uring timeout at next deadline on monotonic clock, queued writes
+// are linked to it and done by kernel right after expiration
+// (return number of expirations, 0 if interrupted, -1 on error)
+static int stimer_wait_uring(stimer_t *self)
+{
+  stimer_uring_t *u = self->uring;
+  struct io_uring_sqe *sqe;
+  struct timespec ts;
+  uint64_t user_data;
+  int64_t late;
+  unsigned i;
+  int res, expired = 0;
+
+  if (!u->armed)
+  { // timeout -> write -> write ... (one chain, one syscall)
+    u->ts.tv_sec  = (self->next - self->offset) / STIMER_NS_PER_SECOND;
+    u->ts.tv_nsec = (self->next - self->offset) % STIMER_NS_PER_SECOND;
+
+    sqe = suring_sqe(&u->ring);
+    sqe->opcode        = IORING_OP_TIMEOUT;
+    sqe->fd            = -1;
+    sqe->addr          = (uint64_t) (uintptr_t) &u->ts;
+    sqe->len           = 1;
+    sqe->timeout_flags = IORING_TIMEOUT_ABS;
+    sqe->user_data     = STIMER_URING_TIMEOUT;
+    if (u->writes)
+    { // expiration (-ETIME) doesn't break the link
+      sqe->timeout_flags |= IORING_TIMEOUT_ETIME_SUCCESS;
+      sqe->flags         |= IOSQE_IO_LINK;
+    }
+
+    for (i = 0; i < u->writes; i++)
+    { // completion only on error
+      sqe = suring_sqe(&u->ring);
+      sqe->opcode    = IORING_OP_WRITE;
+      sqe->fd        = u->write[i].fd;
+      sqe->addr      = (uint64_t) (uintptr_t) u->write[i].buf;
+      sqe->len       = u->write[i].len;
+      sqe->off       = 0;
+      sqe->flags     = IOSQE_CQE_SKIP_SUCCESS |
+                       (i + 1 < u->writes ? IOSQE_IO_LINK : 0);
+      sqe->user_data = STIMER_URING_WRITE;
+    }
+    u->writes = 0;
+    u->armed  = 1;
+  }
+
+  if (suring_enter(&u->ring, 1) < 0)
+  {
+    if (errno == EINTR) return 0;
+    perror("error in stimer_main_loop(): io_uring_enter() failed; exit");
+    return -1;
+  }
+
+  while (suring_cqe(&u->ring, &user_data, &res))
+  {
+    if (user_data == STIMER_URING_WRITE)
+      self->write_errors++;
+    else if (res == -ETIME || res == 0)
+    {
+      u->armed = 0;
+      expired  = 1;
+    }
+    else
     {
-      perror("error in stimer_main_loop(): sigprocmask() failed #2; exit");
+      errno = -res;
+      perror("error in stimer_main_loop(): io_uring timeout failed; exit");
       return -1;
     }
+  }
+  if (!expired) return 0;
+
+  // count lost expirations if wake up too late
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  late = stimer_ts_to_ns(&ts) - (self->next - self->offset);
+  if (late >= self->period)
+  {
+    self->overrun += (unsigned) (late / self->period);
+    return (int) (1 + late / self->period);
+  }
+  return 1;
+}
+//----------------------------------------------------------------------------
+// free timer resources
+void stimer_free(stimer_t *self)
+{
+  if (self->backend == STIMER_BACKEND_TIMERFD)
+  {
+    if (self->fd >= 0) close(self->fd);
+    self->fd = -1;
+  }
+  else if (self->backend == STIMER_BACKEND_SIGNAL)
+    timer_delete(self->timerid);
+  else if (self->uring != (stimer_uring_t*) NULL)
+  {
+    suring_free(&self->uring->ring);
+    free((void*) self->uring);
+    self->uring = (stimer_uring_t*) NULL;
+  }
+}
+//----------------------------------------------------------------------------
+// timer main loop
+int stimer_loop(stimer_t *self)
+{
+  for (;;)
+  {
+    int retv = self->backend == STIMER_BACKEND_TIMERFD ?
+               stimer_wait_timerfd(self) :
+               self->backend == STIMER_BACKEND_SIM ?
+               stimer_wait_sim(self) :
+               self->backend == STIMER_BACKEND_SLEEP ?
+               stimer_wait_sleep(self) :
+               self->backend == STIMER_BACKEND_URING ?
+               stimer_wait_uring(self) :
+               stimer_wait_signal(self);
+
+    if (self->stop) return 0;
+    if (retv < 0) return -1;
+    if (retv == 0) continue; // not a timer expiration
+    self->wakeup = stimer_time_ns(self);
+
+    retv = stimer_expire(self, (unsigned) retv);
+    if (retv < 0) return -1;
+    if (retv == 0) continue; // clock step, re-armed
 
     if (self->fn != (int (*)(void*)) NULL)
     { // callback user function
-      int retv = self->fn(self->context);
+      retv = self->fn(self->context);
+      self->stepped = 0;
       if (retv)
         return retv;
     }
   } // for(;;)
 }
 //----------------------------------------------------------------------------
-/*** end of "stimer.c" file ***/
+// get file descriptor (non blocking) readable on timer expirations
+// (return file descriptor or -1 if backend has no one, errno is set)
+int stimer_fd(stimer_t *self)
+{
+  // process directed timer signal may be taken by any thread, others
+  // have no kernel timer or wait can't be split from submit
+  if (self->backend != STIMER_BACKEND_TIMERFD)
+  {
+    errno = EINVAL;
+    return -1;
+  }
 
+  // stimer_loop() can't be used after that
+  if (fcntl(self->fd, F_SETFL, fcntl(self->fd, F_GETFL) | O_NONBLOCK) < 0)
+    return -1;
+  return self->fd;
+}
+//----------------------------------------------------------------------------
+// non blocking dispatch of expirations pending on stimer_fd()
+// (return number of expirations, 0 if none or stopped, -1 on error)
+int stimer_dispatch(stimer_t *self)
+{
+  int expired, retv;
+
+  if (self->backend != STIMER_BACKEND_TIMERFD)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  expired = stimer_wait_timerfd(self);
+
+  if (expired <= 0) return expired;
+  if (self->stop)  return 0;
+  self->wakeup = stimer_time_ns(self);
+
+  retv = stimer_expire(self, (unsigned) expired);
+  if (retv < 0) return -1;
+  if (retv == 0) return 0; // clock step, re-armed
+
+  if (self->fn != (int (*)(void*)) NULL)
+  { // callback user function
+    retv = self->fn(self->context);
+    self->stepped = 0;
+    if (retv)
+      self->stop = 1;
+  }
+
+  return expired;
+}
+//----------------------------------------------------------------------------
+/*** end of "stimer.c" file ***/
@@ -21,9 +21,39 @@
 // timer signal
 #define STIMER_SIG SIGRTMIN
 
+// timer backends (how to wait for expiration)
+#define STIMER_BACKEND_SIGNAL  0 // POSIX timer + STIMER_SIG + pause()
+#define STIMER_BACKEND_TIMERFD 1 // timerfd + read() with cancel-on-set
+#define STIMER_BACKEND_SIM     2 // simulated (virtual) clock, no real waits
+#define STIMER_BACKEND_SLEEP   3 // clock_nanosleep(CLOCK_MONOTONIC, ABSTIME)
+#define STIMER_BACKEND_URING   4 // io_uring timeout + linked writes
+
+// max queued writes per tick (STIMER_BACKEND_URING)
+#define STIMER_URING_WRITES 64
+
+// simulated wake-up latency distributions (STIMER_BACKEND_SIM)
+#define STIMER_SIM_NONE    0 // zero latency
+#define STIMER_SIM_UNIFORM 1 // uniform in [a, b] seconds
+#define STIMER_SIM_EXP     2 // a + exponential with mean b seconds
+#define STIMER_SIM_GAUSS   3 // |gauss(a, b)| seconds (mean, deviation)
+
+// min realtime clock step to detect [s] (plus 1000 ppm of elapsed time)
+#define STIMER_STEP_MIN 0.0005
+
+// inline macro (platform depended)
+#ifndef   STIMER_INLINE
+#  define STIMER_INLINE static inline
+#endif // STIMER_INLINE
+
 // seconds per day (24*60*60)
 #define STIMER_SECONDS_PER_DAY 86400.
 
+// nanoseconds per second
+#define STIMER_NS_PER_SECOND 1000000000LL
+
+//----------------------------------------------------------------------------
+struct spll_; // look "spll.h"
+struct stimer_uring_; // io_uring state (STIMER_BACKEND_URING)
 //----------------------------------------------------------------------------
 // `ti_t` type structure
 typedef struct stimer_ {
@@ -31,6 +61,29 @@ typedef struct stimer_ {
   int (*fn)(void *context);
   void *context;
   unsigned overrun;
+  unsigned expired;   // expirations counter (set by signal handler)
+  int64_t period;     // timer period [ns]
+  uint32_t period_frac; // fractional part of period [2^-32 ns]
+  uint32_t phase;     // DDS phase of `period_frac` and PLL shift [2^-32 ns]
+  int64_t deadline;   // last expired deadline [ns] (STIMER_CLOCKID)
+  int64_t next;       // next armed deadline [ns]
+  int64_t wakeup;     // wake-up time of last expiration [ns]
+  struct spll_ *pll;  // PLL/FLL to discipline deadlines (or NULL)
+  int backend;        // STIMER_BACKEND_*
+  int fd;             // timerfd (STIMER_BACKEND_TIMERFD)
+  int64_t offset;     // CLOCK_REALTIME - CLOCK_MONOTONIC at last check [ns]
+  int64_t mono;       // CLOCK_MONOTONIC at last check [ns]
+  unsigned steps;     // number of detected realtime clock steps
+  int stepped;        // 1 if clock step detected since last callback
+  double step;        // last clock step [s]
+  int64_t now;        // virtual time [ns] (STIMER_BACKEND_SIM)
+  int sim;            // latency distribution (STIMER_SIM_*)
+  double sim_a, sim_b;   // latency distribution parameters [s]
+  uint64_t sim_seed;     // PRNG state
+  double (*sim_fn)(void *context); // user latency [s] generator (or NULL)
+  void *sim_context;
+  struct stimer_uring_ *uring; // ring and queued writes (STIMER_BACKEND_URING)
+  unsigned write_errors;       // failed queued writes (STIMER_BACKEND_URING)
   sigset_t mask;
   struct sigevent sev;
   struct sigaction sa;
@@ -49,6 +102,9 @@ int stimer_realtime();
 // get day time (0...86400 seconds)
 double stimer_daytime();
 //----------------------------------------------------------------------------
+// convert time [s] of STIMER_CLOCKID to day time (0...86400 seconds)
+double stimer_daytime_of(double t);
+//----------------------------------------------------------------------------
 // limit daytime to 0..24h
 double stimer_limit_daytime(double t);
 //----------------------------------------------------------------------------
@@ -58,27 +114,147 @@ double stimer_limit_delta(double t);
 // convert time in seconds to `struct timespec`
 struct timespec stimer_double_to_ts(double t);
 //----------------------------------------------------------------------------
+// convert `struct timespec` to nanoseconds
+STIMER_INLINE int64_t stimer_ts_to_ns(const struct timespec *ts)
+{
+  return ((int64_t) ts->tv_sec) * STIMER_NS_PER_SECOND + ts->tv_nsec;
+}
+//----------------------------------------------------------------------------
+// convert nanoseconds to `struct timespec`
+STIMER_INLINE struct timespec stimer_ns_to_ts(int64_t ns)
+{
+  struct timespec ts;
+  ts.tv_sec  = (time_t) (ns / STIMER_NS_PER_SECOND);
+  ts.tv_nsec = (long)   (ns % STIMER_NS_PER_SECOND);
+  return ts;
+}
+//----------------------------------------------------------------------------
 // sleep [ms] (based on standart nanosleep())
 void stimer_sleep_ms(double ms);
 //----------------------------------------------------------------------------
 // print day time to file in next format: HH:MM:SS.mmmuuu
 void stimer_fprint_daytime(FILE *stream, double daytime);
 //----------------------------------------------------------------------------
-// set SIGINT (CTRL+C) user handler
+// set SIGINT (CTRL+C) and SIGTERM user handler
 int stimer_sigint(void (*fn)(void *context), void *context);
 //----------------------------------------------------------------------------
-// init timer
+// block SIGINT and SIGTERM in calling thread and return signalfd (non
+// blocking) to catch them in user event loop instead of stimer_sigint()
+// global handler
+// (return file descriptor or -1, errno is set)
+int stimer_sigint_fd();
+//----------------------------------------------------------------------------
+// init timer (STIMER_BACKEND_SIGNAL)
 int stimer_init(stimer_t *self, int (*fn)(void *context), void *context);
 //----------------------------------------------------------------------------
+// init timer with selected backend (STIMER_BACKEND_*)
+int stimer_init_ex(stimer_t *self, int backend,
+                   int (*fn)(void *context), void *context);
+//----------------------------------------------------------------------------
+// set simulated latency (STIMER_BACKEND_SIM) by spec string:
+// "none", "uniform:MIN,MAX", "exp:MIN,MEAN", "gauss:MEAN,DEV" (in us)
+// and PRNG seed; return 0 or -1 if spec is bad
+int stimer_sim(stimer_t *self, const char *spec, uint64_t seed);
+//----------------------------------------------------------------------------
+// set user simulated latency generator (return latency in seconds)
+void stimer_sim_fn(stimer_t *self, double (*fn)(void *context),
+                   void *context);
+//----------------------------------------------------------------------------
+// get backend by name ("signal", "timerfd", "sim", "sleep", "uring");
+// return -1 if unknown
+int stimer_backend(const char *name);
+//----------------------------------------------------------------------------
+// get backend name
+const char *stimer_backend_str(int backend);
+//----------------------------------------------------------------------------
 // start timer
 int stimer_start(stimer_t *self, double interval_ms);
 //----------------------------------------------------------------------------
+// start timer with first deadline at `start` [ns] (STIMER_CLOCKID),
+// e.g. common time base of several timers; fractional ns of interval
+// are kept (look stimer_start_hz())
+int stimer_start_at(stimer_t *self, double interval_ms, int64_t start);
+//----------------------------------------------------------------------------
+// start timer by frequency [Hz] with first deadline at `start` [ns];
+// fractional part of period is accumulated by phase accumulator (DDS),
+// so deadlines are whole ns but long-term average frequency is exact
+int stimer_start_hz(stimer_t *self, double hz, int64_t start);
+//----------------------------------------------------------------------------
+// get period [ns] with fractional part
+STIMER_INLINE double stimer_period_ns(const stimer_t *self)
+{
+  return ((double) self->period) +
+         ((double) self->period_frac) * (1. / 4294967296.);
+}
+//----------------------------------------------------------------------------
 // stop timer
 void stimer_stop(stimer_t *self);
 //----------------------------------------------------------------------------
+// shift next deadline (and all following) by `dt` seconds
+int stimer_shift(stimer_t *self, double dt);
+//----------------------------------------------------------------------------
+// shift next deadline (and all following) by `dt` nanoseconds
+// (exact, e.g. for variable intervals of swave edge table)
+int stimer_shift_ns(stimer_t *self, int64_t dt);
+//----------------------------------------------------------------------------
+// queue write of `len` bytes of `buf` to `fd` (offset 0) done by kernel
+// right after next deadline, in one io_uring_enter() with the wait
+// (STIMER_BACKEND_URING only, `buf` must be valid until deadline;
+// return 0 or -1 if queue is full or backend is other)
+int stimer_queue_write(stimer_t *self, int fd, const void *buf, unsigned len);
+//----------------------------------------------------------------------------
+// attach PLL/FLL (look "spll.h") to discipline deadlines (NULL to detach)
+void stimer_pll(stimer_t *self, struct spll_ *pll);
+//----------------------------------------------------------------------------
+// return 1 if realtime clock step detected since last callback
+// (time difference with previous tick is not valid)
+STIMER_INLINE int stimer_stepped(const stimer_t *self)
+{
+  return self->stepped;
+}
+//----------------------------------------------------------------------------
+// get current time [ns] of timer clock (virtual for STIMER_BACKEND_SIM)
+int64_t stimer_time_ns(const stimer_t *self);
+//----------------------------------------------------------------------------
+// get current time [s] of timer clock (virtual for STIMER_BACKEND_SIM)
+STIMER_INLINE double stimer_time(const stimer_t *self)
+{
+  return ((double) stimer_time_ns(self)) * 1e-9;
+}
+//----------------------------------------------------------------------------
+// get last expired deadline in seconds (STIMER_CLOCKID)
+STIMER_INLINE double stimer_deadline(const stimer_t *self)
+{
+  return ((double) self->deadline) * 1e-9;
+}
+//----------------------------------------------------------------------------
+// free timer resources
+void stimer_free(stimer_t *self);
+//----------------------------------------------------------------------------
 // timer main loop
 int stimer_loop(stimer_t *self);
 //----------------------------------------------------------------------------
+// get file descriptor (non blocking) readable on timer expirations to
+// wait it in user event loop (epoll, libuv, ...) instead of stimer_loop();
+// call stimer_dispatch() when it is readable
+// STIMER_BACKEND_TIMERFD only: timerfd itself (any number of timers);
+// other backends return -1 with EINVAL (signal of POSIX timer is process
+// directed and may be taken by any thread, so no per-loop descriptor)
+// (return file descriptor or -1 if backend has no one, errno is set)
+int stimer_fd(stimer_t *self);
+//----------------------------------------------------------------------------
+// non blocking dispatch of expirations pending on stimer_fd(): discipline
+// next deadline and call user function once; non zero result of user
+// function stops timer (look stimer_stopped())
+// (return number of expirations, 0 if none or stopped, -1 on error)
+int stimer_dispatch(stimer_t *self);
+//----------------------------------------------------------------------------
+// return 1 if timer is stopped by stimer_stop() or by user function
+STIMER_INLINE int stimer_stopped(const stimer_t *self)
+{
+  return self->stop;
+}
+//----------------------------------------------------------------------------
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -0,0 +1,118 @@
+/*
+ * Simple Linux timer wrapper (C++17 header only layer over `stimer_t`)
+ * File: "stimer.hpp"
+ */
+
+#ifndef STIMER_HPP
+#define STIMER_HPP
+//-----------------------------------------------------------------------------
+#include "stimer.h"
+#include <type_traits> // std::is_invocable_v, std::is_void_v
+#include <utility>     // std::move()
+//-----------------------------------------------------------------------------
+namespace stimer {
+//-----------------------------------------------------------------------------
+// periodic timer with lambda callback instead of `void *context`:
+// callback type is known at compile time, so its body is inlined into
+// the single trampoline called by stimer_loop();
+// callback is `fn()` or `fn(Timer&)` returning void or int (non zero stops
+// loop and is returned by loop())
+template <class F>
+class Timer {
+public:
+  explicit Timer(F fn, int backend = STIMER_BACKEND_SIGNAL) :
+    fn_(std::move(fn))
+  {
+    err_ = stimer_init_ex(&timer_, backend, &Timer::call, (void*) this);
+  }
+
+  ~Timer() { if (err_ == 0) stimer_free(&timer_); }
+
+  // timer keeps pointer to this object
+  Timer(const Timer&)            = delete;
+  Timer& operator=(const Timer&) = delete;
+
+  // 0 or error code of stimer_init_ex()
+  int error() const { return err_; }
+  explicit operator bool() const { return err_ == 0; }
+
+  // start timer
+  int start(double interval_ms) { return stimer_start(&timer_, interval_ms); }
+
+  // start timer by frequency [Hz] (fractional period by DDS)
+  int start_hz(double hz)
+  {
+    return stimer_start_hz(&timer_, hz, stimer_time_ns(&timer_) +
+                           (int64_t) (1e9 / hz));
+  }
+
+  // stop loop (may be called from callback or signal handler)
+  void stop() { stimer_stop(&timer_); }
+
+  // run loop (return 0 on stop, callback result or error code < 0)
+  int loop() { return stimer_loop(&timer_); }
+
+  // file descriptor for user event loop (instead of loop()) and
+  // non blocking dispatch when it is readable (look stimer_fd())
+  int fd()       { return stimer_fd(&timer_); }
+  int dispatch() { return stimer_dispatch(&timer_); }
+  bool stopped() const { return stimer_stopped(&timer_); }
+
+  // simulated latency (STIMER_BACKEND_SIM)
+  int sim(const char *spec, uint64_t seed = 0)
+  {
+    return stimer_sim(&timer_, spec, seed);
+  }
+
+  // current time, last deadline and wake-up time [ns] (STIMER_CLOCKID)
+  int64_t time_ns()  const { return stimer_time_ns(&timer_); }
+  int64_t deadline() const { return timer_.deadline; }
+  int64_t wakeup()   const { return timer_.wakeup; }
+
+  // 1 if realtime clock step detected since last callback
+  bool stepped() const { return stimer_stepped(&timer_); }
+
+  // underlying C structure
+  stimer_t       *native()       { return &timer_; }
+  const stimer_t *native() const { return &timer_; }
+
+private:
+  static int call(void *context)
+  {
+    Timer *self = static_cast<Timer*>(context);
+
+    if constexpr (std::is_invocable_v<F&, Timer&>)
+    {
+      using R = std::invoke_result_t<F&, Timer&>;
+      if constexpr (std::is_void_v<R>)
+      {
+        self->fn_(*self);
+        return 0;
+      }
+      else
+        return (int) self->fn_(*self);
+    }
+    else
+    {
+      using R = std::invoke_result_t<F&>;
+      if constexpr (std::is_void_v<R>)
+      {
+        self->fn_();
+        return 0;
+      }
+      else
+        return (int) self->fn_();
+    }
+  }
+
+  stimer_t timer_;
+  F fn_;
+  int err_ = -1;
+};
+//-----------------------------------------------------------------------------
+} // namespace stimer
+//-----------------------------------------------------------------------------
+#endif // STIMER_HPP
+
+/*** end of "stimer.hpp" file ***/
+
@@ -0,0 +1,131 @@
+/*
+ * Minimal io_uring wrapper by raw syscalls (no liburing)
+ * File: "suring.c"
+ */
+//-----------------------------------------------------------------------------
+#include "suring.h"      // `suring_t`
+#include <string.h>      // memset()
+#include <unistd.h>      // syscall(), close()
+#include <sys/mman.h>    // mmap(), munmap()
+#include <sys/syscall.h> // __NR_io_uring_setup, __NR_io_uring_enter
+//-----------------------------------------------------------------------------
+// setup ring with `entries` SQE (return 0 or -1, errno is set)
+int suring_init(suring_t *self, unsigned entries)
+{
+  struct io_uring_params p;
+  void *ptr;
+
+  memset((void*) self, 0, sizeof(suring_t));
+  memset((void*) &p, 0, sizeof(p));
+
+  self->fd = (int) syscall(__NR_io_uring_setup, entries, &p);
+  if (self->fd < 0) return -1;
+
+  self->sq_entries = p.sq_entries;
+  self->sq_size    = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  self->cq_size    = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  self->sqes_size  = p.sq_entries * sizeof(struct io_uring_sqe);
+  if ((p.features & IORING_FEAT_SINGLE_MMAP) && self->cq_size > self->sq_size)
+    self->sq_size = self->cq_size;
+
+  ptr = mmap(NULL, self->sq_size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, self->fd, IORING_OFF_SQ_RING);
+  if (ptr == MAP_FAILED) goto fail;
+  self->sq_ptr = ptr;
+
+  if (p.features & IORING_FEAT_SINGLE_MMAP)
+    self->cq_ptr = ptr;
+  else
+  {
+    ptr = mmap(NULL, self->cq_size, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, self->fd, IORING_OFF_CQ_RING);
+    if (ptr == MAP_FAILED) goto fail;
+    self->cq_ptr = ptr;
+  }
+
+  ptr = mmap(NULL, self->sqes_size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, self->fd, IORING_OFF_SQES);
+  if (ptr == MAP_FAILED) goto fail;
+  self->sqes = (struct io_uring_sqe*) ptr;
+
+  self->sq_head  = (unsigned*) ((char*) self->sq_ptr + p.sq_off.head);
+  self->sq_tail  = (unsigned*) ((char*) self->sq_ptr + p.sq_off.tail);
+  self->sq_mask  = (unsigned*) ((char*) self->sq_ptr + p.sq_off.ring_mask);
+  self->sq_array = (unsigned*) ((char*) self->sq_ptr + p.sq_off.array);
+  self->cq_head  = (unsigned*) ((char*) self->cq_ptr + p.cq_off.head);
+  self->cq_tail  = (unsigned*) ((char*) self->cq_ptr + p.cq_off.tail);
+  self->cq_mask  = (unsigned*) ((char*) self->cq_ptr + p.cq_off.ring_mask);
+  self->cqes     = (struct io_uring_cqe*) ((char*) self->cq_ptr +
+                                           p.cq_off.cqes);
+  return 0;
+
+fail:
+  suring_free(self);
+  return -1;
+}
+//-----------------------------------------------------------------------------
+// get zeroed SQE to prepare (NULL if SQ is full)
+struct io_uring_sqe *suring_sqe(suring_t *self)
+{
+  unsigned head = __atomic_load_n(self->sq_head, __ATOMIC_ACQUIRE);
+  unsigned tail = *self->sq_tail + self->pending;
+  unsigned i;
+
+  if (tail - head >= self->sq_entries)
+    return (struct io_uring_sqe*) NULL;
+
+  i = tail & *self->sq_mask;
+  self->sq_array[i] = i;
+  self->pending++;
+  memset((void*) (self->sqes + i), 0, sizeof(struct io_uring_sqe));
+  return self->sqes + i;
+}
+//-----------------------------------------------------------------------------
+// submit prepared SQE and wait for `min_complete` CQE
+// (return number of submitted SQE or -1, errno is set, e.g. EINTR)
+int suring_enter(suring_t *self, unsigned min_complete)
+{
+  unsigned n = self->pending;
+  int retv;
+
+  // publish SQE to kernel
+  __atomic_store_n(self->sq_tail, *self->sq_tail + n, __ATOMIC_RELEASE);
+  self->pending = 0;
+
+  retv = (int) syscall(__NR_io_uring_enter, self->fd, n, min_complete,
+                       min_complete ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+  return retv;
+}
+//-----------------------------------------------------------------------------
+// pop one CQE (return 1 or 0 if CQ is empty)
+int suring_cqe(suring_t *self, uint64_t *user_data, int *res)
+{
+  unsigned head = *self->cq_head;
+  const struct io_uring_cqe *cqe;
+
+  if (head == __atomic_load_n(self->cq_tail, __ATOMIC_ACQUIRE))
+    return 0;
+
+  cqe = self->cqes + (head & *self->cq_mask);
+  *user_data = cqe->user_data;
+  *res       = cqe->res;
+  __atomic_store_n(self->cq_head, head + 1, __ATOMIC_RELEASE);
+  return 1;
+}
+//-----------------------------------------------------------------------------
+// free ring
+void suring_free(suring_t *self)
+{
+  if (self->sqes)
+    munmap((void*) self->sqes, self->sqes_size);
+  if (self->cq_ptr && self->cq_ptr != self->sq_ptr)
+    munmap(self->cq_ptr, self->cq_size);
+  if (self->sq_ptr)
+    munmap(self->sq_ptr, self->sq_size);
+  if (self->fd >= 0)
+    close(self->fd);
+  memset((void*) self, 0, sizeof(suring_t));
+  self->fd = -1;
+}
+//-----------------------------------------------------------------------------
+/*** end of "suring.c" file ***/
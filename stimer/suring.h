@@ -0,0 +1,54 @@
+/*
+ * Minimal io_uring wrapper by raw syscalls (no liburing)
+ * File: "suring.h"
+ */
+
+#ifndef SURING_H
+#define SURING_H
+//-----------------------------------------------------------------------------
+#include <stdint.h>         // `uint64_t`
+#include <stddef.h>         // `size_t`
+#include <linux/io_uring.h> // `struct io_uring_sqe`, IORING_*
+//-----------------------------------------------------------------------------
+// `suring_t` type structure (mapped SQ/CQ rings)
+typedef struct suring_ {
+  int fd;                     // io_uring file descriptor (or -1)
+  unsigned sq_entries;
+  unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+  struct io_uring_sqe *sqes;
+  unsigned *cq_head, *cq_tail, *cq_mask;
+  struct io_uring_cqe *cqes;
+  void *sq_ptr, *cq_ptr;      // mapped rings
+  size_t sq_size, cq_size, sqes_size;
+  unsigned pending;           // prepared but not submitted SQE
+} suring_t;
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+// setup ring with `entries` SQE (return 0 or -1, errno is set)
+int suring_init(suring_t *self, unsigned entries);
+//-----------------------------------------------------------------------------
+// get zeroed SQE to prepare (NULL if SQ is full)
+struct io_uring_sqe *suring_sqe(suring_t *self);
+//-----------------------------------------------------------------------------
+// submit prepared SQE and wait for `min_complete` CQE
+// (return number of submitted SQE or -1, errno is set, e.g. EINTR)
+int suring_enter(suring_t *self, unsigned min_complete);
+//-----------------------------------------------------------------------------
+// pop one CQE (return 1 or 0 if CQ is empty)
+int suring_cqe(suring_t *self, uint64_t *user_data, int *res);
+//-----------------------------------------------------------------------------
+// free ring
+void suring_free(suring_t *self);
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+#endif // SURING_H
+
+/*** end of "suring.h" file ***/
+
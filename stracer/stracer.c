@@ -0,0 +1,75 @@
+/*
+ * Simple in-process trace ring with per-record stage timestamps
+ * File: "stracer.c"
+ */
+//-----------------------------------------------------------------------------
+#include "stracer.h" // `stracer_t`
+#include <stdlib.h>  // malloc(), free()
+#include <string.h>  // memset()
+//-----------------------------------------------------------------------------
+// init trace ring of `size` records with `stages` named timestamps
+// (return 0 or -1 if can't allocate)
+int stracer_init(stracer_t *self, unsigned size,
+                 int stages, const char *const *names)
+{
+  self->size      = size ? size : 1;
+  self->head      = 0;
+  self->stages    = stages < STRACER_STAGES_MAX ? stages : STRACER_STAGES_MAX;
+  self->names     = names;
+  self->triggered = 0;
+  self->trigger   = 0;
+  self->post      = 0;
+  self->frozen    = 0;
+
+  self->recs = (stracer_rec_t*) malloc(sizeof(stracer_rec_t) * self->size);
+  if (self->recs == (stracer_rec_t*) NULL)
+    return -1;
+
+  // touch pages now (no page faults in hot path)
+  memset((void*) self->recs, 0, sizeof(stracer_rec_t) * self->size);
+  return 0;
+}
+//-----------------------------------------------------------------------------
+// free trace ring
+void stracer_free(stracer_t *self)
+{
+  free((void*) self->recs);
+  self->recs = (stracer_rec_t*) NULL;
+  self->size = self->head = 0;
+}
+//-----------------------------------------------------------------------------
+// fire trigger on last record: keep `post` more records and freeze ring
+// (only first trigger is used)
+void stracer_trigger(stracer_t *self, unsigned post)
+{
+  if (self->triggered || self->head == 0) return;
+  self->triggered = 1;
+  self->trigger   = self->head - 1;
+  self->post      = post < self->size ? post : self->size - 1;
+}
+//-----------------------------------------------------------------------------
+// dump ring: seq, first stage time [s] and other stages relative to first
+// stage [us]; trigger record is marked by '*'
+void stracer_dump(const stracer_t *self, FILE *stream)
+{
+  unsigned i, first = self->head > self->size ? self->head - self->size : 0;
+  int j;
+
+  fprintf(stream, "#%9s %20s", "seq", self->names[0]);
+  for (j = 1; j < self->stages; j++)
+    fprintf(stream, " %12s", self->names[j]);
+  fprintf(stream, "\n");
+
+  for (i = first; i < self->head; i++)
+  {
+    const stracer_rec_t *rec = self->recs + i % self->size;
+    fprintf(stream, "%c%9u %20.9f",
+            (self->triggered && i == self->trigger) ? '*' : ' ',
+            rec->seq, ((double) rec->t[0]) * 1e-9);
+    for (j = 1; j < self->stages; j++)
+      fprintf(stream, " %12.3f", ((double) (rec->t[j] - rec->t[0])) * 1e-3);
+    fprintf(stream, "\n");
+  }
+}
+//-----------------------------------------------------------------------------
+/*** end of "stracer.c" file ***/
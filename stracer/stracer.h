@@ -0,0 +1,82 @@
+/*
+ * Simple in-process trace ring with per-record stage timestamps
+ * File: "stracer.h"
+ */
+
+#ifndef STRACER_H
+#define STRACER_H
+//-----------------------------------------------------------------------------
+#include <stdint.h> // `int64_t`
+#include <stdio.h>  // `FILE`
+//-----------------------------------------------------------------------------
+// max number of stage timestamps per record
+#define STRACER_STAGES_MAX 8
+
+// inline macro (platform depended)
+#ifndef   STRACER_INLINE
+#  define STRACER_INLINE static inline
+#endif // STRACER_INLINE
+//-----------------------------------------------------------------------------
+// trace record
+typedef struct stracer_rec_ {
+  unsigned seq;                   // sequence number (e.g. tick counter)
+  int64_t  t[STRACER_STAGES_MAX]; // stage timestamps [ns]
+} stracer_rec_t;
+//-----------------------------------------------------------------------------
+// `stracer_t` type structure
+typedef struct stracer_ {
+  stracer_rec_t *recs;      // preallocated ring
+  unsigned size;            // ring size (records)
+  unsigned head;            // number of records written
+  int stages;               // number of stages
+  const char *const *names; // stage names
+  int triggered;            // 1 if trigger fired
+  unsigned trigger;         // record index (head) of trigger
+  unsigned post;            // records to keep after trigger
+  int frozen;               // 1 if ring is frozen (no more records)
+} stracer_t;
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+// init trace ring of `size` records with `stages` named timestamps
+// (return 0 or -1 if can't allocate)
+int stracer_init(stracer_t *self, unsigned size,
+                 int stages, const char *const *names);
+//-----------------------------------------------------------------------------
+// free trace ring
+void stracer_free(stracer_t *self);
+//-----------------------------------------------------------------------------
+// get next record to fill (NULL if ring is frozen after trigger)
+STRACER_INLINE stracer_rec_t *stracer_next(stracer_t *self, unsigned seq)
+{
+  stracer_rec_t *rec;
+  if (self->frozen) return (stracer_rec_t*) 0;
+  if (self->triggered && self->head - self->trigger > self->post)
+  {
+    self->frozen = 1;
+    return (stracer_rec_t*) 0;
+  }
+  rec = self->recs + self->head % self->size;
+  rec->seq = seq;
+  self->head++;
+  return rec;
+}
+//-----------------------------------------------------------------------------
+// fire trigger on last record: keep `post` more records and freeze ring
+// (only first trigger is used)
+void stracer_trigger(stracer_t *self, unsigned post);
+//-----------------------------------------------------------------------------
+// dump ring: seq, first stage time [s] and other stages relative to first
+// stage [us]; trigger record is marked by '*'
+void stracer_dump(const stracer_t *self, FILE *stream);
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+#endif // STRACER_H
+
+/*** end of "stracer.h" file ***/
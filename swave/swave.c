@@ -0,0 +1,259 @@
+/*
+ * Simple waveform compiler: pulse sequence spec -> flat edge table
+ * File: "swave.c"
+ */
+//-----------------------------------------------------------------------------
+#include "swave.h"  // `swave_t`
+#include <stdlib.h> // malloc(), realloc(), free(), aligned_alloc()
+#include <string.h> // memcpy()
+//-----------------------------------------------------------------------------
+// parser state
+typedef struct swave_parser_ {
+  const char *p;       // current char
+  swave_edge_t *edges; // growing table (not merged)
+  unsigned count, size;
+} swave_parser_t;
+//-----------------------------------------------------------------------------
+// skip spaces and commas
+static void swave_skip(swave_parser_t *ps)
+{
+  while (*ps->p == ' ' || *ps->p == '\t' || *ps->p == ',' ||
+         *ps->p == '\n' || *ps->p == '\r')
+    ps->p++;
+}
+//-----------------------------------------------------------------------------
+// append edge (return SWAVE_ERR_*)
+static int swave_push(swave_parser_t *ps, int64_t delta_ns, uint32_t mask)
+{
+  if (ps->count >= SWAVE_EDGES_MAX)
+    return SWAVE_ERR_SIZE;
+
+  if (ps->count == ps->size)
+  {
+    unsigned size = ps->size ? ps->size * 2 : 64;
+    swave_edge_t *edges = (swave_edge_t*)
+                          realloc(ps->edges, sizeof(swave_edge_t) * size);
+    if (edges == (swave_edge_t*) NULL) return SWAVE_ERR_ALLOC;
+    ps->edges = edges;
+    ps->size  = size;
+  }
+
+  ps->edges[ps->count].delta_ns = delta_ns;
+  ps->edges[ps->count].mask     = mask;
+  ps->edges[ps->count].reserved = 0;
+  ps->count++;
+  return SWAVE_ERR_NONE;
+}
+//-----------------------------------------------------------------------------
+// parse unsigned number; return 1 if decimal, 2 if 0x hex, 0 if no digits
+static int swave_number(swave_parser_t *ps, uint64_t *val)
+{
+  const char *p = ps->p;
+  uint64_t v = 0;
+
+  if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+  {
+    for (p += 2; ; p++)
+    {
+      int d = (*p >= '0' && *p <= '9') ? *p - '0' :
+              (*p >= 'a' && *p <= 'f') ? *p - 'a' + 10 :
+              (*p >= 'A' && *p <= 'F') ? *p - 'A' + 10 : -1;
+      if (d < 0) break;
+      v = v * 16 + d;
+    }
+    if (p == ps->p + 2) return 0;
+    ps->p = p;
+    *val = v;
+    return 2;
+  }
+  else
+  {
+    for (; *p >= '0' && *p <= '9'; p++)
+      v = v * 10 + (*p - '0');
+    if (p == ps->p) return 0;
+  }
+
+  ps->p = p;
+  *val = v;
+  return 1;
+}
+//-----------------------------------------------------------------------------
+// parse time "INT[.FRAC][ns|us|ms|s]" to nanoseconds (exact integer math)
+static int swave_time(swave_parser_t *ps, int64_t *ns)
+{
+  const char *p = ps->p;
+  int64_t ip = 0, fp = 0, div = 1, unit = 1000; // us by default
+
+  for (; *p >= '0' && *p <= '9'; p++)
+    ip = ip * 10 + (*p - '0');
+  if (p == ps->p) return SWAVE_ERR_SYNTAX;
+
+  if (*p == '.')
+    for (p++; *p >= '0' && *p <= '9'; p++)
+      if (div < 1000000000LL)
+      {
+        fp  = fp * 10 + (*p - '0');
+        div *= 10;
+      }
+
+  if      (p[0] == 'n' && p[1] == 's') { unit = 1;          p += 2; }
+  else if (p[0] == 'u' && p[1] == 's') { unit = 1000;       p += 2; }
+  else if (p[0] == 'm' && p[1] == 's') { unit = 1000000;    p += 2; }
+  else if (p[0] == 's')                { unit = 1000000000; p += 1; }
+
+  ps->p = p;
+  *ns = ip * unit + fp * unit / div;
+  return *ns > 0 ? SWAVE_ERR_NONE : SWAVE_ERR_TIME;
+}
+//-----------------------------------------------------------------------------
+// parse time "INT[.FRAC][ns|us|ms|s]" at `*str` and move `*str` after it
+// (return SWAVE_ERR_*)
+int swave_parse_time(const char **str, int64_t *ns)
+{
+  swave_parser_t ps;
+  int retv;
+
+  ps.p = *str;
+  retv = swave_time(&ps, ns);
+  *str = ps.p;
+  return retv;
+}
+//-----------------------------------------------------------------------------
+// parse sequence up to ')' or end of spec
+static int swave_seq(swave_parser_t *ps, int depth)
+{
+  uint64_t num;
+  int64_t ns;
+  unsigned first, len, i;
+  int retv, type;
+
+  for (swave_skip(ps); *ps->p && *ps->p != ')'; swave_skip(ps))
+  {
+    type = swave_number(ps, &num);
+    if (type == 0)
+      return SWAVE_ERR_SYNTAX;
+
+    if (*ps->p == '*')
+    { // N*(...)
+      ps->p++;
+      if (*ps->p++ != '(') return SWAVE_ERR_SYNTAX;
+      if (depth >= SWAVE_DEPTH_MAX) return SWAVE_ERR_DEPTH;
+
+      first = ps->count;
+      retv = swave_seq(ps, depth + 1);
+      if (retv != SWAVE_ERR_NONE) return retv;
+      if (*ps->p++ != ')') return SWAVE_ERR_SYNTAX;
+
+      if (num == 0)
+        ps->count = first; // zero repeats
+      len = ps->count - first;
+      if (len == 0) num = 1; // empty group
+      for (; num > 1; num--)
+        for (i = 0; i < len; i++)
+        {
+          retv = swave_push(ps, ps->edges[first + i].delta_ns,
+                                ps->edges[first + i].mask);
+          if (retv != SWAVE_ERR_NONE) return retv;
+        }
+    }
+    else if (*ps->p == ':')
+    { // LEVEL:TIME
+      if (type == 1 && num > 1) return SWAVE_ERR_SYNTAX; // 0|1|0xMASK
+      ps->p++;
+      retv = swave_time(ps, &ns);
+      if (retv != SWAVE_ERR_NONE) return retv;
+      retv = swave_push(ps, ns, (type == 1 && num) ? 0xFFFFFFFFU :
+                                                     (uint32_t) num);
+      if (retv != SWAVE_ERR_NONE) return retv;
+    }
+    else
+      return SWAVE_ERR_SYNTAX;
+  }
+
+  return SWAVE_ERR_NONE;
+}
+//-----------------------------------------------------------------------------
+// compile spec to edge table at run time (return SWAVE_ERR_*)
+int swave_compile(swave_t *self, const char *spec)
+{
+  swave_parser_t ps;
+  swave_edge_t *edges;
+  unsigned i, n;
+  int retv;
+
+  ps.p     = spec;
+  ps.edges = (swave_edge_t*) NULL;
+  ps.count = ps.size = 0;
+
+  swave_init(self, (const swave_edge_t*) NULL, 0);
+
+  retv = swave_seq(&ps, 0);
+  if (retv == SWAVE_ERR_NONE && (*ps.p != '\0' || ps.count == 0))
+    retv = SWAVE_ERR_SYNTAX;
+  if (retv != SWAVE_ERR_NONE)
+  {
+    free(ps.edges);
+    return retv;
+  }
+
+  // merge neighbour edges with the same levels
+  for (i = 1, n = 1; i < ps.count; i++)
+  {
+    if (ps.edges[i].mask == ps.edges[n - 1].mask)
+      ps.edges[n - 1].delta_ns += ps.edges[i].delta_ns;
+    else
+      ps.edges[n++] = ps.edges[i];
+  }
+
+  // copy to cache aligned table
+  edges = (swave_edge_t*) aligned_alloc(SWAVE_ALIGN,
+    (sizeof(swave_edge_t) * n + SWAVE_ALIGN - 1) & ~(SWAVE_ALIGN - 1));
+  if (edges == (swave_edge_t*) NULL)
+  {
+    free(ps.edges);
+    return SWAVE_ERR_ALLOC;
+  }
+  memcpy(edges, ps.edges, sizeof(swave_edge_t) * n);
+  free(ps.edges);
+
+  swave_init(self, edges, n);
+  self->own = 1;
+  return SWAVE_ERR_NONE;
+}
+//-----------------------------------------------------------------------------
+// use table compiled elsewhere (e.g. by SWAVE() macro of "swave.hpp")
+void swave_init(swave_t *self, const swave_edge_t *edges, unsigned count)
+{
+  unsigned i;
+
+  self->edges     = edges;
+  self->count     = count;
+  self->pos       = 0;
+  self->period_ns = 0;
+  self->own       = 0;
+  for (i = 0; i < count; i++)
+    self->period_ns += edges[i].delta_ns;
+}
+//-----------------------------------------------------------------------------
+// error string
+const char *swave_error_str(int err)
+{
+  static const char *errors[] = {
+    "success",
+    "bad spec",
+    "zero or negative time",
+    "too many edges",
+    "too deep nesting of groups",
+    "can't allocate table"
+  };
+  return (err <= 0 && err > -6) ? errors[-err] : "unknown error";
+}
+//-----------------------------------------------------------------------------
+// free table
+void swave_free(swave_t *self)
+{
+  if (self->own) free((void*) self->edges);
+  swave_init(self, (const swave_edge_t*) NULL, 0);
+}
+//-----------------------------------------------------------------------------
+/*** end of "swave.c" file ***/
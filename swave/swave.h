@@ -0,0 +1,93 @@
+/*
+ * Simple waveform compiler: pulse sequence spec -> flat edge table
+ * File: "swave.h"
+ */
+
+#ifndef SWAVE_H
+#define SWAVE_H
+//-----------------------------------------------------------------------------
+#include <stdint.h> // `int64_t`, `uint32_t`
+//-----------------------------------------------------------------------------
+// Spec is a sequence of items separated by spaces or commas:
+//   LEVEL:TIME   - set outputs to LEVEL and hold them for TIME
+//   N*(...)      - repeat group N times (groups may be nested)
+// where LEVEL is 0 (all low), 1 (all high) or 0xMASK (bit i - i-th output),
+// TIME is a number with optional unit ns|us|ms|s (us by default).
+// Whole table repeats forever, e.g. 3 pulses of 2 us and 10 us gap:
+//   "3*(1:2 0:2) 0:10"
+//-----------------------------------------------------------------------------
+// max number of edges in table
+#define SWAVE_EDGES_MAX 65536
+
+// max nesting of N*(...) groups
+#define SWAVE_DEPTH_MAX 8
+
+// edge table alignment (cache line)
+#define SWAVE_ALIGN 64
+
+// error codes
+#define SWAVE_ERR_NONE    0 // no error
+#define SWAVE_ERR_SYNTAX -1 // bad spec
+#define SWAVE_ERR_TIME   -2 // zero or negative time
+#define SWAVE_ERR_SIZE   -3 // too many edges
+#define SWAVE_ERR_DEPTH  -4 // too deep nesting of groups
+#define SWAVE_ERR_ALLOC  -5 // can't allocate table
+
+// inline macro (platform depended)
+#ifndef   SWAVE_INLINE
+#  define SWAVE_INLINE static inline
+#endif // SWAVE_INLINE
+//-----------------------------------------------------------------------------
+// edge record: set outputs to `mask`, next edge is `delta_ns` later
+typedef struct swave_edge_ {
+  int64_t  delta_ns; // time to next edge [ns]
+  uint32_t mask;     // output levels (bit i - i-th output)
+  uint32_t reserved; // 0 (16 bytes per record, 4 records per cache line)
+} swave_edge_t;
+//-----------------------------------------------------------------------------
+// `swave_t` type structure (table player)
+typedef struct swave_ {
+  const swave_edge_t *edges; // cache aligned table
+  unsigned count;            // number of edges (>0)
+  unsigned pos;              // next edge index
+  int64_t  period_ns;        // sum of all `delta_ns`
+  int own;                   // 1 if table allocated by swave_compile()
+} swave_t;
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+// compile spec to edge table at run time (return SWAVE_ERR_*)
+int swave_compile(swave_t *self, const char *spec);
+//-----------------------------------------------------------------------------
+// use table compiled elsewhere (e.g. by SWAVE() macro of "swave.hpp")
+void swave_init(swave_t *self, const swave_edge_t *edges, unsigned count);
+//-----------------------------------------------------------------------------
+// parse time "INT[.FRAC][ns|us|ms|s]" (us by default) at `*str` and move
+// `*str` after it (return SWAVE_ERR_*)
+int swave_parse_time(const char **str, int64_t *ns);
+//-----------------------------------------------------------------------------
+// error string
+const char *swave_error_str(int err);
+//-----------------------------------------------------------------------------
+// free table
+void swave_free(swave_t *self);
+//-----------------------------------------------------------------------------
+// get next edge (table repeats forever)
+SWAVE_INLINE const swave_edge_t *swave_next(swave_t *self)
+{
+  const swave_edge_t *e = self->edges + self->pos;
+  if (++self->pos == self->count) self->pos = 0;
+  return e;
+}
+//-----------------------------------------------------------------------------
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+//-----------------------------------------------------------------------------
+#endif // SWAVE_H
+
+/*** end of "swave.h" file ***/
+
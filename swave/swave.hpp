@@ -0,0 +1,203 @@
+/*
+ * Simple waveform compiler (C++17 constexpr version of swave_compile())
+ * File: "swave.hpp"
+ */
+
+#ifndef SWAVE_HPP
+#define SWAVE_HPP
+//-----------------------------------------------------------------------------
+#include "swave.h"
+#include <cstddef> // std::size_t
+//-----------------------------------------------------------------------------
+// compile spec (look "swave.h") to edge table at build time, bad spec is
+// a compile error, e.g.:
+//   static constexpr auto wave = SWAVE("3*(1:2 0:2) 0:10");
+//   swave_t w = wave.player();
+#define SWAVE(spec) (::swave::compile< ::swave::size(spec)>(spec))
+//-----------------------------------------------------------------------------
+namespace swave {
+//-----------------------------------------------------------------------------
+namespace detail {
+//-----------------------------------------------------------------------------
+// table builder (same grammar as swave_compile()); N == 0 - count only
+template <std::size_t N>
+struct Builder {
+  swave_edge_t edges[N ? N : 1] = {};
+  std::size_t count = 0;
+  const char *p = nullptr;
+
+  constexpr void push(int64_t delta_ns, uint32_t mask)
+  {
+    if (count >= SWAVE_EDGES_MAX) throw "swave: too many edges";
+    if (N) edges[count] = swave_edge_t{delta_ns, mask, 0};
+    count++;
+  }
+
+  constexpr void skip()
+  {
+    while (*p == ' ' || *p == '\t' || *p == ',' || *p == '\n' || *p == '\r')
+      p++;
+  }
+
+  // return 1 if decimal, 2 if 0x hex, 0 if no digits
+  constexpr int number(uint64_t &val)
+  {
+    const char *s = p;
+    uint64_t v = 0;
+
+    if (s[0] == '0' && (s[1] == 'x' || s[1] == 'X'))
+    {
+      for (s += 2; ; s++)
+      {
+        int d = (*s >= '0' && *s <= '9') ? *s - '0' :
+                (*s >= 'a' && *s <= 'f') ? *s - 'a' + 10 :
+                (*s >= 'A' && *s <= 'F') ? *s - 'A' + 10 : -1;
+        if (d < 0) break;
+        v = v * 16 + d;
+      }
+      if (s == p + 2) return 0;
+      p = s;
+      val = v;
+      return 2;
+    }
+
+    for (; *s >= '0' && *s <= '9'; s++)
+      v = v * 10 + (*s - '0');
+    if (s == p) return 0;
+    p = s;
+    val = v;
+    return 1;
+  }
+
+  constexpr int64_t time()
+  {
+    int64_t ip = 0, fp = 0, div = 1, unit = 1000; // us by default
+    const char *s = p;
+
+    for (; *p >= '0' && *p <= '9'; p++)
+      ip = ip * 10 + (*p - '0');
+    if (p == s) throw "swave: bad time";
+
+    if (*p == '.')
+      for (p++; *p >= '0' && *p <= '9'; p++)
+        if (div < 1000000000LL)
+        {
+          fp  = fp * 10 + (*p - '0');
+          div *= 10;
+        }
+
+    if      (p[0] == 'n' && p[1] == 's') { unit = 1;          p += 2; }
+    else if (p[0] == 'u' && p[1] == 's') { unit = 1000;       p += 2; }
+    else if (p[0] == 'm' && p[1] == 's') { unit = 1000000;    p += 2; }
+    else if (p[0] == 's')                { unit = 1000000000; p += 1; }
+
+    int64_t ns = ip * unit + fp * unit / div;
+    if (ns <= 0) throw "swave: zero time";
+    return ns;
+  }
+
+  constexpr void seq(int depth)
+  {
+    for (skip(); *p && *p != ')'; skip())
+    {
+      uint64_t num = 0;
+      int type = number(num);
+      if (type == 0) throw "swave: bad spec";
+
+      if (*p == '*')
+      { // N*(...)
+        p++;
+        if (*p++ != '(') throw "swave: '(' expected";
+        if (depth >= SWAVE_DEPTH_MAX) throw "swave: too deep nesting";
+
+        std::size_t first = count;
+        seq(depth + 1);
+        if (*p++ != ')') throw "swave: ')' expected";
+
+        if (num == 0) count = first; // zero repeats
+        std::size_t len = count - first;
+        if (len == 0) num = 1;       // empty group
+        for (; num > 1; num--)
+          for (std::size_t i = 0; i < len; i++)
+            push(N ? edges[first + i].delta_ns : 1,
+                 N ? edges[first + i].mask     : 0);
+      }
+      else if (*p == ':')
+      { // LEVEL:TIME
+        if (type == 1 && num > 1) throw "swave: level is 0|1|0xMASK";
+        p++;
+        int64_t ns = time();
+        push(ns, (type == 1 && num) ? 0xFFFFFFFFU : (uint32_t) num);
+      }
+      else
+        throw "swave: bad spec";
+    }
+  }
+
+  constexpr void parse(const char *spec)
+  {
+    p = spec;
+    seq(0);
+    if (*p != '\0' || count == 0) throw "swave: bad spec";
+  }
+};
+//-----------------------------------------------------------------------------
+} // namespace detail
+//-----------------------------------------------------------------------------
+// cache aligned edge table
+template <std::size_t N>
+struct Table {
+  alignas(SWAVE_ALIGN) swave_edge_t edges[N];
+  unsigned count;    // number of edges after merge (<= N)
+  int64_t period_ns; // sum of all `delta_ns`
+
+  // table player for C code (table must outlive it)
+  swave_t player() const
+  {
+    swave_t w;
+    swave_init(&w, edges, count);
+    return w;
+  }
+};
+//-----------------------------------------------------------------------------
+// number of edges before merge (table size)
+constexpr std::size_t size(const char *spec)
+{
+  detail::Builder<0> b;
+  b.parse(spec);
+  return b.count;
+}
+//-----------------------------------------------------------------------------
+// compile spec to table of `N` edges (N = size(spec))
+template <std::size_t N>
+constexpr Table<N> compile(const char *spec)
+{
+  detail::Builder<N> b;
+  Table<N> t = {};
+
+  b.parse(spec);
+
+  // merge neighbour edges with the same levels
+  t.edges[0] = b.edges[0];
+  t.count    = 1;
+  for (std::size_t i = 1; i < b.count; i++)
+  {
+    if (b.edges[i].mask == t.edges[t.count - 1].mask)
+      t.edges[t.count - 1].delta_ns += b.edges[i].delta_ns;
+    else
+      t.edges[t.count++] = b.edges[i];
+  }
+
+  t.period_ns = 0;
+  for (unsigned i = 0; i < t.count; i++)
+    t.period_ns += t.edges[i].delta_ns;
+
+  return t;
+}
+//-----------------------------------------------------------------------------
+} // namespace swave
+//-----------------------------------------------------------------------------
+#endif // SWAVE_HPP
+
+/*** end of "swave.hpp" file ***/
+
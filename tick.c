@@ -6,18 +6,83 @@
  */
 
 //-----------------------------------------------------------------------------
+#define _GNU_SOURCE    // CPU_SET(), pthread_attr_setaffinity_np()
 //#include <math.h>
 #include <stdlib.h>    // exit(), EXIT_SUCCESS, EXIT_FAILURE, atoi()
-#include <string.h>    // strcmp()
+#include <string.h>    // strcmp(), memcpy()
 #include <stdio.h>     // fprintf(), printf(), perror()
+#include <math.h>      // fabs()
+#include <stdint.h>    // intptr_t
+#include <signal.h>    // sigfillset(), pthread_sigmask()
+#include <sched.h>     // CPU_SET()
+#include <pthread.h>   // pthread_create(), pthread_join()
+#include <unistd.h>    // sysconf()
 //-----------------------------------------------------------------------------
 #include "stimer.h"
+#include "spll.h"
 #include "sgpio.h"
+#include "sstat.h"
+#include "sstress.h"
+#include "stracer.h"
+#include "swave.h"
+#include "sseq.h"
+#include "sbcast.h"
+#include "scap.h"
+#include "sperf.h"
+#include "sqos.h"
+#include "spwm.h"
+#include "sshift.h"
+//-----------------------------------------------------------------------------
+// trace stages of tick path (look tick_timer_handler())
+enum {
+  TICK_TRACE_DEADLINE = 0, // expected deadline
+  TICK_TRACE_WAKEUP,       // stimer_loop() wake-up
+  TICK_TRACE_ENTRY,        // tick_timer_handler() entry
+  TICK_TRACE_GPIO,         // sgpio_set() start
+  TICK_TRACE_GPIO_UP,      // sgpio_set(up) complete
+  TICK_TRACE_GPIO_DOWN,    // sgpio_set(down) complete
+  TICK_TRACE_EXIT,         // tick_timer_handler() exit
+  TICK_TRACE_STAGES
+};
+
+static const char *const tick_trace_names[TICK_TRACE_STAGES] = {
+  "deadline", "wakeup", "entry", "gpio", "gpio_up", "gpio_down", "exit"
+};
+//-----------------------------------------------------------------------------
+// max number of GPIO pins (-g LIST)
+#define TICK_GPIO_MAX 32
+
+// max number of timer threads (-j N)
+#define TICK_SHARDS_MAX 16
+
+// default pulse width of delay generator (-D LIST) [us]
+#define TICK_DELAY_WIDTH_US 10.
+
+// poll period of stop flag while waiting trigger or PWM periods [ms]
+#define TICK_TRIGGER_POLL_MS 100
+
+// number of sleeps to probe wake-up latency without/with PM QoS (-Q)
+#define TICK_QOS_PROBES 200
+
+// default pulse width of hardware PWM (-H SPEC) [us]
+#define TICK_PWM_WIDTH_US 10.
+
+// max size of shift register byte stream (-X SPEC)
+#define TICK_SHIFT_MAX 65536
+//-----------------------------------------------------------------------------
+// edge of delay generator table (levels after `at` ns since trigger)
+typedef struct tick_edge_ {
+  int64_t  at;   // time after trigger [ns]
+  uint32_t mask; // levels (bit i - i-th GPIO)
+} tick_edge_t;
 //-----------------------------------------------------------------------------
 // command line options
 typedef struct options_ {
-  int interval; // ms
-  int gpio_num; // >=0
+  double interval; // ms (fractional)
+  double freq;     // Hz (0 - by interval)
+  int gpio_nums[TICK_GPIO_MAX]; // >=0
+  int gpio_count; // >=1
+  const char *gpio_path; // sysfs GPIO path (NULL - SGPIO_MAIN_PATH)
   int verbose;  // {0,1,2,3}
   int data;     // 0|1
   int negative; // 0|1  
@@ -25,20 +90,100 @@ typedef struct options_ {
   int fake;     // 0|1  
   int tau;      // >=0
   int realtime; // 0|1
+  const char *pll; // PLL reference: NULL|"raw"|file name|"-" (stdin)
+  int backend;  // STIMER_BACKEND_*
+  const char *sim; // simulated latency spec (STIMER_BACKEND_SIM) or NULL
+  unsigned count;  // stop after `count` ticks (0 - forever)
+  unsigned events; // fake GPIO buffer size (0 - by default)
+  const char *vcd; // VCD file name for fake GPIO edges (or NULL)
+  const char *stress; // background load spec (or NULL)
+  unsigned trace;       // trace ring size (0 - no trace)
+  double trace_trigger; // trigger if |dt - interval| > trace_trigger [us]
+  const char *trace_out; // trace dump file (NULL - stderr)
+  const char *wave;      // waveform spec (look "swave.h") or NULL
+  const char *program;   // pulse sequence script file (look "sseq.h")
+  int input_num;         // input GPIO for script conditions (-1 - none)
+  const char *bcast;     // tick broadcast shared memory name (or NULL)
+  int shards;            // number of timer threads (>=1)
+  int shard_cpus[TICK_SHARDS_MAX]; // CPU of i-th thread (-1 - any)
+  int delays;            // number of delay generator outputs (0 - off)
+  int64_t delay_at[TICK_GPIO_MAX];    // delay after trigger [ns]
+  int64_t delay_width[TICK_GPIO_MAX]; // pulse width [ns]
+  const char *capture;   // logic analyzer output file (or NULL)
+  int counters;          // 0|1 perf counters around timer handler
+  int qos_us;            // PM QoS wake-up latency [us] (-1 - off)
+  int qos_cpus;          // number of CPUs with resume latency limit
+  int qos_cpu[SQOS_CPUS_MAX];
+  int pwm_chip;          // hardware PWM chip (-1 - off)
+  int pwm_channel;       // hardware PWM channel
+  int64_t pwm_width;     // hardware PWM pulse width [ns]
+  const char *pwm_path;  // sysfs PWM path (NULL - SPWM_MAIN_PATH)
+  uint8_t *shift;        // shift register byte stream (or NULL)
+  unsigned shift_len;    // bytes of stream
+  int shift_order;       // SSHIFT_MSB_FIRST|SSHIFT_LSB_FIRST
+  int64_t shift_ns;      // min clock half period [ns] (0 - max rate)
+  int shift_path;        // SSHIFT_PATH_* (-1 - fastest available)
 } options_t;
 //-----------------------------------------------------------------------------
 typedef struct tick_ {
   options_t   options;
-  sgpio_t     gpio;
+  sgpio_t     gpio[TICK_GPIO_MAX];
+  sgpio_fake_t rec; // recorded edges (fake GPIO)
   stimer_t    timer;
+  spll_t      pll;
   int         state;
   unsigned    counter;
+  unsigned    skipped; // ticks after realtime clock step (dt not valid)
   double      daytime;
   double      dt_min;
   double      dt_max;
   long double dt_sum;
+  sstat_t     latency; // wake-up latency [ns] (handler entry - deadline)
+  sstress_t   stress;  // background load threads
+  stracer_t   trace;   // per tick stage timestamps
+  double      startup; // GPIO provisioning time [s]
+  swave_t     wave;    // compiled waveform (edge table)
+  sseq_t      seq;     // compiled pulse sequence script
+  int         seq_err; // run time error of script (SSEQ_ERR_*)
+  sgpio_t     input;   // input GPIO for script conditions
+  uint32_t    out_xor;    // ~0 if negative output
+  uint32_t    out_pins;   // mask of used outputs
+  uint32_t    out_levels; // current output levels
+  double      expect;      // expected dt [s]
+  int         queued;      // 1 if GPIO writes are queued to next deadline
+  int64_t     hold;        // hold time of levels in effect (queued) [ns]
+  sbcast_t    bcast;       // tick broadcast (publisher)
+  int         bcast_err;   // last error of sbcast_publish()
+  int         shard;       // shard index (0 - main thread)
+  pthread_t   thread;      // timer thread (shards 1...N-1)
+  tick_edge_t delay[2 * TICK_GPIO_MAX]; // delay generator edges
+  int         delay_edges;
+  int         delay_pos;   // next edge of `delay` (0 - wait trigger)
+  int64_t     trigger;     // last trigger time [ns]
+  unsigned    triggers;    // number of served triggers
+  int         trigger_err; // error of input edge wait (SGPIO_ERR_*)
+  sstat_t     delay_err;   // output edge time - (trigger + delay) [ns]
+  int64_t     first;       // first tick wake-up (or loopback edge) [ns]
+  int64_t     last;        // last tick wake-up (or loopback edge) [ns]
+  int64_t     steps_ns;    // sum of realtime clock steps since first [ns]
+  scap_t      cap;         // logic analyzer capture ring
+  uint32_t    cap_last;    // last sample
+  unsigned    cap_overrun; // timer overrun at last sample
+  uint64_t    cap_gaps;    // missed samples (filled by last sample)
+  unsigned    cap_errors;  // failed reads of input pins
+  sperf_t     perf;        // counters of timer thread (-C)
+  int (*handler)(void *context); // timer handler sampled by counters
+  spwm_t      pwm;         // hardware PWM channel (-H)
+  int         pwm_on;      // 1 if pulses are generated by PWM
+  const char *pwm_why;     // why PWM is not used (software pulses)
+  sshift_t    shift;       // shift register output (-X)
+  int         shift_err;   // last error of sshift_write() (SSHIFT_ERR_*)
+  unsigned    shift_errors; // failed streams
 } tick_t;
 //-----------------------------------------------------------------------------
+// shards 1...N-1 (shard 0 is `tick` of main thread)
+static tick_t tick_shards[TICK_SHARDS_MAX];
+//-----------------------------------------------------------------------------
 static void tick_usage()
 {
   fprintf(stderr,
@@ -59,24 +204,313 @@ static void tick_help()
     "  -vv|--more-verbose  - more verbose output (or use -v twice)\n"
     " -vvv|--much-verbose  - more verbose output (or use -v thrice)\n"
     "   -d|--data          - output statistic to stdout (no verbose)\n"
-    "   -g|--gpio          - number of GPIO channel (1 by default)\n"
+    "   -g|--gpio LIST     - number(s) of GPIO channel (1 by default),\n"
+    "                        comma separated list (e.g. 17,27,22)\n"
+    "   -G|--gpio-path DIR - sysfs GPIO directory (" SGPIO_MAIN_PATH ")\n"
     "   -n|--negative      - negative output\n"
     "   -m|--meandr        - meandr 2*T mode\n"
-    "   -f|--fake          - fake GPIO\n"
+    "   -f|--fake          - fake GPIO (record edges in memory)\n"
+    "   -e|--events N      - fake GPIO buffer size (65536 edges by default)\n"
+    "                        or capture ring size (-L)\n"
+    "   -V|--vcd FILE      - dump fake GPIO edges to VCD file at exit\n"
     "   -t|--tau           - impulse time in 'bogoticks'\n"
     "   -r|--real-time     - real time mode (root required)\n"
-    "interval-ms           - timer interval in ms (100 by default)\n");
+    "   -b|--backend NAME  - timer backend: signal (default), timerfd, sleep,\n"
+    "                        uring (GPIO writes are linked to io_uring\n"
+    "                        timeout and done by kernel at next tick)\n"
+    "   -S|--sim SPEC      - simulated clock with wake-up latency SPEC:\n"
+    "                        none|uniform:MIN,MAX|exp:MIN,MEAN|gauss:MEAN,DEV\n"
+    "                        (in us), implies -f\n"
+    "   -c|--count N       - stop after N ticks\n"
+    "   -s|--stress SPEC   - background non real time load while timer runs:\n"
+    "                        TYPE[:N][,TYPE[:N]...][@CPU[,CPU...]], where\n"
+    "                        TYPE is cpu|mem|sys|io, N - number of threads\n"
+    "   -T|--trace N       - trace last N ticks (stage timestamps), dump at exit\n"
+    "   -x|--trace-trigger US - freeze trace when |dt - interval| > US\n"
+    "                        (N/4 ticks after outlier are kept)\n"
+    "   -o|--trace-out FILE - trace dump file (stderr by default)\n"
+    "   -W|--wave SPEC     - play pulse sequence instead of single pulse:\n"
+    "                        LEVEL:TIME items and N*(...) groups, LEVEL is\n"
+    "                        0|1|0xMASK (bit i - i-th GPIO of -g list),\n"
+    "                        TIME in ns|us|ms|s (us by default), e.g.\n"
+    "                        '3*(1:2 0:2) 0:10' (interval-ms is lead-in)\n"
+    "   -P|--program FILE  - run pulse sequence script (bursts, loops,\n"
+    "                        conditions on input), look \"sseq/sseq.h\"\n"
+    "   -I|--input NUM     - input GPIO for script conditions\n"
+    "   -B|--broadcast NAME - publish every tick to shared memory /NAME,\n"
+    "                        clients wait it by futex, look \"sbcast/sbcast.h\"\n"
+    "   -j|--shards N[@CPU[,CPU...]] - split GPIO list round-robin between N\n"
+    "                        timer threads pinned to CPUs (0...N-1 by\n"
+    "                        default) with common time base\n"
+    "   -D|--delay LIST    - delay generator: wait rising edge on input GPIO\n"
+    "                        (-I NUM) and pulse i-th GPIO of -g list at\n"
+    "                        i-th delay, LIST is US[:WIDTH_US][,...]\n"
+    "                        (width 10 us by default); with -f trigger\n"
+    "                        is emulated every interval-ms, -c counts\n"
+    "                        triggers\n"
+    "   -L|--logic FILE    - logic analyzer: sample -g list pins (inputs)\n"
+    "                        every tick to ring buffer (-e N samples),\n"
+    "                        background thread writes run-length encoded\n"
+    "                        FILE (VCD if FILE is *.vcd), look \"scap/scap.h\"\n"
+    "   -F|--freq HZ       - frequency instead of interval-ms (e.g. 1333.3333)\n"
+    "   -N|--period NS     - period in ns instead of interval-ms (e.g. 37500);\n"
+    "                        fractional ns are spread over ticks by phase\n"
+    "                        accumulator (DDS), average frequency is exact\n"
+    "   -C|--counters      - per tick distributions of perf counters around\n"
+    "                        timer handler (cycles, instructions, cache\n"
+    "                        misses, context switches, page faults, on/off\n"
+    "                        CPU time), hardware ones only if available\n"
+    "   -Q|--qos US[@CPU[,CPU...]] - hold PM QoS request: wake-up latency\n"
+    "                        limit US (0 - no deep C-states) by\n"
+    "                        " SQOS_DMA_LATENCY " and resume latency of\n"
+    "                        listed CPUs while running (root required,\n"
+    "                        skipped if not allowed); wake-up latency\n"
+    "                        is probed without and with it\n"
+    "   -H|--pwm CHIP:CH[,WIDTH_US] - generate pulses by hardware PWM\n"
+    "                        channel (no timer, no GPIO writes) when\n"
+    "                        period, width (10 us by default) and -n fit,\n"
+    "                        software pulses otherwise; -g pins are not\n"
+    "                        used, period statistics is taken from input\n"
+    "                        loopback (-I NUM) if any\n"
+    "   -K|--pwm-path DIR  - sysfs PWM directory (" SPWM_MAIN_PATH ")\n"
+    "   -X|--shift BYTES[:OPT...] - clock out BYTES (hex, e.g. a5ff00, or\n"
+    "                        @FILE) every tick to shift register(s) on\n"
+    "                        -g DATA,CLOCK,LATCH; OPT: msb (default) or\n"
+    "                        lsb first, NS - min clock half period (0 -\n"
+    "                        max rate), cdev|uring|write - write path\n"
+    "                        (fastest available by default); achieved\n"
+    "                        throughput in bits/s in statistics\n"
+    "   -p|--pll REF       - discipline timer by reference: 'raw' for\n"
+    "                        CLOCK_MONOTONIC_RAW or file/pipe ('-' stdin)\n"
+    "                        with reference edge timestamps (one per line)\n"
+    "interval-ms           - timer interval in ms (100 by default, may be\n"
+    "                        fractional, e.g. 0.75)\n");
   exit(EXIT_SUCCESS);
 }
 //-----------------------------------------------------------------------------
+// parse comma separated list of GPIO numbers
+static int tick_parse_gpio(const char *str, int *nums)
+{
+  int n = 0;
+  char *end;
+
+  while (n < TICK_GPIO_MAX)
+  {
+    nums[n] = (int) strtol(str, &end, 10);
+    if (end == str) tick_usage();
+    if (nums[n] < 0) nums[n] = 0;
+    n++;
+    if (*end != ',') break;
+    str = end + 1;
+  }
+
+  return n;
+}
+//-----------------------------------------------------------------------------
+// parse shards spec "N[@CPU[,CPU...]]"
+static void tick_parse_shards(const char *str, options_t *o)
+{
+  int i, n = 0, ncpu = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  char *end;
+
+  o->shards = (int) strtol(str, &end, 10);
+  if (end == str || o->shards < 1) tick_usage();
+  if (o->shards > TICK_SHARDS_MAX) o->shards = TICK_SHARDS_MAX;
+
+  if (*end == '@')
+  {
+    do
+    {
+      str = end + 1;
+      o->shard_cpus[n] = (int) strtol(str, &end, 10);
+      if (end == str) tick_usage();
+      n++;
+    } while (*end == ',' && n < TICK_SHARDS_MAX);
+  }
+  if (*end) tick_usage();
+
+  // CPU list is repeated, by default i-th thread on i-th CPU
+  for (i = n; i < o->shards; i++)
+    o->shard_cpus[i] = n ? o->shard_cpus[i % n] : i < ncpu ? i : -1;
+}
+//-----------------------------------------------------------------------------
+// parse delay generator spec "US[:WIDTH_US][,US[:WIDTH_US]...]"
+static void tick_parse_delays(const char *str, options_t *o)
+{
+  int n = 0;
+  double at, width;
+  char *end;
+
+  while (n < TICK_GPIO_MAX)
+  {
+    at = strtod(str, &end);
+    if (end == str || at < 0.) tick_usage();
+    width = TICK_DELAY_WIDTH_US;
+    if (*end == ':')
+    {
+      str   = end + 1;
+      width = strtod(str, &end);
+      if (end == str || width <= 0.) tick_usage();
+    }
+    o->delay_at[n]    = (int64_t) (at    * 1e3 + 0.5);
+    o->delay_width[n] = (int64_t) (width * 1e3 + 0.5);
+    n++;
+    if (*end != ',') break;
+    str = end + 1;
+  }
+  if (*end == ',')
+  {
+    fprintf(stderr, "error: -D has up to %d delays; exit\n", TICK_GPIO_MAX);
+    exit(EXIT_FAILURE);
+  }
+  if (*end) tick_usage();
+
+  o->delays = n;
+}
+//-----------------------------------------------------------------------------
+// parse PM QoS spec "US[@CPU[,CPU...]]"
+static void tick_parse_qos(const char *str, options_t *o)
+{
+  char *end;
+
+  o->qos_us = (int) strtol(str, &end, 10);
+  if (end == str || o->qos_us < 0) tick_usage();
+
+  o->qos_cpus = 0;
+  if (*end == '@')
+  {
+    do
+    {
+      str = end + 1;
+      o->qos_cpu[o->qos_cpus] = (int) strtol(str, &end, 10);
+      if (end == str || o->qos_cpu[o->qos_cpus] < 0) tick_usage();
+      o->qos_cpus++;
+    } while (*end == ',' && o->qos_cpus < SQOS_CPUS_MAX);
+  }
+  if (*end == ',')
+  {
+    fprintf(stderr, "error: -Q has up to %d CPUs; exit\n", SQOS_CPUS_MAX);
+    exit(EXIT_FAILURE);
+  }
+  if (*end) tick_usage();
+}
+//-----------------------------------------------------------------------------
+// parse hardware PWM spec "CHIP:CHANNEL[,WIDTH_US]"
+static void tick_parse_pwm(const char *str, options_t *o)
+{
+  double width = TICK_PWM_WIDTH_US;
+  char *end;
+
+  o->pwm_chip = (int) strtol(str, &end, 10);
+  if (end == str || *end != ':' || o->pwm_chip < 0) tick_usage();
+
+  str = end + 1;
+  o->pwm_channel = (int) strtol(str, &end, 10);
+  if (end == str || o->pwm_channel < 0) tick_usage();
+
+  if (*end == ',')
+  {
+    str   = end + 1;
+    width = strtod(str, &end);
+    if (end == str || width <= 0.) tick_usage();
+  }
+  if (*end) tick_usage();
+  o->pwm_width = (int64_t) (width * 1e3 + 0.5);
+}
+//-----------------------------------------------------------------------------
+// hex digit value (or -1)
+static int tick_hex(char c)
+{
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+//-----------------------------------------------------------------------------
+// parse shift register spec "HEX|@FILE[:msb|lsb][:NS][:cdev|uring|write]"
+static void tick_parse_shift(const char *str, options_t *o)
+{
+  char fname[SGPIO_PATH_MAX], *end;
+  unsigned n = 0;
+  int hi, lo, i, path;
+  size_t len;
+  FILE *f;
+
+  free((void*) o->shift); // -X given again
+  o->shift = (uint8_t*) malloc(TICK_SHIFT_MAX);
+  if (o->shift == (uint8_t*) NULL)
+  {
+    fprintf(stderr, "error: can't allocate memory; exit\n");
+    exit(EXIT_FAILURE);
+  }
+
+  if (*str == '@')
+  { // raw bytes of file
+    for (i = 0, str++; *str && *str != ':' && i < (int) sizeof(fname) - 1; )
+      fname[i++] = *str++;
+    fname[i] = '\0';
+    f = fopen(fname, "rb");
+    if (f == (FILE*) NULL)
+    {
+      fprintf(stderr, "error: can't open '%s'; exit\n", fname);
+      exit(EXIT_FAILURE);
+    }
+    n = (unsigned) fread((void*) o->shift, 1, TICK_SHIFT_MAX, f);
+    if (n == TICK_SHIFT_MAX && fgetc(f) != EOF)
+    {
+      fprintf(stderr, "error: '%s' is longer than %d bytes; exit\n",
+              fname, TICK_SHIFT_MAX);
+      exit(EXIT_FAILURE);
+    }
+    fclose(f);
+  }
+  else
+  { // pairs of hex digits
+    while (n < TICK_SHIFT_MAX &&
+           (hi = tick_hex(str[0])) >= 0 && (lo = tick_hex(str[1])) >= 0)
+    {
+      o->shift[n++] = (uint8_t) ((hi << 4) | lo);
+      str += 2;
+    }
+  }
+  if (n == 0 || (*str && *str != ':')) tick_usage();
+  o->shift_len = n;
+
+  while (*str == ':')
+  { // options of any order
+    str++;
+    len = strcspn(str, ":");
+    for (path = SSHIFT_PATH_WRITE; path <= SSHIFT_PATH_CDEV; path++)
+      if (strlen(sshift_path_str(path)) == len &&
+          !strncmp(str, sshift_path_str(path), len)) break;
+
+    if (path <= SSHIFT_PATH_CDEV)
+      o->shift_path = path;
+    else if (len == 3 && !strncmp(str, "msb", 3))
+      o->shift_order = SSHIFT_MSB_FIRST;
+    else if (len == 3 && !strncmp(str, "lsb", 3))
+      o->shift_order = SSHIFT_LSB_FIRST;
+    else
+    {
+      o->shift_ns = (int64_t) strtoll(str, &end, 10);
+      if (end != str + len || len == 0 || o->shift_ns < 0) tick_usage();
+    }
+    str += len;
+  }
+  if (*str) tick_usage();
+}
+//-----------------------------------------------------------------------------
 // parse command line options
 static void tick_parse_options(int argc, const char *argv[], options_t *o)
 {
   int i;
  
   // set options by default
-  o->interval  = 100; // ms
-  o->gpio_num  = 1;   // 1 by default
+  o->interval  = 100.; // ms
+  o->freq      = 0.;   // by interval
+  o->gpio_nums[0] = 1; // 1 by default
+  o->gpio_count   = 1;
+  o->gpio_path    = NULL;
   o->verbose   = 0;   // verbose level {0,1,2,3}
   o->data      = 0;   // output statistic to stdout
   o->negative  = 0;   // 0|1  
@@ -84,6 +518,34 @@ static void tick_parse_options(int argc, const char *argv[], options_t *o)
   o->fake      = 0;   // 0|1  
   o->tau       = 0;   // >=0
   o->realtime  = 0;   // 0|1
+  o->pll       = NULL; // free running
+  o->backend   = STIMER_BACKEND_SIGNAL;
+  o->sim       = NULL;
+  o->count     = 0;   // forever
+  o->events    = 0;   // by default
+  o->vcd       = NULL;
+  o->stress    = NULL; // no load
+  o->trace     = 0;    // no trace
+  o->trace_trigger = 0.;
+  o->trace_out = NULL;
+  o->wave      = NULL;
+  o->program   = NULL;
+  o->input_num = -1;
+  o->bcast     = NULL;
+  o->shards    = 1;
+  o->shard_cpus[0] = -1;
+  o->delays    = 0;
+  o->capture   = NULL;
+  o->counters  = 0;
+  o->qos_us    = -1;
+  o->qos_cpus  = 0;
+  o->pwm_chip  = -1;   // software pulses
+  o->pwm_path  = NULL;
+  o->shift     = NULL; // single pulse
+  o->shift_len = 0;
+  o->shift_order = SSHIFT_MSB_FIRST;
+  o->shift_ns    = 0;  // max rate
+  o->shift_path  = -1; // fastest available
 
   // parse options
   for (i = 1; i < argc; i++)
@@ -121,10 +583,15 @@ static void tick_parse_options(int argc, const char *argv[], options_t *o)
       }
       else if (!strcmp(argv[i], "-g") ||
                !strcmp(argv[i], "--gpio"))
-      { // gpio number
+      { // gpio number(s)
+        if (++i >= argc) tick_usage();
+        o->gpio_count = tick_parse_gpio(argv[i], o->gpio_nums);
+      }
+      else if (!strcmp(argv[i], "-G") ||
+               !strcmp(argv[i], "--gpio-path"))
+      { // sysfs GPIO directory
         if (++i >= argc) tick_usage();
-        o->gpio_num = atoi(argv[i]);
-        if (o->gpio_num < 0) o->gpio_num = 0;
+        o->gpio_path = argv[i];
       }
       else if (!strcmp(argv[i], "-n") ||
                !strcmp(argv[i], "--negative"))
@@ -141,6 +608,19 @@ static void tick_parse_options(int argc, const char *argv[], options_t *o)
       { // fake
         o->fake = 1;
       }
+      else if (!strcmp(argv[i], "-e") ||
+               !strcmp(argv[i], "--events"))
+      { // fake GPIO buffer size
+        if (++i >= argc) tick_usage();
+        o->events = (unsigned) atoi(argv[i]);
+      }
+      else if (!strcmp(argv[i], "-V") ||
+               !strcmp(argv[i], "--vcd"))
+      { // VCD file
+        if (++i >= argc) tick_usage();
+        o->vcd  = argv[i];
+        o->fake = 1;
+      }
       else if (!strcmp(argv[i], "-t") ||
                !strcmp(argv[i], "--tau"))
       { // tau
@@ -153,35 +633,255 @@ static void tick_parse_options(int argc, const char *argv[], options_t *o)
       { // real time mode
         o->realtime = 1;
       }
+      else if (!strcmp(argv[i], "-b") ||
+               !strcmp(argv[i], "--backend"))
+      { // timer backend
+        if (++i >= argc) tick_usage();
+        o->backend = stimer_backend(argv[i]);
+        if (o->backend < 0) tick_usage();
+      }
+      else if (!strcmp(argv[i], "-S") ||
+               !strcmp(argv[i], "--sim"))
+      { // simulated clock
+        if (++i >= argc) tick_usage();
+        o->sim     = argv[i];
+        o->backend = STIMER_BACKEND_SIM;
+        o->fake    = 1;
+      }
+      else if (!strcmp(argv[i], "-c") ||
+               !strcmp(argv[i], "--count"))
+      { // number of ticks
+        if (++i >= argc) tick_usage();
+        o->count = (unsigned) atoi(argv[i]);
+      }
+      else if (!strcmp(argv[i], "-s") ||
+               !strcmp(argv[i], "--stress"))
+      { // background load
+        if (++i >= argc) tick_usage();
+        o->stress = argv[i];
+      }
+      else if (!strcmp(argv[i], "-T") ||
+               !strcmp(argv[i], "--trace"))
+      { // trace ring size
+        if (++i >= argc) tick_usage();
+        o->trace = (unsigned) atoi(argv[i]);
+      }
+      else if (!strcmp(argv[i], "-x") ||
+               !strcmp(argv[i], "--trace-trigger"))
+      { // trace trigger threshold
+        if (++i >= argc) tick_usage();
+        o->trace_trigger = atof(argv[i]);
+      }
+      else if (!strcmp(argv[i], "-o") ||
+               !strcmp(argv[i], "--trace-out"))
+      { // trace dump file
+        if (++i >= argc) tick_usage();
+        o->trace_out = argv[i];
+      }
+      else if (!strcmp(argv[i], "-W") ||
+               !strcmp(argv[i], "--wave"))
+      { // waveform spec
+        if (++i >= argc) tick_usage();
+        o->wave = argv[i];
+      }
+      else if (!strcmp(argv[i], "-P") ||
+               !strcmp(argv[i], "--program"))
+      { // pulse sequence script
+        if (++i >= argc) tick_usage();
+        o->program = argv[i];
+      }
+      else if (!strcmp(argv[i], "-I") ||
+               !strcmp(argv[i], "--input"))
+      { // input GPIO
+        if (++i >= argc) tick_usage();
+        o->input_num = atoi(argv[i]);
+      }
+      else if (!strcmp(argv[i], "-B") ||
+               !strcmp(argv[i], "--broadcast"))
+      { // tick broadcast
+        if (++i >= argc) tick_usage();
+        o->bcast = argv[i];
+      }
+      else if (!strcmp(argv[i], "-j") ||
+               !strcmp(argv[i], "--shards"))
+      { // timer threads
+        if (++i >= argc) tick_usage();
+        tick_parse_shards(argv[i], o);
+      }
+      else if (!strcmp(argv[i], "-D") ||
+               !strcmp(argv[i], "--delay"))
+      { // delay generator
+        if (++i >= argc) tick_usage();
+        tick_parse_delays(argv[i], o);
+      }
+      else if (!strcmp(argv[i], "-L") ||
+               !strcmp(argv[i], "--logic"))
+      { // logic analyzer capture
+        if (++i >= argc) tick_usage();
+        o->capture = argv[i];
+      }
+      else if (!strcmp(argv[i], "-F") ||
+               !strcmp(argv[i], "--freq"))
+      { // frequency
+        if (++i >= argc) tick_usage();
+        o->freq = atof(argv[i]);
+        if (o->freq <= 0.) tick_usage();
+      }
+      else if (!strcmp(argv[i], "-N") ||
+               !strcmp(argv[i], "--period"))
+      { // period [ns]
+        if (++i >= argc) tick_usage();
+        o->interval = atof(argv[i]) * 1e-6;
+        if (o->interval <= 0.) tick_usage();
+        o->freq = 0.;
+      }
+      else if (!strcmp(argv[i], "-C") ||
+               !strcmp(argv[i], "--counters"))
+      { // perf counters
+        o->counters = 1;
+      }
+      else if (!strcmp(argv[i], "-Q") ||
+               !strcmp(argv[i], "--qos"))
+      { // PM QoS request
+        if (++i >= argc) tick_usage();
+        tick_parse_qos(argv[i], o);
+      }
+      else if (!strcmp(argv[i], "-H") ||
+               !strcmp(argv[i], "--pwm"))
+      { // hardware PWM
+        if (++i >= argc) tick_usage();
+        tick_parse_pwm(argv[i], o);
+      }
+      else if (!strcmp(argv[i], "-K") ||
+               !strcmp(argv[i], "--pwm-path"))
+      { // sysfs PWM directory
+        if (++i >= argc) tick_usage();
+        o->pwm_path = argv[i];
+      }
+      else if (!strcmp(argv[i], "-X") ||
+               !strcmp(argv[i], "--shift"))
+      { // shift register output
+        if (++i >= argc) tick_usage();
+        tick_parse_shift(argv[i], o);
+      }
+      else if (!strcmp(argv[i], "-p") ||
+               !strcmp(argv[i], "--pll"))
+      { // PLL reference
+        if (++i >= argc) tick_usage();
+        o->pll = argv[i];
+      }
       else
         tick_usage();
     }
     else
     { // interavl
-      o->interval = atoi(argv[i]);
-      if (o->interval <= 0) o->interval = 1;
+      o->interval = atof(argv[i]);
+      if (o->interval <= 0.) o->interval = 1.;
+      o->freq = 0.;
     }
   } // for
+
+  // frequency is exact, interval is for lead-in and statistics
+  if (o->freq > 0.) o->interval = 1e3 / o->freq;
+}
+//-----------------------------------------------------------------------------
+// PM QoS request and PWM channel held until normal release
+// (NULL - nothing to release)
+static sqos_t *tick_qos = (sqos_t*) NULL;
+static spwm_t *tick_pwm = (spwm_t*) NULL;
+
+// release on any exit(): per-CPU PM QoS limits and running PWM must not
+// outlive process
+static void tick_atexit(void)
+{
+  if (tick_qos != (sqos_t*) NULL)
+  {
+    sqos_release(tick_qos);
+    tick_qos = (sqos_t*) NULL;
+  }
+  if (tick_pwm != (spwm_t*) NULL)
+  {
+    spwm_close(tick_pwm);
+    tick_pwm = (spwm_t*) NULL;
+  }
 }
 //-----------------------------------------------------------------------------
-// SIGINT handler (Ctrl-C)
+// SIGINT (Ctrl-C) and SIGTERM handler
 static void tick_sigint_handler(void *context)
 {
   tick_t *tick = (tick_t*) context;
+  int i;
   stimer_stop(&tick->timer);
+  for (i = 1; i < tick->options.shards; i++)
+    stimer_stop(&tick_shards[i].timer);
+  sstress_stop(&tick->stress);
   fprintf(stderr, "\nCtrl-C pressed\n");
 } 
 //-----------------------------------------------------------------------------
+// timestamp source for recorded GPIO edges (virtual time in simulation)
+static int64_t tick_clock(void *context)
+{
+  tick_t *tick = (tick_t*) context;
+  return stimer_time_ns(&tick->timer);
+}
+//-----------------------------------------------------------------------------
+// read input GPIO for script conditions
+static int tick_input(void *context)
+{
+  tick_t *tick = (tick_t*) context;
+  return sgpio_get(&tick->input);
+}
+//-----------------------------------------------------------------------------
+// set output levels (bit i - i-th GPIO), write changed GPIO only
+static inline void tick_output(tick_t *tick, uint32_t mask)
+{
+  uint32_t levels  = mask ^ tick->out_xor;
+  uint32_t changed = (levels ^ tick->out_levels) & tick->out_pins;
+  int i;
+
+  tick->out_levels = levels;
+  while (changed)
+  {
+    i = __builtin_ctz(changed);
+    changed &= changed - 1;
+    if (tick->queued) // kernel writes it right after next deadline
+      stimer_queue_write(&tick->timer, tick->gpio[i].fd,
+                         (levels >> i) & 1 ? "1" : "0", 1);
+    else
+      sgpio_set(tick->gpio + i, (levels >> i) & 1);
+  }
+}
+//-----------------------------------------------------------------------------
 static int tick_timer_handler(void *context)
 {
   // дергать ножку GPIO по прерыванию от таймера
   tick_t *tick = (tick_t*) context;
   const options_t *o = &tick->options; 
-  sgpio_t *gpio      = &tick->gpio;
-  double daytime = stimer_daytime();
+  int64_t now    = stimer_time_ns(&tick->timer);
+  double daytime = stimer_daytime_of(((double) now) * 1e-9);
   double dt = 0.;
+  double expect = o->interval * 1e-3; // next dt [s]
+  int stepped = stimer_stepped(&tick->timer);
+  stracer_rec_t *rec = o->trace ?
+                       stracer_next(&tick->trace, tick->counter) :
+                       (stracer_rec_t*) NULL;
+
+  if (rec)
+  {
+    rec->t[TICK_TRACE_DEADLINE] = tick->timer.deadline;
+    rec->t[TICK_TRACE_WAKEUP]   = tick->timer.wakeup;
+    rec->t[TICK_TRACE_ENTRY]    = now;
+  }
 
-  if (tick->state > 0)
+  // задержка пробуждения относительно расчетного момента
+  if (!stepped)
+    sstat_add(&tick->latency, now - tick->timer.deadline);
+
+  if (tick->state > 0 && stepped)
+  { // был скачок системных часов - период не учитывать
+    tick->skipped++;
+  }
+  else if (tick->state > 0)
   {
     dt = stimer_limit_delta(daytime - tick->daytime);
     tick->dt_sum += dt;
@@ -189,33 +889,101 @@ static int tick_timer_handler(void *context)
 
   tick->daytime = daytime;
 
+  // фактические моменты пробуждения для реальной средней частоты
+  // (расчетные моменты повторили бы только расписание таймера)
+  if (tick->counter == 0)
+    tick->first = tick->timer.wakeup;
+  else if (stepped)
+    tick->steps_ns += (int64_t) (tick->timer.step * 1e9);
+  tick->last = tick->timer.wakeup;
+
   // накапливать статистику по периоду прерываний
+  // (после скачка часов период не учитывать)
   if (tick->state == 0)
   {
     tick->dt_min = tick->dt_max = 0.;
     tick->state++;
   }
-  else if (tick->state == 1)
+  else if (tick->state == 1 && !stepped)
   {
     tick->dt_min = tick->dt_max = dt;
     tick->state++;
   }
-  else // if (tick->state == 2) 
+  else if (!stepped) // if (tick->state == 2)
   {
     if (tick->dt_max < dt) tick->dt_max = dt;
     if (tick->dt_min > dt) tick->dt_min = dt;
   }
 
-  // up GPIO pin
-  if (!o->fake)
-    sgpio_set(gpio, !o->negative);
+  if (rec) rec->t[TICK_TRACE_GPIO] = stimer_time_ns(&tick->timer);
+  if (o->wave || o->program)
+  { // next edge of compiled table or next step of compiled script
+    int64_t delta;
+    if (o->wave)
+    {
+      const swave_edge_t *e = swave_next(&tick->wave);
+      tick_output(tick, e->mask);
+      delta = e->delta_ns;
+    }
+    else
+    {
+      delta = sseq_step(&tick->seq);
+      tick_output(tick, tick->seq.levels);
+      if (delta <= 0)
+      { // end of script (or run time error)
+        tick->seq_err = (int) delta;
+        stimer_stop(&tick->timer);
+        delta = tick->timer.period;
+      }
+    }
+    if (rec)
+      rec->t[TICK_TRACE_GPIO_UP] = rec->t[TICK_TRACE_GPIO_DOWN] =
+        stimer_time_ns(&tick->timer);
 
-  // tau FIXME
-  //...
+    if (tick->queued)
+    { // levels are set at next deadline, hold levels in effect now
+      int64_t hold = tick->hold;
+      tick->hold = delta;
+      delta = hold;
+    }
 
-  // down GPIO pin
-  if (!o->fake)
-    sgpio_set(gpio, o->negative);
+    // next edge time
+    stimer_shift_ns(&tick->timer, delta - tick->timer.period);
+    expect = ((double) delta) * 1e-9;
+  }
+  else if (o->shift)
+  { // byte stream to shift register(s), latched at the end
+    int err = sshift_write(&tick->shift, o->shift, o->shift_len);
+    if (err != SSHIFT_ERR_NONE)
+    {
+      tick->shift_err = err;
+      tick->shift_errors++;
+    }
+    if (rec)
+      rec->t[TICK_TRACE_GPIO_UP] = rec->t[TICK_TRACE_GPIO_DOWN] =
+        stimer_time_ns(&tick->timer);
+  }
+  else
+  {
+    // up GPIO pin(s) of this shard
+    tick_output(tick, 0xFFFFFFFFU);
+    if (rec) rec->t[TICK_TRACE_GPIO_UP] = stimer_time_ns(&tick->timer);
+
+    // tau FIXME
+    //...
+
+    // down GPIO pin(s) of this shard
+    tick_output(tick, 0);
+    if (rec) rec->t[TICK_TRACE_GPIO_DOWN] = stimer_time_ns(&tick->timer);
+  }
+
+  // разбудить клиентов (FUTEX_WAKE только если кто-то ждет)
+  if (o->bcast)
+  {
+    int err = sbcast_publish(&tick->bcast, tick->timer.deadline,
+                             stimer_time_ns(&tick->timer));
+    if (err != SBCAST_ERR_NONE) tick->bcast_err = err;
+  }
 
   if (0)
   {
@@ -231,101 +999,749 @@ static int tick_timer_handler(void *context)
            tick->dt_min * 1e3, tick->dt_max * 1e3, dt * 1e3);
   }
 
+  // запомнить окрестность выброса периода
+  if (rec)
+  {
+    if (o->trace_trigger > 0. && tick->state > 1 && !stepped &&
+        fabs(dt - tick->expect) > o->trace_trigger * 1e-6)
+      stracer_trigger(&tick->trace, o->trace / 4);
+    rec->t[TICK_TRACE_EXIT] = stimer_time_ns(&tick->timer);
+  }
+  tick->expect = expect;
+
   // счетчик прерываний
   tick->counter++;
+  if (o->count && tick->counter >= o->count)
+    stimer_stop(&tick->timer);
   
   return 0;
 }
 //-----------------------------------------------------------------------------
-static void tick_init(tick_t *tick)
-{
-  tick->state   = 0;
-  tick->counter = 0;
-  tick->daytime = 0.; 
-  tick->dt_min  = 0.;
-  tick->dt_max  = 0.;
-  tick->dt_sum  = 0.;
-}
-//-----------------------------------------------------------------------------
-int main(int argc, const char *argv[])
+// compile delay generator table: edges sorted by time after trigger
+// (i-th delay pulses i-th GPIO)
+static void tick_delay_compile(tick_t *tick)
 {
-  int retv;
-  tick_t tick;
-  options_t *o    = &tick.options;
-  sgpio_t *gpio   = &tick.gpio;
-  stimer_t *timer = &tick.timer;
-  long double dt_mid;
-  
-  FILE *fout; // statstics output (stdout/stderr)
+  const options_t *o = &tick->options;
+  int64_t t[2 * TICK_GPIO_MAX], x;
+  uint32_t mask;
+  int i, j, n = 0;
 
-  // разобрать опции командной строки
-  tick_parse_options(argc, argv, o);
+  for (i = 0; i < o->delays; i++)
+  {
+    t[n++] = o->delay_at[i];
+    t[n++] = o->delay_at[i] + o->delay_width[i];
+  }
 
-  // обнулить статистику
-  tick_init(&tick);
+  for (i = 1; i < n; i++)
+  { // insertion sort (64 items max)
+    x = t[i];
+    for (j = i; j > 0 && t[j - 1] > x; j--)
+      t[j] = t[j - 1];
+    t[j] = x;
+  }
 
-  // вывести параметры запуска
-  if (o->verbose >= 1)
+  tick->delay_edges = 0;
+  for (i = 0; i < n; i++)
   {
-    printf("--> TICK start with next parameters:\n");
-    printf("-->   interval      = %i ms\n", o->interval);
-    printf("-->   gpio_num      = %i\n",    o->gpio_num);
-    printf("-->   verbose level = %i\n",    o->verbose);
-    //printf("-->   data          = %i\n",    o->data);
-    printf("-->   negative      = %s\n",    o->negative ? "yes" : "no");
-    printf("-->   meandr        = %s\n",    o->meandr   ? "yes" : "no");
-    printf("-->   fake GPIO     = %s\n",    o->fake     ? "yes" : "no");
-    printf("-->   tau           = %i\n",    o->tau);
-    printf("-->   real time     = %s\n",    o->realtime ? "yes" : "no");
+    if (i && t[i] == t[i - 1]) continue; // one edge for all pins
+    for (mask = 0, j = 0; j < o->delays; j++)
+      if (o->delay_at[j] <= t[i] && t[i] < o->delay_at[j] + o->delay_width[j])
+        mask |= 1U << j;
+    tick->delay[tick->delay_edges].at   = t[i];
+    tick->delay[tick->delay_edges].mask = mask;
+    tick->delay_edges++;
   }
-  
-  // вывести на консоль начальное время
-  if (o->verbose >= 2)
-  {
-    printf("->> local day time is ");
-    stimer_fprint_daytime(stdout, stimer_daytime());
-    printf("\n");
+}
+//-----------------------------------------------------------------------------
+// wait trigger (rising edge of input GPIO), fake input is emulated
+// by trigger every interval (return 1 or 0 if timer is stopped)
+static int tick_trigger(tick_t *tick)
+{
+  stimer_t *timer = &tick->timer;
+  int64_t mono;
+  int retv;
+
+  if (tick->options.fake)
+  { // virtual time of simulation too
+    int64_t now = stimer_time_ns(timer);
+    tick->trigger = tick->triggers ? tick->trigger + timer->period :
+                                     timer->deadline;
+    if (tick->trigger < now) tick->trigger = now;
+    return 1;
   }
 
-  // инициализировать GPIO
-  if (!o->fake)
+  // persistent epoll set: one syscall per wait
+  while (!timer->stop)
   {
-    sgpio_init(gpio, o->gpio_num);
-    if (o->verbose >= 3)
-      printf(">>> sgpio_init(%d) finish\n", o->gpio_num);
-
-    if (1) // unexport
+    retv = sgpio_edge_wait(&tick->input, TICK_TRIGGER_POLL_MS, &mono);
+    if (retv > 0)
+    { // wake-up time stands for edge time (sysfs has no edge timestamps)
+      tick->trigger = mono + timer->offset;
+      return 1;
+    }
+    if (retv < 0)
     {
-      retv = sgpio_unexport(o->gpio_num);
-      if (o->verbose >= 3)
-        printf(">>> sgpio_unexport(%d) return '%s'\n",
-               o->gpio_num, sgpio_error_str(retv));
+      tick->trigger_err = retv;
+      stimer_stop(timer);
     }
+  }
+  return 0;
+}
+//-----------------------------------------------------------------------------
+// delay generator: wait trigger, then output edges of delay table at
+// programmed times after trigger (timer sleeps between edges)
+static int tick_delay_handler(void *context)
+{
+  tick_t *tick = (tick_t*) context;
+  const options_t *o = &tick->options;
+  stimer_t *timer = &tick->timer;
+  int64_t now = stimer_time_ns(timer);
 
-    if (1) // export
+  if (!stimer_stepped(timer))
+    sstat_add(&tick->latency, now - timer->deadline);
+
+  if (tick->delay_pos > 0)
+  { // output edge and its error to programmed time
+    const tick_edge_t *e = tick->delay + tick->delay_pos - 1;
+    tick_output(tick, e->mask);
+    sstat_add(&tick->delay_err,
+              stimer_time_ns(timer) - (tick->trigger + e->at));
+  }
+  tick->counter++;
+
+  if (tick->delay_pos == 0 || tick->delay_pos == tick->delay_edges)
+  { // all edges are done: wait next trigger
+    if (tick->delay_pos)
     {
-      retv = sgpio_export(o->gpio_num);
-      if (o->verbose >= 3)
-        printf(">>> sgpio_export(%d) return '%s'\n",
-               o->gpio_num, sgpio_error_str(retv));
+      tick->triggers++;
+      if (o->count && tick->triggers >= o->count)
+      {
+        stimer_stop(timer);
+        return 0;
+      }
     }
-  
-    // устаовить режим вывода порта GPIO
-    retv = sgpio_mode(gpio, SGPIO_DIR_OUT, SGPIO_EDGE_NONE);
-    if (o->verbose >= 3)
-      printf(">>> sgpio_mode(%d,%d,%d) return '%s'\n",
-             sgpio_num(gpio), SGPIO_DIR_OUT, SGPIO_EDGE_NONE,
-             sgpio_error_str(retv));
+    if (!tick_trigger(tick)) return 0;
+    tick->delay_pos = 0;
+  }
+
+  // next edge time
+  return stimer_shift_ns(timer, tick->trigger +
+                         tick->delay[tick->delay_pos++].at - timer->next);
+}
+//-----------------------------------------------------------------------------
+// logic analyzer: sample input pins to capture ring
+// (drain thread writes it to file)
+static int tick_capture_handler(void *context)
+{
+  tick_t *tick = (tick_t*) context;
+  const options_t *o = &tick->options;
+  stimer_t *timer = &tick->timer;
+  int64_t now = stimer_time_ns(timer);
+  unsigned missed = timer->overrun - tick->cap_overrun;
+  uint32_t mask = 0;
+  int i, val;
+
+  if (!stimer_stepped(timer))
+    sstat_add(&tick->latency, now - timer->deadline);
+
+  for (i = 0; i < o->gpio_count; i++)
+  { // one pread() per pin
+    val = sgpio_get(tick->gpio + i);
+    if (val > 0)
+      mask |= 1U << i;
+    else if (val < 0)
+      tick->cap_errors++;
+  }
+
+  // missed expirations keep last levels (sample time is implicit)
+  if (missed)
+  {
+    scap_push(&tick->cap, tick->cap_last, missed);
+    tick->cap_gaps   += missed;
+    tick->cap_overrun = timer->overrun;
+  }
+  scap_push(&tick->cap, mask, 1);
+  tick->cap_last = mask;
+
+  tick->counter++;
+  if (o->count && tick->counter >= o->count)
+    stimer_stop(timer);
+
+  return 0;
+}
+//-----------------------------------------------------------------------------
+// hardware PWM (-H): pulses are generated by PWM channel and timer is
+// not started; with input loopback (-I) period is measured by its rising
+// edges, else periods are counted by time (-c, Ctrl-C) (return 0)
+static int tick_pwm_run(tick_t *tick)
+{
+  const options_t *o = &tick->options;
+  stimer_t *timer = &tick->timer;
+  int64_t t0, now, end, period = tick->pwm.period_ns;
+  double dt;
+
+  if (o->input_num < 0)
+  { // нет петли: спать N периодов (-c) или до сигнала
+    t0  = stimer_time_ns(timer);
+    end = o->count ? t0 + period * (int64_t) o->count : INT64_MAX;
+    while (!timer->stop && (now = stimer_time_ns(timer)) < end)
+      stimer_sleep_ms(end - now < TICK_TRIGGER_POLL_MS * 1000000LL ?
+                      ((double) (end - now)) * 1e-6 : TICK_TRIGGER_POLL_MS);
+    now = stimer_time_ns(timer);
+    tick->counter = (unsigned) (((now < end ? now : end) - t0) / period);
+    return 0;
+  }
+
+  while (tick_trigger(tick))
+  { // период между фронтами на входе петли
+    if (tick->counter == 0)
+      tick->first = tick->trigger;
+    else
+    {
+      dt = ((double) (tick->trigger - tick->last)) * 1e-9;
+      if (tick->state < 2 || tick->dt_min > dt) tick->dt_min = dt;
+      if (tick->state < 2 || tick->dt_max < dt) tick->dt_max = dt;
+      tick->dt_sum += dt;
+      tick->state = 2;
+    }
+    tick->last = tick->trigger;
+
+    tick->counter++;
+    if (o->count && tick->counter >= o->count)
+      stimer_stop(timer);
+  }
+
+  return 0;
+}
+//-----------------------------------------------------------------------------
+// return why hardware PWM can't replace timer pulses (or NULL if fits)
+static const char *tick_pwm_unfit(const options_t *o)
+{
+  double period = o->interval * 1e6; // ns
+
+  if (o->fake)
+    return "fake GPIO";
+  if (o->wave || o->program || o->delays || o->capture)
+    return "not plain periodic pulses";
+  if (o->pll)
+    return "timer is disciplined by PLL";
+  if (o->shards > 1)
+    return "shards";
+  if (fabs(period - floor(period + 0.5)) > 1e-3)
+    return "fractional period";
+  if (o->pwm_width >= (int64_t) (period + 0.5))
+    return "pulse width >= period";
+  return (const char*) NULL;
+}
+//-----------------------------------------------------------------------------
+// program and enable hardware PWM channel (return SPWM_ERR_*)
+static int tick_pwm_start(tick_t *tick)
+{
+  const options_t *o = &tick->options;
+  int retv;
+
+  if (o->pwm_path)
+    spwm_set_path(o->pwm_path);
+
+  retv = spwm_open(&tick->pwm, o->pwm_chip, o->pwm_channel,
+                   SPWM_EXPORT_TIMEOUT);
+  if (retv == SPWM_ERR_NONE)
+    retv = spwm_config(&tick->pwm, (int64_t) (o->interval * 1e6 + 0.5),
+                       o->pwm_width, o->negative);
+  if (retv == SPWM_ERR_NONE)
+    retv = spwm_enable(&tick->pwm, 1);
+  if (retv != SPWM_ERR_NONE)
+    spwm_close(&tick->pwm);
+
+  return retv;
+}
+//-----------------------------------------------------------------------------
+// perf counters around timer handler (-C): one group read before and
+// after, so handler is perturbed by two read() syscalls only
+static int tick_perf_handler(void *context)
+{
+  tick_t *tick = (tick_t*) context;
+  int retv;
+
+  if (sperf_begin(&tick->perf) < 0)
+    return tick->handler(context); // sample skipped
+
+  retv = tick->handler(context);
+  sperf_end(&tick->perf);
+
+  return retv;
+}
+//-----------------------------------------------------------------------------
+// open perf counters of calling (timer) thread
+static void tick_perf_open(tick_t *tick)
+{
+  int retv = sperf_open(&tick->perf);
+  if (retv != SPERF_ERR_NONE)
+    fprintf(stderr, "warning: perf counters of shard %d fail: '%s'\n",
+            tick->shard, sperf_error_str(retv));
+}
+//-----------------------------------------------------------------------------
+static void tick_init(tick_t *tick)
+{
+  tick->state   = 0;
+  tick->counter = 0;
+  tick->skipped = 0;
+  tick->daytime = 0.; 
+  tick->dt_min  = 0.;
+  tick->dt_max  = 0.;
+  tick->dt_sum  = 0.;
+  sstat_init(&tick->latency);
+  tick->stress.num = 0;
+  tick->seq_err    = SSEQ_ERR_NONE;
+  sgpio_init(&tick->input, tick->options.input_num);
+  tick->startup = 0.;
+  tick->expect  = tick->options.interval * 1e-3;
+  tick->queued  = tick->options.backend == STIMER_BACKEND_URING &&
+                  !tick->options.fake;
+  tick->hold    = (int64_t) (tick->options.interval * 1e6);
+  tick->shard   = 0;
+  tick->bcast_err = SBCAST_ERR_NONE;
+  tick->delay_edges = 0;
+  tick->delay_pos   = 0;
+  tick->trigger     = 0;
+  tick->triggers    = 0;
+  tick->trigger_err = SGPIO_ERR_NONE;
+  sstat_init(&tick->delay_err);
+  tick->first    = 0;
+  tick->last     = 0;
+  tick->steps_ns = 0;
+  tick->cap_last    = 0;
+  tick->cap_overrun = 0;
+  tick->cap_gaps    = 0;
+  tick->cap_errors  = 0;
+  tick->handler     = tick->options.delays  ? tick_delay_handler   :
+                      tick->options.capture ? tick_capture_handler :
+                                              tick_timer_handler;
+  tick->pwm_on      = 0;
+  tick->pwm_why     = (const char*) NULL;
+  sshift_init(&tick->shift);
+  tick->shift_err    = SSHIFT_ERR_NONE;
+  tick->shift_errors = 0;
+}
+//-----------------------------------------------------------------------------
+// get shard by index (0 - main thread)
+static inline tick_t *tick_shard(tick_t *tick, int i)
+{
+  return i ? tick_shards + i : tick;
+}
+//-----------------------------------------------------------------------------
+// timer thread of shard 1...N-1
+static void *tick_shard_thread(void *context)
+{
+  tick_t *tick = (tick_t*) context;
+  if (tick->options.counters) tick_perf_open(tick);
+  return (void*) (intptr_t) stimer_loop(&tick->timer);
+}
+//-----------------------------------------------------------------------------
+// start timer threads of shards 1...N-1 (return 0 or -1 on error)
+static int tick_shards_start(tick_t *tick)
+{
+  const options_t *o = &tick->options;
+  pthread_attr_t attr;
+  sigset_t all, old;
+  cpu_set_t cpuset;
+  int i, retv = 0;
+
+  // timer threads don't take signals (SIGINT) from main thread,
+  // real time policy is inherited from main thread
+  sigfillset(&all);
+  pthread_sigmask(SIG_BLOCK, &all, &old);
+
+  for (i = 1; i < o->shards; i++)
+  {
+    tick_t *shard = tick_shards + i;
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+    if (o->shard_cpus[i] >= 0)
+    {
+      CPU_ZERO(&cpuset);
+      CPU_SET(o->shard_cpus[i], &cpuset);
+      pthread_attr_setaffinity_np(&attr, sizeof(cpuset), &cpuset);
+    }
+
+    if (pthread_create(&shard->thread, &attr, tick_shard_thread,
+                       (void*) shard) != 0)
+    {
+      perror("error: pthread_create() fail");
+      pthread_attr_destroy(&attr);
+      retv = -1;
+      break;
+    }
+    pthread_attr_destroy(&attr);
+  }
+
+  pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+  if (retv < 0)
+  { // stop already started threads
+    while (--i > 0)
+    {
+      stimer_stop(&tick_shards[i].timer);
+      pthread_join(tick_shards[i].thread, NULL);
+    }
+    return -1;
+  }
+
+  // main thread is shard 0
+  if (o->shard_cpus[0] >= 0)
+  {
+    CPU_ZERO(&cpuset);
+    CPU_SET(o->shard_cpus[0], &cpuset);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+  }
+
+  return 0;
+}
+//-----------------------------------------------------------------------------
+// join timer threads (return 0 or -1 if stimer_loop() of thread fail)
+static int tick_shards_join(tick_t *tick)
+{
+  int i, retv = 0;
+  void *res;
+
+  for (i = 1; i < tick->options.shards; i++)
+  {
+    pthread_join(tick_shards[i].thread, &res);
+    if ((intptr_t) res < 0) retv = -1;
+  }
+
+  return retv;
+}
+//-----------------------------------------------------------------------------
+// merge statistics of joined shards to shard 0
+// (each shard owns its statistics, no locks while timers run)
+static void tick_shards_merge(tick_t *tick)
+{
+  int i;
+
+  for (i = 1; i < tick->options.shards; i++)
+  {
+    const tick_t *shard = tick_shards + i;
+
+    if (shard->state > 1)
+    {
+      if (tick->state < 2 || tick->dt_min > shard->dt_min)
+        tick->dt_min = shard->dt_min;
+      if (tick->state < 2 || tick->dt_max < shard->dt_max)
+        tick->dt_max = shard->dt_max;
+      tick->state = 2;
+    }
+    tick->dt_sum  += shard->dt_sum;
+    tick->counter += shard->counter;
+    tick->skipped += shard->skipped;
+    sstat_merge(&tick->latency, &shard->latency);
+    tick->timer.overrun      += shard->timer.overrun;
+    tick->timer.write_errors += shard->timer.write_errors;
+    tick->timer.steps        += shard->timer.steps;
+    if (tick->options.counters)
+      sperf_merge(&tick->perf, &shard->perf);
+  }
+}
+//-----------------------------------------------------------------------------
+int main(int argc, const char *argv[])
+{
+  int retv, i, j;
+  tick_t tick;
+  options_t *o    = &tick.options;
+  sgpio_t *gpio   = tick.gpio;
+  stimer_t *timer = &tick.timer;
+  long double dt_mid;
+  int64_t t0, p99[TICK_SHARDS_MAX];
+  unsigned ticks[TICK_SHARDS_MAX];
+  sqos_t qos;                   // PM QoS request (-Q)
+  int qos_err = SQOS_ERR_NONE;
+  static sstat_t qos_probe[2];  // wake-up latency without/with PM QoS
+  int measured; // 0 if pulses are hardware-generated and not measured
+  
+  FILE *fout; // statstics output (stdout/stderr)
+
+  // разобрать опции командной строки
+  tick_parse_options(argc, argv, o);
+
+  // скрипт может закончиться, а записи io_uring выполняются на такт позже
+  if (o->program && o->backend == STIMER_BACKEND_URING)
+  {
+    fprintf(stderr, "error: -P is incompatible with -b uring; exit\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // трасса этапов пишется только обработчиком импульсов
+  if (o->trace && (o->delays || o->capture || o->pwm_chip >= 0))
+  {
+    fprintf(stderr, "error: -T is incompatible with -D, -L and -H; exit\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // генератор задержек: таймер спит между фронтами после запуска по входу
+  if (o->delays)
+  {
+    if (o->wave || o->program || o->shards > 1 ||
+        o->backend == STIMER_BACKEND_URING)
+    {
+      fprintf(stderr, "error: -D is incompatible with -W, -P, -j and "
+              "-b uring; exit\n");
+      exit(EXIT_FAILURE);
+    }
+    if (o->input_num < 0 && !o->fake && !o->sim)
+    {
+      fprintf(stderr, "error: -D requires input GPIO (-I NUM); exit\n");
+      exit(EXIT_FAILURE);
+    }
+    if (o->delays > o->gpio_count)
+    {
+      fprintf(stderr, "error: -D has %d delays for %d GPIO; exit\n",
+              o->delays, o->gpio_count);
+      exit(EXIT_FAILURE);
+    }
+    // handler blocks while waiting trigger: pending timer signal
+    // would fire at once after re-arm, timerfd is re-armed clean
+    if (o->backend == STIMER_BACKEND_SIGNAL)
+      o->backend = STIMER_BACKEND_TIMERFD;
+  }
+
+  // логический анализатор: ножки -g - входы, выборка на каждом такте
+  if (o->capture && (o->wave || o->program || o->delays || o->shards > 1))
+  {
+    fprintf(stderr, "error: -L is incompatible with -W, -P, -D and -j; "
+            "exit\n");
+    exit(EXIT_FAILURE);
+  }
+  if (o->capture && o->gpio_count > SCAP_PINS_MAX - 1)
+  {
+    fprintf(stderr, "error: -L samples up to %d GPIO; exit\n",
+            SCAP_PINS_MAX - 1);
+    exit(EXIT_FAILURE);
+  }
+
+  // регистр сдвига: на каждом такте поток байтов вместо импульса
+  if (o->shift)
+  {
+    if (o->wave || o->program || o->delays || o->capture ||
+        o->pwm_chip >= 0 || o->shards > 1 ||
+        o->backend == STIMER_BACKEND_URING)
+    {
+      fprintf(stderr, "error: -X is incompatible with -W, -P, -D, -L, -H, "
+              "-j and -b uring; exit\n");
+      exit(EXIT_FAILURE);
+    }
+    if (o->gpio_count != SSHIFT_PINS)
+    {
+      fprintf(stderr, "error: -X requires -g DATA,CLOCK,LATCH; exit\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // каждый поток (шард) ведет свои ножки GPIO и свой таймер
+  if (o->shards > o->gpio_count) o->shards = o->gpio_count;
+  if (o->shards > 1)
+  {
+    if (o->program || o->pll)
+    {
+      fprintf(stderr, "error: -j is incompatible with -P and -p; exit\n");
+      exit(EXIT_FAILURE);
+    }
+    // signal of POSIX timer is process wide: one timerfd per thread
+    if (o->backend == STIMER_BACKEND_SIGNAL)
+      o->backend = STIMER_BACKEND_TIMERFD;
+  }
+
+  // при любом exit() вернуть то, что изменено в системе (PM QoS, ШИМ)
+  atexit(tick_atexit);
+
+  // обнулить статистику
+  tick_init(&tick);
+  if (o->delays) tick_delay_compile(&tick);
+  for (i = 1; i < o->shards; i++)
+  { // trace and stdout data only from shard 0
+    tick_shards[i].options       = *o;
+    tick_shards[i].options.trace = 0;
+    tick_shards[i].options.data  = 0;
+    tick_shards[i].options.bcast = NULL;
+    tick_init(tick_shards + i);
+    tick_shards[i].shard = i;
+  }
+
+  // вывести параметры запуска
+  if (o->verbose >= 1)
+  {
+    printf("--> TICK start with next parameters:\n");
+    printf("-->   interval      = %.6f ms\n", o->interval);
+    if (o->freq > 0.)
+      printf("-->   frequency     = %.6f Hz\n", o->freq);
+    printf("-->   gpio_num      =");
+    for (i = 0; i < o->gpio_count; i++)
+      printf("%s%i", i ? "," : " ", o->gpio_nums[i]);
+    printf("\n");
+    printf("-->   verbose level = %i\n",    o->verbose);
+    //printf("-->   data          = %i\n",    o->data);
+    printf("-->   negative      = %s\n",    o->negative ? "yes" : "no");
+    printf("-->   meandr        = %s\n",    o->meandr   ? "yes" : "no");
+    printf("-->   fake GPIO     = %s\n",    o->fake     ? "yes" : "no");
+    printf("-->   tau           = %i\n",    o->tau);
+    printf("-->   real time     = %s\n",    o->realtime ? "yes" : "no");
+    printf("-->   PLL reference = %s\n",    o->pll ? o->pll : "none");
+    printf("-->   timer backend = %s\n",    stimer_backend_str(o->backend));
+    if (o->sim)
+      printf("-->   sim latency   = %s\n",    o->sim);
+    if (o->count)
+      printf("-->   count         = %u\n",    o->count);
+    if (o->stress)
+      printf("-->   stress        = %s\n",    o->stress);
+    if (o->trace)
+      printf("-->   trace         = %u ticks\n", o->trace);
+    if (o->bcast)
+      printf("-->   broadcast     = %s\n", o->bcast);
+    if (o->delays)
+      printf("-->   delays        = %i outputs, %i edges\n",
+             o->delays, tick.delay_edges);
+    if (o->capture)
+      printf("-->   capture       = %s\n", o->capture);
+    if (o->qos_us >= 0)
+      printf("-->   PM QoS        = %d us (%d cpus)\n", o->qos_us, o->qos_cpus);
+    if (o->pwm_chip >= 0)
+      printf("-->   PWM           = pwmchip%d/pwm%d, width %.3f us\n",
+             o->pwm_chip, o->pwm_channel, ((double) o->pwm_width) * 1e-3);
+    if (o->shift)
+      printf("-->   shift         = %u bytes, %s first, %lld ns\n",
+             o->shift_len, o->shift_order == SSHIFT_LSB_FIRST ? "lsb" : "msb",
+             (long long) o->shift_ns);
+    if (o->shards > 1)
+    {
+      printf("-->   shards        = %i (cpu", o->shards);
+      for (i = 0; i < o->shards; i++)
+        printf("%s%i", i ? "," : " ", o->shard_cpus[i]);
+      printf(")\n");
+    }
+  }
+  
+  // вывести на консоль начальное время
+  if (o->verbose >= 2)
+  {
+    printf("->> local day time is ");
+    stimer_fprint_daytime(stdout, stimer_daytime());
+    printf("\n");
+  }
+
+  // аппаратный ШИМ вместо таймера и sgpio_set(), если подходит режим;
+  // иначе (или при ошибке) - обычные программные импульсы
+  if (o->pwm_chip >= 0)
+  {
+    tick.pwm_why = tick_pwm_unfit(o);
+    if (tick.pwm_why == (const char*) NULL)
+    {
+      retv = tick_pwm_start(&tick);
+      if (o->verbose >= 3)
+        printf(">>> tick_pwm_start(%d:%d) return '%s'\n",
+               o->pwm_chip, o->pwm_channel, spwm_error_str(retv));
+      if (retv == SPWM_ERR_NONE)
+      {
+        tick.pwm_on = 1;
+        tick_pwm = &tick.pwm; // выключить и при выходе по ошибке
+      }
+      else
+        tick.pwm_why = spwm_error_str(retv);
+    }
+    if (tick.pwm_on)
+    { // выходы GPIO не нужны, таймер не запускается (tick_pwm_run())
+      o->gpio_count = 0;
+      if (o->verbose >= 1)
+        printf("-->   PWM period    = %lld ns, duty %lld ns\n",
+               (long long) tick.pwm.period_ns, (long long) tick.pwm.duty_ns);
+    }
+    else
+      fprintf(stderr, "warning: PWM is not used (%s), software pulses\n",
+              tick.pwm_why);
+  }
+
+  // регистр сдвига: быстрее всего символьное устройство GPIO (данные
+  // и такт одним ioctl), тогда ножки sysfs не нужны; не вышло - sysfs
+  if (o->shift && !o->fake &&
+      (o->shift_path < 0 || o->shift_path == SSHIFT_PATH_CDEV))
+  {
+    if (o->gpio_path)
+      sgpio_set_path(o->gpio_path);
+    retv = sshift_open_cdev(&tick.shift, o->gpio_nums);
+    if (o->verbose >= 3)
+      printf(">>> sshift_open_cdev(%d,%d,%d) return '%s'\n",
+             o->gpio_nums[0], o->gpio_nums[1], o->gpio_nums[2],
+             sshift_error_str(retv));
+    if (retv == SSHIFT_ERR_NONE)
+      o->gpio_count = 0;
+    else if (o->shift_path == SSHIFT_PATH_CDEV)
+      fprintf(stderr, "warning: shift by GPIO chip device fail: '%s', "
+              "sysfs writes\n", sshift_error_str(retv));
+  }
+
+  // инициализировать GPIO
+  if (!o->fake)
+  {
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    if (o->gpio_path)
+      sgpio_set_path(o->gpio_path);
+
+    for (i = 0; i < o->gpio_count; i++)
+      sgpio_init(gpio + i, o->gpio_nums[i]);
+
+    // уже экспортированные ножки используются повторно,
+    // все ножки настраиваются параллельно
+    retv = sgpio_provision(gpio, o->gpio_count,
+                           o->capture ? SGPIO_DIR_IN : SGPIO_DIR_OUT,
+                           SGPIO_EDGE_NONE, SGPIO_UDEV_TIMEOUT);
+    if (o->verbose >= 3)
+      printf(">>> sgpio_provision(%d,%d,%d) return '%s'\n",
+             o->gpio_count, o->capture ? SGPIO_DIR_IN : SGPIO_DIR_OUT,
+             SGPIO_EDGE_NONE, sgpio_error_str(retv));
+    if (retv != SGPIO_ERR_NONE)
+      fprintf(stderr, "warning: sgpio_provision() fail: '%s'\n",
+              sgpio_error_str(retv));
    
     // установить начальный уровень сигнала на порте GPIO
-    retv = sgpio_set(gpio, o->negative);
-    if (o->verbose >= 3)
-      printf(">>> sgpio_set(%i,%i) return '%s'\n",
-             sgpio_num(gpio), o->negative,
-             sgpio_error_str(retv));
+    for (i = 0; i < o->gpio_count && !o->capture; i++)
+    {
+      retv = sgpio_set(gpio + i, o->negative);
+      if (o->verbose >= 3)
+        printf(">>> sgpio_set(%i,%i) return '%s'\n",
+               sgpio_num(gpio + i), o->negative,
+               sgpio_error_str(retv));
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    tick.startup = (double) (t1.tv_sec  - t0.tv_sec) +
+                   (double) (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+    if (o->verbose >= 1)
+      printf("-->   gpio startup  = %.3f ms\n", tick.startup * 1e3);
+
+    // входная ножка для условий скрипта, запуска генератора задержек
+    // или петли аппаратного ШИМ (фронт ждется через постоянный набор epoll)
+    if (o->input_num >= 0)
+    {
+      int edges = o->delays || tick.pwm_on;
+      retv = sgpio_open(&tick.input, SGPIO_UDEV_TIMEOUT);
+      if (retv == SGPIO_ERR_NONE)
+        retv = sgpio_mode(&tick.input, SGPIO_DIR_IN,
+                          edges ? SGPIO_EDGE_RISING : SGPIO_EDGE_NONE);
+      if (retv == SGPIO_ERR_NONE && edges)
+        retv = sgpio_edge_open(&tick.input);
+      if (retv != SGPIO_ERR_NONE && edges)
+      {
+        fprintf(stderr, "error: input GPIO%d fail: '%s'; exit\n",
+                o->input_num, sgpio_error_str(retv));
+        exit(EXIT_FAILURE);
+      }
+      if (retv != SGPIO_ERR_NONE)
+        fprintf(stderr, "warning: input GPIO%d fail: '%s'\n",
+                o->input_num, sgpio_error_str(retv));
+    }
   } // if (!o->fake)
 
-  // зарегистрировать обработчик сигнала SIGINT (CTRL+C)
+  // зарегистрировать обработчик сигналов SIGINT (CTRL+C) и SIGTERM
   retv = stimer_sigint(tick_sigint_handler, (void*) &tick);
   if (o->verbose >= 3)
     printf(">>> stimer_sigint_handler() return %d\n", retv);
@@ -338,28 +1754,275 @@ int main(int argc, const char *argv[])
       printf(">>> stimer_realtime() return %d\n", retv);
   }
 
-  // инициализировать таймер
-  retv = stimer_init(timer, tick_timer_handler, (void*) &tick);
-  if (o->verbose >= 3)
-    printf(">>> stimer_init() return %d\n", retv);
-  if (retv != 0)
+  // скомпилировать последовательность импульсов в таблицу фронтов
+  if (o->wave)
+  {
+    retv = swave_compile(&tick.wave, o->wave);
+    if (retv != SWAVE_ERR_NONE)
+    {
+      fprintf(stderr, "error: bad wave '%s': %s; exit\n",
+              o->wave, swave_error_str(retv));
+      exit(EXIT_FAILURE);
+    }
+    if (o->verbose >= 1)
+      printf("-->   wave          = %u edges, period %.3f us\n",
+             tick.wave.count, ((double) tick.wave.period_ns) * 1e-3);
+  }
+  else if (o->program)
+  { // скрипт компилируется в байт-код заранее
+    unsigned line;
+    retv = sseq_load(&tick.seq, o->program, &line);
+    if (retv != SSEQ_ERR_NONE)
+    {
+      fprintf(stderr, "error: script '%s' line %u: %s; exit\n",
+              o->program, line, sseq_error_str(retv));
+      exit(EXIT_FAILURE);
+    }
+    if (o->input_num >= 0)
+      sseq_input(&tick.seq, tick_input, (void*) &tick);
+    if (o->verbose >= 1)
+      printf("-->   program       = %s (%u operations)\n",
+             o->program, tick.seq.count);
+    if (o->verbose >= 3)
+      sseq_dump(&tick.seq, stdout);
+  }
+
+  for (i = 0; i < o->shards; i++)
+  { // ножки распределяются по шардам по кругу (i-я ножка - шарду i % N)
+    tick_t *shard = tick_shard(&tick, i);
+    shard->out_xor    = o->negative ? 0xFFFFFFFFU : 0;
+    shard->out_levels = shard->out_xor;
+    shard->out_pins   = 0;
+    for (j = i; j < o->gpio_count; j += o->shards)
+      shard->out_pins |= 1U << j;
+    if (i && o->wave)
+    { // общая таблица фронтов, своя позиция
+      shard->wave     = tick.wave;
+      shard->wave.own = 0;
+    }
+
+    // инициализировать таймер
+    retv = stimer_init_ex(&shard->timer, o->backend,
+                          o->counters ? tick_perf_handler : shard->handler,
+                          (void*) shard);
+    if (o->verbose >= 3)
+      printf(">>> stimer_init() return %d\n", retv);
+    if (retv != 0)
+    {
+      perror("error: stimer_init() fail; exit");
+      exit(EXIT_FAILURE);
+    }
+
+    if (o->sim && stimer_sim(&shard->timer, o->sim, 1 + i) != 0)
+    {
+      fprintf(stderr, "error: bad simulated latency '%s'; exit\n", o->sim);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // в режиме fake фронты GPIO записываются в память
+  // (метки времени берутся от таймера, поэтому после его инициализации)
+  if (o->fake)
+  { // у каждого шарда свой буфер (сливаются по времени в конце)
+    for (i = 0; i < o->shards; i++)
+    {
+      tick_t *shard = tick_shard(&tick, i);
+      unsigned pins = __builtin_popcount(shard->out_pins);
+      unsigned size = o->events ? o->events :
+                      o->count && o->shift ?
+                        (24 * o->shift_len + 2) * o->count + SSHIFT_PINS :
+                      o->count  ? (2 * o->count + 1) * pins :
+                                  SGPIO_FAKE_SIZE;
+      retv = sgpio_fake_init(&shard->rec, size);
+      if (retv != SGPIO_ERR_NONE)
+      {
+        fprintf(stderr, "error: sgpio_fake_init() fail: '%s'; exit\n",
+                sgpio_error_str(retv));
+        exit(EXIT_FAILURE);
+      }
+      sgpio_fake_clock(&shard->rec, tick_clock, (void*) shard);
+    }
+    for (i = 0; i < o->gpio_count; i++)
+    {
+      sgpio_init(gpio + i, o->gpio_nums[i]);
+      sgpio_fake(gpio + i, &tick_shard(&tick, i % o->shards)->rec);
+      if (o->capture)
+        sgpio_mode(gpio + i, SGPIO_DIR_IN, SGPIO_EDGE_NONE);
+      else
+      {
+        sgpio_mode(gpio + i, SGPIO_DIR_OUT, SGPIO_EDGE_NONE);
+        sgpio_set(gpio + i, o->negative);
+      }
+    }
+    if (o->input_num >= 0)
+    { // fake input is always 0
+      sgpio_fake(&tick.input, &tick.rec);
+      sgpio_mode(&tick.input, SGPIO_DIR_IN, SGPIO_EDGE_NONE);
+    }
+  }
+
+  // регистр сдвига на ножках sysfs (записи цепочкой io_uring) или fake
+  if (o->shift && tick.shift.path != SSHIFT_PATH_CDEV)
+  {
+    int uring = !o->fake && o->shift_path == SSHIFT_PATH_URING;
+    retv = sshift_open_gpio(&tick.shift, gpio, uring);
+    if (o->verbose >= 3)
+      printf(">>> sshift_open_gpio(%d) return '%s'\n", uring,
+             sshift_error_str(retv));
+    if (retv != SSHIFT_ERR_NONE)
+      fprintf(stderr, "warning: shift by io_uring fail: '%s', "
+              "sysfs writes\n", sshift_error_str(retv));
+  }
+  if (o->shift)
+  {
+    sshift_timing(&tick.shift, o->shift_order, o->shift_ns, o->shift_ns);
+    if (o->verbose >= 1)
+      printf("-->   shift path    = %s\n",
+             sshift_path_str(sshift_path_used(&tick.shift)));
+  }
+
+  // подстраивать таймер по опорному источнику
+  spll_init(&tick.pll, o->interval * 1e-3, SPLL_KP, SPLL_KI);
+  if (o->pll)
+  {
+    if (!strcmp(o->pll, "raw"))
+      spll_ref_monoraw(&tick.pll);
+    else if (spll_ref_file(&tick.pll, o->pll) < 0)
+    {
+      perror("error: spll_ref_file() fail; exit");
+      exit(EXIT_FAILURE);
+    }
+    stimer_pll(timer, &tick.pll);
+  }
+
+  // публиковать такты в разделяемой памяти
+  if (o->bcast)
   {
-    perror("error: stimer_init() fail; exit");
+    retv = sbcast_open(&tick.bcast, o->bcast, 1);
+    if (o->verbose >= 3)
+      printf(">>> sbcast_open('%s') return '%s'\n",
+             o->bcast, sbcast_error_str(retv));
+    if (retv != SBCAST_ERR_NONE)
+    {
+      fprintf(stderr, "error: sbcast_open('%s') fail: '%s'; exit\n",
+              o->bcast, sbcast_error_str(retv));
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // удерживать запрос PM QoS (без глубоких C-states) на время работы;
+  // задержка пробуждения измеряется пробными засыпаниями до и после
+  if (o->qos_us >= 0)
+  {
+    double ms = o->interval < 0.1 ? 0.1 : o->interval > 1. ? 1. : o->interval;
+    sstat_init(qos_probe);
+    sstat_init(qos_probe + 1);
+    sqos_probe(qos_probe, TICK_QOS_PROBES, (int64_t) (ms * 1e6));
+    qos_err = sqos_hold(&qos, o->qos_us, o->qos_cpus, o->qos_cpu);
+    tick_qos = &qos; // снять и при выходе по ошибке
+    if (o->verbose >= 3)
+      printf(">>> sqos_hold(%d) return '%s'\n", o->qos_us,
+             sqos_error_str(qos_err));
+    if (qos_err != SQOS_ERR_NONE)
+      fprintf(stderr, "warning: PM QoS: '%s'\n", sqos_error_str(qos_err));
+    sqos_probe(qos_probe + 1, TICK_QOS_PROBES, (int64_t) (ms * 1e6));
+  }
+
+  // кольцевой буфер выборок очищается до запуска таймера
+  if (o->capture)
+  {
+    retv = scap_init(&tick.cap, o->capture,
+                     o->events ? o->events : SCAP_RING_SIZE,
+                     o->gpio_count, o->gpio_nums);
+    if (retv != SCAP_ERR_NONE)
+    {
+      fprintf(stderr, "error: capture to '%s' fail: '%s'; exit\n",
+              o->capture, scap_error_str(retv));
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // запустить таймер(ы) от общей метки времени (фазы шардов совпадают);
+  // импульсы аппаратного ШИМ идут без таймера
+  t0 = stimer_time_ns(timer) + (int64_t) (o->interval * 1e6);
+  for (i = 0; i < o->shards && !tick.pwm_on; i++)
+  {
+    tick_t *shard = tick_shard(&tick, i);
+    if (i) memcpy(shard->gpio, gpio, sizeof(tick.gpio));
+    retv = o->freq > 0. ? stimer_start_hz(&shard->timer, o->freq, t0) :
+                          stimer_start_at(&shard->timer, o->interval, t0);
+    if (o->verbose >= 3)
+      printf(">>> stimer_start(%.6f) return %d\n", o->interval, retv);
+    if (retv != 0)
+    {
+      perror("error: stimer_start() fail; exit");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // поток записи выборок в файл (время первой выборки - в заголовке)
+  if (o->capture)
+  {
+    retv = scap_start(&tick.cap, t0, stimer_period_ns(timer));
+    if (retv != SCAP_ERR_NONE)
+    {
+      fprintf(stderr, "error: capture to '%s' fail: '%s'; exit\n",
+              o->capture, scap_error_str(retv));
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // выделить память под трассировку заранее
+  if (o->trace &&
+      stracer_init(&tick.trace, o->trace, TICK_TRACE_STAGES,
+                   tick_trace_names) != 0)
+  {
+    fprintf(stderr, "error: stracer_init(%u) fail; exit\n", o->trace);
     exit(EXIT_FAILURE);
   }
 
-  // запустить таймер
-  retv = stimer_start(timer, (double) o->interval);
-  if (o->verbose >= 3)
-    printf(">>> stimer_start(%d) return %d\n", o->interval, retv);
-  if (retv != 0)
+  // запустить фоновую нагрузку
+  if (o->stress)
   {
-    perror("error: stimer_start() fail; exit");
+    if (sstress_init(&tick.stress, o->stress) != 0)
+    {
+      fprintf(stderr, "error: bad stress spec '%s'; exit\n", o->stress);
+      exit(EXIT_FAILURE);
+    }
+    retv = sstress_start(&tick.stress);
+    if (o->verbose >= 3)
+      printf(">>> sstress_start() return %d\n", retv);
+    if (retv < 0)
+    {
+      fprintf(stderr, "error: sstress_start() fail; exit\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // запустить потоки шардов 1...N-1
+  if (o->shards > 1 && tick_shards_start(&tick) < 0)
+  {
+    fprintf(stderr, "error: can't start %d timer threads; exit\n",
+            o->shards - 1);
     exit(EXIT_FAILURE);
   }
 
-  // ждать сигнала и вызывать обработчик "вечно"
-  retv = stimer_loop(timer);
+  // счетчики perf считают поток таймера (у каждого шарда свои)
+  if (o->counters)
+  {
+    tick_perf_open(&tick);
+    if (o->verbose >= 1)
+    {
+      printf("-->   perf counters =");
+      for (i = 0, j = 0; i < SPERF_COUNTERS; i++)
+        if (sperf_available(&tick.perf, i))
+          printf("%s%s", j++ ? "," : " ", sperf_name(i));
+      printf("\n");
+    }
+  }
+
+  // ждать сигнала и вызывать обработчик "вечно" (ШИМ - без таймера)
+  retv = tick.pwm_on ? tick_pwm_run(&tick) : stimer_loop(timer);
   if (o->verbose >= 3)
     printf(">>> stimer_loop() return %i\n", retv);
   if (retv < 0)
@@ -368,34 +2031,304 @@ int main(int argc, const char *argv[])
     exit(EXIT_FAILURE);
   }
 
-  if (!o->fake && 1) // set to input (more safe mode)
+  // дождаться потоков шардов и слить статистику
+  if (tick_shards_join(&tick) < 0)
+    fprintf(stderr, "error: stimer_loop() of timer thread fail\n");
+
+  // остановить аппаратный ШИМ
+  if (tick.pwm_on)
   {
-    retv = sgpio_mode(gpio, SGPIO_DIR_IN, SGPIO_EDGE_NONE);
-    if (o->verbose >= 3)
-      printf(">>> sgpio_mode(%d,%d,%d) return '%s'\n",
-             sgpio_num(gpio), SGPIO_DIR_IN, SGPIO_EDGE_NONE,
-             sgpio_error_str(retv));
+    spwm_close(&tick.pwm);
+    tick_pwm = (spwm_t*) NULL;
   }
 
-  if (!o->fake && 1) // unexport
+  // отпустить линии GPIO или io_uring регистра сдвига
+  if (o->shift)
+    sshift_close(&tick.shift);
+
+  // снять запрос PM QoS, вернуть прежние ограничения ядер
+  if (o->qos_us >= 0)
   {
-    retv = sgpio_unexport(o->gpio_num);
+    sqos_release(&qos);
+    tick_qos = (sqos_t*) NULL;
+  }
+  for (i = 0; i < o->shards; i++)
+  {
+    tick_t *shard = tick_shard(&tick, i);
+    p99[i]   = sstat_percentile(&shard->latency, 99.);
+    ticks[i] = shard->counter;
+  }
+  tick_shards_merge(&tick);
+
+  // остановить фоновую нагрузку
+  sstress_join(&tick.stress);
+
+  // дописать остаток буфера выборок
+  if (o->capture)
+  {
+    retv = scap_stop(&tick.cap);
+    if (retv != SCAP_ERR_NONE)
+      fprintf(stderr, "error: capture to '%s' fail: '%s'\n",
+              o->capture, scap_error_str(retv));
+  }
+
+  // вывести трассировку
+  if (o->trace)
+  {
+    FILE *ftrace = o->trace_out ? fopen(o->trace_out, "w") : stderr;
+    if (ftrace == (FILE*) NULL)
+      perror("error: can't open trace file");
+    else
+    {
+      stracer_dump(&tick.trace, ftrace);
+      if (ftrace != stderr) fclose(ftrace);
+    }
+    stracer_free(&tick.trace);
+  }
+
+  for (i = 0; i < o->gpio_count && !o->fake; i++)
+  {
+    // set to input (more safe mode)
+    retv = sgpio_mode(gpio + i, SGPIO_DIR_IN, SGPIO_EDGE_NONE);
     if (o->verbose >= 3)
-      printf(">>> sgpio_unexport(%d) return '%s'\n",
-             o->gpio_num, sgpio_error_str(retv));
+      printf(">>> sgpio_mode(%d,%d,%d) return '%s'\n",
+             sgpio_num(gpio + i), SGPIO_DIR_IN, SGPIO_EDGE_NONE,
+             sgpio_error_str(retv));
+
+    // unexport only pins exported by us
+    if (gpio[i].exported)
+    {
+      retv = sgpio_unexport(sgpio_num(gpio + i));
+      if (o->verbose >= 3)
+        printf(">>> sgpio_unexport(%d) return '%s'\n",
+               sgpio_num(gpio + i), sgpio_error_str(retv));
+    }
   }
 
-  sgpio_free(gpio);
+  if (!o->fake && tick.input.exported)
+    sgpio_unexport(sgpio_num(&tick.input));
+
+  for (i = 0; i < o->gpio_count; i++)
+    sgpio_free(gpio + i);
+  sgpio_free(&tick.input);
+  if (o->bcast) sbcast_close(&tick.bcast);
+  for (i = 0; i < o->shards; i++)
+    stimer_free(&tick_shard(&tick, i)->timer);
+  if (o->wave) swave_free(&tick.wave);
+  if (o->program) sseq_free(&tick.seq);
+  if (o->shift) free((void*) o->shift);
 
   // вывести результаты накопленной статистики
   fout = o->data ? stderr : stdout;
-  dt_mid = tick.dt_sum / ((long double) tick.counter - 1);
+  dt_mid = tick.dt_sum /
+           ((long double) tick.counter - o->shards - tick.skipped);
   fprintf(fout, "--- TICK statistics ---\n");
   fprintf(fout, "=> counter         = %u\n",   tick.counter);
-  fprintf(fout, "=> dt_min          = %.9f\n", tick.dt_min);
-  fprintf(fout, "=> dt_max          = %.9f\n", tick.dt_max);
-  fprintf(fout, "=> dt_max - dt_min = %.9f\n", tick.dt_max - tick.dt_min);
-  fprintf(fout, "=> dt_mid          = %.9f\n", (double) dt_mid);
+  measured = !tick.pwm_on || o->input_num >= 0;
+  if (o->pwm_chip >= 0 && tick.pwm_on)
+  { // импульсы аппаратные: период меряется только по петле на входе
+    fprintf(fout, "=> pwm             = pwmchip%d/pwm%d, period %lld ns, "
+            "duty %lld ns%s\n", o->pwm_chip, o->pwm_channel,
+            (long long) tick.pwm.period_ns, (long long) tick.pwm.duty_ns,
+            tick.pwm.inversed ? ", inversed" : "");
+    if (measured)
+      fprintf(fout, "=> pwm_source      = loopback GPIO%d\n", o->input_num);
+    else
+      fprintf(fout, "=> pwm_source      = hardware-generated (not measured)\n");
+    if (measured && tick.trigger_err != SGPIO_ERR_NONE)
+      fprintf(fout, "=> trigger_error   = %s\n",
+              sgpio_error_str(tick.trigger_err));
+  }
+  else if (o->pwm_chip >= 0)
+    fprintf(fout, "=> pwm             = not used (%s)\n", tick.pwm_why);
+  if (o->shift)
+  { // пропускная способность только внутри sshift_write() (без ожидания)
+    const sshift_t *sh = &tick.shift;
+    fprintf(fout, "=> shift           = %u bytes, %s first, path %s",
+            o->shift_len, o->shift_order == SSHIFT_LSB_FIRST ? "lsb" : "msb",
+            sshift_path_str(sshift_path_used(sh)));
+    if (sshift_path_used(sh) != sh->path)
+      fprintf(fout, " (%s can't wait)", sshift_path_str(sh->path));
+    if (sh->path == SSHIFT_PATH_CDEV)
+      fprintf(fout, " (gpiochip%d lines %u,%u,%u)", sh->chip,
+              sh->offset[0], sh->offset[1], sh->offset[2]);
+    fprintf(fout, "\n");
+    fprintf(fout, "=> shift_bits      = %llu\n", (unsigned long long) sh->bits);
+    fprintf(fout, "=> shift_bits_s    = %.0f\n", sshift_bps(sh));
+    if (sh->bits)
+    {
+      fprintf(fout, "=> shift_ns_bit    = %.1f\n",
+              ((double) sh->time_ns) / (double) sh->bits);
+      fprintf(fout, "=> shift_calls_bit = %.3f\n",
+              ((double) sh->calls) / (double) sh->bits);
+    }
+    if (tick.shift_errors)
+      fprintf(fout, "=> shift_errors    = %u (%s)\n", tick.shift_errors,
+              sshift_error_str(tick.shift_err));
+  }
+  if (!o->delays && !o->capture && measured)
+  { // в режимах генератора задержек и анализатора период не считается
+    fprintf(fout, "=> dt_min          = %.9f\n", tick.dt_min);
+    fprintf(fout, "=> dt_max          = %.9f\n", tick.dt_max);
+    fprintf(fout, "=> dt_max - dt_min = %.9f\n", tick.dt_max - tick.dt_min);
+    fprintf(fout, "=> dt_mid          = %.9f\n", (double) dt_mid);
+  }
+  if (!tick.pwm_on)
+  { // у аппаратного ШИМ нет пробуждений таймера на каждом такте
+    fprintf(fout, "=> latency_min     = %.9f\n",
+            (double) tick.latency.min * 1e-9);
+    fprintf(fout, "=> latency_p50     = %.9f\n",
+            (double) sstat_percentile(&tick.latency, 50.) * 1e-9);
+    fprintf(fout, "=> latency_p99     = %.9f\n",
+            (double) sstat_percentile(&tick.latency, 99.) * 1e-9);
+    fprintf(fout, "=> latency_p999    = %.9f\n",
+            (double) sstat_percentile(&tick.latency, 99.9) * 1e-9);
+    fprintf(fout, "=> latency_max     = %.9f\n",
+            (double) tick.latency.max * 1e-9);
+  }
+  fprintf(fout, "=> clock_steps     = %u\n",   timer->steps);
+  for (i = 0; i < tick.stress.num; i++)
+    fprintf(fout, "=> stress_%-3s      = %llu loops (cpu %d)\n",
+            sstress_type_str(tick.stress.threads[i].type),
+            tick.stress.threads[i].loops, tick.stress.threads[i].cpu);
+  if (o->sim || timer->overrun)
+    fprintf(fout, "=> overrun         = %u\n",   timer->overrun);
+  for (i = 0; i < o->shards && o->shards > 1; i++)
+  {
+    tick_t *shard = tick_shard(&tick, i);
+    fprintf(fout, "=> shard_%-2d        = cpu %d, %d gpio, %u ticks, "
+            "latency_p99 %.9f\n", i, o->shard_cpus[i],
+            __builtin_popcount(shard->out_pins), ticks[i],
+            (double) p99[i] * 1e-9);
+  }
+  if (o->counters)
+  { // распределения приращений счетчиков за один вызов обработчика
+    for (i = 0; i < SPERF_STATS; i++)
+    {
+      const sstat_t *s = tick.perf.stat + i;
+      if (!sperf_available(&tick.perf, i) || s->count == 0)
+      {
+        fprintf(fout, "=> perf_%-11s= n/a\n", sperf_name(i));
+        continue;
+      }
+      fprintf(fout, "=> perf_%-11s= p50 %lld, p99 %lld, max %lld, "
+              "mean %.1f\n", sperf_name(i),
+              (long long) sstat_percentile(s, 50.),
+              (long long) sstat_percentile(s, 99.),
+              (long long) s->max, sstat_mean(s));
+    }
+    if (tick.perf.errors)
+      fprintf(fout, "=> perf_errors     = %u\n", tick.perf.errors);
+    if (tick.perf.multiplexed)
+      fprintf(fout, "=> perf_multiplexed= %u (samples skipped)\n",
+              tick.perf.multiplexed);
+    for (i = 0; i < o->shards; i++)
+      sperf_free(&tick_shard(&tick, i)->perf);
+  }
+  if (o->qos_us >= 0)
+  { // задержка пробных засыпаний без и с запросом PM QoS
+    if (qos_err == SQOS_ERR_DMA)
+      fprintf(fout, "=> qos_latency     = not held\n");
+    else
+      fprintf(fout, "=> qos_latency     = %d us (was %d us)\n",
+              qos.latency_us, qos.was_us);
+    if (o->qos_cpus)
+      fprintf(fout, "=> qos_cpus        = %d of %d\n", qos.set, o->qos_cpus);
+    fprintf(fout, "=> qos_off_p50     = %.9f\n",
+            (double) sstat_percentile(qos_probe, 50.) * 1e-9);
+    fprintf(fout, "=> qos_off_p99     = %.9f\n",
+            (double) sstat_percentile(qos_probe, 99.) * 1e-9);
+    fprintf(fout, "=> qos_on_p50      = %.9f\n",
+            (double) sstat_percentile(qos_probe + 1, 50.) * 1e-9);
+    fprintf(fout, "=> qos_on_p99      = %.9f\n",
+            (double) sstat_percentile(qos_probe + 1, 99.) * 1e-9);
+  }
+  if (!o->fake)
+    fprintf(fout, "=> gpio_startup    = %.3f ms\n", tick.startup * 1e3);
+  if (o->backend == STIMER_BACKEND_URING)
+    fprintf(fout, "=> write_errors    = %u\n",   timer->write_errors);
+  if (!o->delays && !o->capture && !o->wave && !o->program && measured &&
+      ticks[0] > 1)
+  { // средняя частота по фактическим пробуждениям или фронтам петли
+    // (без скачков часов)
+    double f_set  = 1e9 / stimer_period_ns(timer);
+    double f_real = ((double) (ticks[0] - 1)) * 1e9 /
+                    (double) (tick.last - tick.first - tick.steps_ns);
+    fprintf(fout, "=> freq_set        = %.6f Hz\n", f_set);
+    fprintf(fout, "=> freq_real       = %.6f Hz\n", f_real);
+    fprintf(fout, "=> freq_error      = %.3f ppm\n",
+            (f_real / f_set - 1.) * 1e6);
+  }
+  if (o->delays)
+  { // ошибка = момент фронта на выходе - (запуск + задержка)
+    fprintf(fout, "=> triggers        = %u\n",   tick.triggers);
+    fprintf(fout, "=> delay_error_min = %.9f\n",
+            (double) tick.delay_err.min * 1e-9);
+    fprintf(fout, "=> delay_error_p50 = %.9f\n",
+            (double) sstat_percentile(&tick.delay_err, 50.) * 1e-9);
+    fprintf(fout, "=> delay_error_p99 = %.9f\n",
+            (double) sstat_percentile(&tick.delay_err, 99.) * 1e-9);
+    fprintf(fout, "=> delay_error_max = %.9f\n",
+            (double) tick.delay_err.max * 1e-9);
+    fprintf(fout, "=> delay_jitter    = %.9f\n",
+            sstat_dev(&tick.delay_err) * 1e-9);
+    if (tick.trigger_err != SGPIO_ERR_NONE)
+      fprintf(fout, "=> trigger_error   = %s\n",
+              sgpio_error_str(tick.trigger_err));
+  }
+  if (o->capture)
+  {
+    fprintf(fout, "=> capture_samples = %llu\n",
+            (unsigned long long) tick.cap.samples);
+    fprintf(fout, "=> capture_runs    = %llu\n",
+            (unsigned long long) tick.cap.runs);
+    fprintf(fout, "=> capture_lost    = %llu\n",
+            (unsigned long long) tick.cap.lost);
+    fprintf(fout, "=> capture_gaps    = %llu\n",
+            (unsigned long long) tick.cap_gaps);
+    fprintf(fout, "=> capture_errors  = %u\n", tick.cap_errors);
+    scap_free(&tick.cap);
+  }
+  if (tick.bcast_err != SBCAST_ERR_NONE)
+    fprintf(fout, "=> broadcast_error = %s\n",
+            sbcast_error_str(tick.bcast_err));
+  if (tick.seq_err != SSEQ_ERR_NONE)
+    fprintf(fout, "=> program_error   = %s (pc=%u)\n",
+            sseq_error_str(tick.seq_err), tick.seq.pc);
+  if (o->fake)
+  {
+    for (i = 1; i < o->shards; i++)
+    {
+      retv = sgpio_fake_merge(&tick.rec, &tick_shards[i].rec);
+      if (retv != SGPIO_ERR_NONE)
+        fprintf(stderr, "error: sgpio_fake_merge() fail: '%s'\n",
+                sgpio_error_str(retv));
+      sgpio_fake_free(&tick_shards[i].rec);
+    }
+    fprintf(fout, "=> gpio_edges      = %u\n",   tick.rec.count);
+    fprintf(fout, "=> gpio_edges_lost = %u\n",   tick.rec.lost);
+    if (o->vcd)
+    {
+      retv = sgpio_fake_vcd(&tick.rec, o->vcd);
+      if (retv != SGPIO_ERR_NONE)
+        fprintf(stderr, "error: sgpio_fake_vcd('%s') fail: '%s'\n",
+                o->vcd, sgpio_error_str(retv));
+    }
+    sgpio_fake_free(&tick.rec);
+  }
+  if (timer->steps)
+    fprintf(fout, "=> clock_step_last = %.9f\n", timer->step);
+
+  if (o->pll)
+  {
+    fprintf(fout, "=> pll_samples     = %u\n",   tick.pll.samples);
+    fprintf(fout, "=> pll_phase       = %.9f\n", tick.pll.phase);
+    fprintf(fout, "=> pll_phase_min   = %.9f\n", tick.pll.phase_min);
+    fprintf(fout, "=> pll_phase_max   = %.9f\n", tick.pll.phase_max);
+    fprintf(fout, "=> pll_phase_rms   = %.9f\n", spll_phase_rms(&tick.pll));
+    fprintf(fout, "=> pll_freq        = %.3f ppm\n", spll_freq_ppm(&tick.pll));
+  }
+  spll_free(&tick.pll);
 
   return EXIT_SUCCESS;
 }